@@ -0,0 +1,80 @@
+#include "cmd_line_options.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+contains_bench
+  - compares IntListOption::Contains() with std::find() over value_list_, e.g. contains_bench values=100000 sparse
+)~");
+
+static UintOption option_values(1000, "values", "number of values in the list");
+static BoolOption option_sparse(false, "sparse", "spread the values out, so the index is runs instead of a bitmap");
+static UintOption option_queries(1000000, "queries", "number of Contains() queries");
+
+static IntListOption lanes("lanes:", "the list being queried");
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    uint32_t num_values = option_values.value;
+    // every other value in a block, or spread over most of the int range, with a few runs
+    uint32_t stride = option_sparse.value ? 2654435 : 2;
+    for (uint32_t i = 0; i < num_values; i++)
+    {
+        lanes.AddValue((int32_t)(i * stride - (num_values / 2) * stride));
+        if (option_sparse.value && (i % 8 == 0))
+        {
+            lanes.AddValue((int32_t)(i * stride - (num_values / 2) * stride) + 1);
+        }
+    }
+    lanes.EndOfList();
+    if (lanes.value_list_.empty())
+    {
+        printf("no values\n");
+        return 0;
+    }
+
+    // queries hit and miss, and go past both ends
+    std::vector<int32_t> queries(4096);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int32_t value = lanes.value_list_[seed % lanes.value_list_.size()];
+        queries[i] = value + (int32_t)((seed >> 16) % 4) - 1;
+    }
+    uint64_t mismatches = 0;
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        bool found = std::find(lanes.value_list_.begin(), lanes.value_list_.end(), queries[i]) !=
+                     lanes.value_list_.end();
+        mismatches += (found != lanes.Contains(queries[i]));
+    }
+    printf("%zu values, %llu mismatches\n", lanes.value_list_.size(), (unsigned long long)mismatches);
+
+    uint64_t hits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < option_queries.value; i++)
+    {
+        hits += lanes.Contains(queries[i % queries.size()]);
+    }
+    double contains_ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+        option_queries.value;
+    start = std::chrono::steady_clock::now();
+    uint32_t find_queries = std::max<uint32_t>(option_queries.value / 1000, 100);
+    for (uint32_t i = 0; i < find_queries; i++)
+    {
+        hits += std::find(lanes.value_list_.begin(), lanes.value_list_.end(), queries[i % queries.size()]) !=
+                lanes.value_list_.end();
+    }
+    double find_ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / find_queries;
+    printf("Contains(): %8.1f ns per query\n", contains_ns);
+    printf("std::find:  %8.1f ns per query (hits %llu)\n", find_ns, (unsigned long long)hits);
+    return 0;
+}
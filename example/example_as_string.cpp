@@ -1,4 +1,5 @@
 #include "cmd_line_options.h"
+#include <string.h>
 #include <string>
 
 void option_test();
@@ -12,17 +13,22 @@ example_as_string
 
 int main(int argc, const char **argv)
 {
+    // ';' separates lines,... each line is parsed on its own, like lines of a script file.
     std::string big_string;
-    for (int i = 1; i < argc; i++)
+    for (int i = 1; i <= argc; i++)
     {
+        if ((i == argc) || (strcmp(argv[i], ";") == 0))
+        {
+            CmdLineOptions::GetInstance()->ParseString(big_string.c_str());
+            option_test();
+            // reset the options this line set before parsing the next one.
+            CmdLineOptions::GetInstance()->Reset();
+            big_string.clear();
+            continue;
+        }
         big_string += argv[i];
         big_string += ' ';
     }
-    CmdLineOptions::GetInstance()->ParseString(big_string.c_str());
-
-    option_test();
-    // if performing actions from a file, could reset the previous ones and parse them one at a time.
-    CmdLineOptions::GetInstance()->Reset();
 
     return 0;
 }
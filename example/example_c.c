@@ -0,0 +1,58 @@
+/*  COPYRIGHT (C) 2022 Microchip with MIT license */
+
+/*
+ * example_c
+ *   - reads the options of option_test.cpp from C, through handles
+ */
+
+#include "cmd_line_options_c.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+int main(int argc, const char **argv)
+{
+    cmd_line_options_parse_options(argc, argv);
+
+    /* look the options up once */
+    cmdopt_handle_t some_bool = cmdopt_find("some_bool", CMDOPT_TYPE_BOOL);
+    cmdopt_handle_t some_uint = cmdopt_find("some_uint", CMDOPT_TYPE_UINT);
+    cmdopt_handle_t some_int64 = cmdopt_find("some_int64", CMDOPT_TYPE_INT64);
+    cmdopt_handle_t some_double = cmdopt_find("some_double", CMDOPT_TYPE_DOUBLE);
+    cmdopt_handle_t some_string = cmdopt_find("some_string", CMDOPT_TYPE_STRING);
+    cmdopt_handle_t some_intrange = cmdopt_find("some_intrange", CMDOPT_TYPE_INT_RANGE);
+    cmdopt_handle_t some_int64list = cmdopt_find("some_int64list:", CMDOPT_TYPE_INT64_LIST);
+    cmdopt_handle_t some_stringlist = cmdopt_find("some_stringlist:", CMDOPT_TYPE_STRING_LIST);
+
+    printf("same handle: %s\n", cmdopt_find("some_uint", CMDOPT_TYPE_ANY) == some_uint ? "yes" : "no");
+    printf("wrong type: %s\n", cmdopt_find("some_uint", CMDOPT_TYPE_STRING) == NULL ? "NULL" : "found");
+    printf("no such option: %s\n", cmdopt_find("no_such_option", CMDOPT_TYPE_ANY) == NULL ? "NULL" : "found");
+
+    /* then reading a value is just a load through the handle */
+    printf("some_bool = %d (set %d)\n", cmdopt_get_bool(some_bool), cmdopt_is_set(some_bool));
+    printf("some_uint = %u (set %d)\n", cmdopt_get_u32(some_uint), cmdopt_is_set(some_uint));
+    printf("some_int64 = %" PRId64 "\n", cmdopt_get_i64(some_int64));
+    printf("some_double = %g\n", cmdopt_get_double(some_double));
+    printf("some_string = %s\n", cmdopt_get_string(some_string));
+    int32_t start;
+    int32_t end;
+    cmdopt_get_range(some_intrange, &start, &end);
+    printf("some_intrange = %d..%d\n", start, end);
+
+    const int64_t *values;
+    size_t count = cmdopt_get_i64_list(some_int64list, &values);
+    printf("some_int64list:");
+    for (size_t i = 0; i < count; i++)
+    {
+        printf(" %" PRId64, values[i]);
+    }
+    printf("\n");
+    const char *const *strings;
+    count = cmdopt_get_string_list(some_stringlist, &strings);
+    printf("some_stringlist:");
+    for (size_t i = 0; i < count; i++)
+    {
+        printf(" %s", strings[i]);
+    }
+    printf("\n");
+    return 0;
+}
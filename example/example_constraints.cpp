@@ -0,0 +1,39 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <sstream>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_constraints
+  - demonstrates rules about which options can be used together
+)~");
+
+static BoolOption option_smoke_test(false, "smoke_test", "just a quick smoke test");
+static BoolOption option_endurance_test(false, "endurance_test", "longer test");
+static IntRangeOption option_channels("channels", "range of channels to test");
+static UintOption option_num_channels(0, "num_channels", "number of channels on the board");
+static BoolOption option_audit(false, "audit", "generate an audit trail");
+static BoolOption option_verbose(false, "verbose", "lots of output");
+static BoolOption option_quiet(false, "quiet", "no output");
+
+static OptionConstraint one_test(OPTION_ONE_OF, {&option_smoke_test, &option_endurance_test});
+static OptionConstraint channels_need_num_channels(OPTION_REQUIRES, {&option_channels, &option_num_channels});
+static OptionConstraint verbose_or_quiet(OPTION_CONFLICTS, {&option_verbose, &option_quiet});
+static OptionConstraint not_too_slow(OPTION_AT_MOST, {&option_endurance_test, &option_audit, &option_verbose}, 2);
+
+int main(int argc, const char **argv)
+{
+    std::stringstream out;
+    if (CmdLineOptions::GetInstance()->ParseOptionsOrError(argc - 1, &argv[1], out))
+    {
+        printf("options are ok\n");
+        return 0;
+    }
+    else
+    {
+        printf("ParseOptionsOrError returned false\n");
+        std::cout << out.str();
+        return 255;
+    }
+}
@@ -0,0 +1,26 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_contains
+  - asks whether values are in a list and a range, e.g. example_contains lanes: 0..7 64 channels=10+5 check: 3 12 64
+)~");
+
+static IntListOption option_lanes("lanes:", "lanes in use");
+static IntRangeOption option_channels("channels", "range of channels");
+static IntListOption option_check("check:", "values to look for");
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    for (std::vector<int32_t>::const_iterator it = option_check.value_list_.begin();
+         it != option_check.value_list_.end(); ++it)
+    {
+        printf("%d: lanes %s, channels %s\n", *it, option_lanes.Contains(*it) ? "yes" : "no",
+               option_channels.Contains(*it) ? "yes" : "no");
+    }
+    return 0;
+}
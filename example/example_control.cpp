@@ -0,0 +1,89 @@
+#include "cmd_line_options.h"
+#include "cmd_line_options_control.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+void option_test();
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_control
+  - listens on a control socket, then sends each line from stdin to it
+)~");
+
+static StringOption option_control_socket(NULL, "control_socket", "path of the control socket");
+
+static std::thread::id main_thread;
+
+/**
+ * @brief
+ *   observer of some_int, says which thread it's told on
+ */
+class IntObserver : public OptionObserver
+{
+  public:
+    IntObserver() : OptionObserver({CmdLineOptions::GetInstance()->FindOption("some_int")})
+    {
+    }
+    void OptionsChanged(const std::vector<CmdLineOption *> &) override
+    {
+        std::cout << "some_int changed, on the " << (std::this_thread::get_id() == main_thread ? "main" : "wrong")
+                  << " thread\n";
+    }
+};
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    main_thread = std::this_thread::get_id();
+    IntObserver observer;
+
+    char default_path[64];
+    snprintf(default_path, sizeof(default_path), "/tmp/example_control.%d", (int)getpid());
+    const char *socket_path = option_control_socket.is_set ? option_control_socket.value : default_path;
+
+    CmdLineOptionsControl control;
+    if (!control.Start(socket_path))
+    {
+        return 255;
+    }
+    // like a worker that keeps the strings it read,... they stay valid however often they're changed
+    StringOption *some_string = (StringOption *)CmdLineOptions::GetInstance()->FindOption("some_string");
+    std::vector<const char *> strings_read(1, some_string->value);
+    int status = 0;
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        std::stringstream reply;
+        if (!CmdLineOptionsControl::Send(socket_path, line.c_str(), reply))
+        {
+            status = 255;
+        }
+        std::cout << reply.str();
+        // this is the thread that owns the options
+        control.Apply();
+        const char *s = CmdLineOptionsControl::Load(some_string->value);
+        if (s != strings_read.back())
+        {
+            strings_read.push_back(s);
+        }
+    }
+    control.Stop();
+    if (strings_read.size() > 1)
+    {
+        std::cout << "some_string was:";
+        for (std::vector<const char *>::const_iterator it = strings_read.begin(); it != strings_read.end(); ++it)
+        {
+            std::cout << " " << *it;
+        }
+        std::cout << "\n";
+    }
+    std::cout.flush();
+    option_test();
+    return status;
+}
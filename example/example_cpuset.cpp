@@ -0,0 +1,44 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <sched.h>
+#include <stdio.h>
+#include <thread>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_cpuset
+  - demonstrates spreading threads over a set of CPUs, e.g. cpus=0-7,16-23,32+8/2 threads=8 pin
+)~");
+
+static CpuSetOption option_cpus(NULL, "cpus", "CPUs to run the threads on (default all the online CPUs)");
+static UintOption option_threads(4, "threads", "number of worker threads");
+static BoolOption option_pin(false, "pin", "start the threads and pin each one to its CPU");
+
+/**
+ * @brief
+ *   worker thread, pins itself and says where it ended up
+ */
+static void worker(uint32_t thread)
+{
+    bool pinned = option_cpus.PinThread(thread);
+    printf("thread %u %s cpu %d\n", thread, pinned ? "pinned to" : "couldn't be pinned, on", sched_getcpu());
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    std::cout << "cpus: ";
+    option_cpus.ShowValue(std::cout);
+    std::cout << std::endl;
+    for (uint32_t i = 0; i < option_threads.value; i++)
+    {
+        printf("thread %u -> cpu %u\n", i, option_cpus.CpuForThread(i));
+    }
+    for (uint32_t i = 0; option_pin.value && (i < option_threads.value); i++)
+    {
+        std::thread thread(worker, i);
+        thread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_file_list
+  - reads list values from files, e.g. example_file_list values:=@addresses.txt 7 names:=@tests.txt
+)~");
+
+static IntListOption option_values("values:", "values, values:=@file (one per line) or values:=@raw:file (int32's)");
+static StringListOption option_names("names:", "names, names:=@file reads them from a file, one per line");
+static UintOption option_first(3, "first", "number of values to show");
+static IntOption option_find(-1, "find", "value to look for with Contains()");
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    std::cout << "values: ";
+    option_values.ShowValue(std::cout);
+    std::cout << std::endl;
+
+    // the file's values are only decoded here, as the loop gets to them
+    uint64_t count = 0;
+    int64_t sum = 0;
+    printf("first values:");
+    for (IntListOption::const_iterator it = option_values.begin(); it != option_values.end(); ++it)
+    {
+        if (count < option_first.value)
+        {
+            printf(" %d", *it);
+        }
+        count++;
+        sum += *it;
+    }
+    printf("\n%llu values, sum %lld\n", (unsigned long long)count, (long long)sum);
+
+    count = 0;
+    printf("first names:");
+    for (StringListOption::const_iterator it = option_names.begin(); it != option_names.end(); ++it)
+    {
+        if (count < option_first.value)
+        {
+            std::string_view name = *it;
+            printf(" %.*s", (int)name.size(), name.data());
+        }
+        count++;
+    }
+    printf("\n%llu names\n", (unsigned long long)count);
+
+    // Contains() and the arrays see the file's values too
+    printf("contains %d: %s\n", option_find.value, option_values.Contains(option_find.value) ? "yes" : "no");
+    const std::vector<const char *> &names = option_names.Strings();
+    printf("%zu values, %zu names, last name %s\n", option_values.Values().size(), names.size(),
+           names.empty() ? "-" : names.back());
+    return 0;
+}
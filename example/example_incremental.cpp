@@ -0,0 +1,50 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <sstream>
+
+void option_test();
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_incremental
+  - demonstrates feeding arguments one at a time to a CmdLineOptionParser
+  - does not assert on failure,... instead outputs error message to a std::ostream
+)~");
+
+/**
+ * @brief
+ *   parser that shows when each option is resolved
+ */
+class ShowParsedOptions : public CmdLineOptionParser
+{
+  public:
+    ShowParsedOptions(std::ostream &error_message) : CmdLineOptionParser(error_message)
+    {
+    }
+    virtual void OptionParsed(CmdLineOption *option)
+    {
+        printf("parsed %s\n", option->name);
+    }
+};
+
+int main(int argc, const char **argv)
+{
+    std::stringstream out;
+    ShowParsedOptions parser(out);
+    for (int i = 1; i < argc; i++)
+    {
+        parser.Feed(argv[i]);
+    }
+    if (parser.Finish())
+    {
+        option_test();
+        return 0;
+    }
+    else
+    {
+        printf("CmdLineOptionParser returned false\n");
+        std::cout << out.str();
+        return 255;
+    }
+}
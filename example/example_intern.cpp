@@ -0,0 +1,95 @@
+#include "cmd_line_options.h"
+#include <algorithm>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_intern
+  - parses the same strings over and over into a StringPool, e.g. example_intern threads=8
+)~");
+
+static StringOption option_test("none", "test", "test name");
+static StringListOption option_files("files:", "files the test uses");
+static UintOption option_threads(4, "threads", "threads interning at the same time");
+
+/// lines of a script, the same few strings again and again
+static const char *lines[] = {
+    "test=read files: a.bin b.bin a.bin",
+    "test=write files: b.bin c.bin",
+    "test=read files: a.bin c.bin",
+};
+
+/**
+ * @brief
+ *   number of different pointers
+ */
+static size_t distinct(std::vector<const char *> pointers)
+{
+    std::sort(pointers.begin(), pointers.end());
+    return std::unique(pointers.begin(), pointers.end()) - pointers.begin();
+}
+
+/**
+ * @brief
+ *   thread interning names, some of them the same as the other threads'
+ */
+static void intern_names(StringPool *pool, uint32_t thread, std::vector<const char *> *interned)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "reg%u", (i + thread) % 50);
+        interned->push_back(pool->Intern(name));
+    }
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    CmdLineOptions::ParseOptions(argc, argv);
+    uint32_t num_threads = option_threads.value;
+    StringPool pool;
+    options->SetStringPool(&pool);
+
+    // the values stay valid after the next ParseString(), and equal values are the same pointer
+    std::vector<const char *> tests;
+    std::vector<const char *> files;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        options->Reset();
+        options->ParseString(lines[i]);
+        tests.push_back(option_test.value);
+        files.insert(files.end(), option_files.string_list_.begin(), option_files.string_list_.end());
+    }
+    printf("%zu tests, %zu different pointers\n", tests.size(), distinct(tests));
+    printf("%zu files, %zu different pointers\n", files.size(), distinct(files));
+    printf("first and last test the same: %s, value %s\n", (tests.front() == tests.back()) ? "yes" : "no",
+           tests.back());
+
+    std::vector<std::vector<const char *>> interned(num_threads);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        threads.push_back(std::thread(intern_names, &pool, i, &interned[i]));
+    }
+    bool agree = true;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        threads[i].join();
+        for (std::vector<const char *>::const_iterator it = interned[i].begin(); it != interned[i].end(); ++it)
+        {
+            agree = agree && (pool.Find(*it) == *it);
+        }
+    }
+    printf("%u threads got the same pointers: %s\n", num_threads, agree ? "yes" : "no");
+    printf("pool: %zu strings\n", pool.Count());
+
+    // nothing points into the pool after a Reset(), so it can go in one go
+    options->Reset();
+    pool.Release();
+    printf("after Release(): %zu strings, test = %s\n", pool.Count(), option_test.value);
+    return 0;
+}
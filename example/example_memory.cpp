@@ -0,0 +1,50 @@
+#include "cmd_line_options.h"
+#include <iostream>
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_memory
+  - reports the memory used by the options, e.g. example_memory values: 1..1000 again="values: 1"
+    constraints=100 adds that many constraints afterwards, to show the registry growing
+)~");
+
+static IntListOption option_values("values:", "list of values");
+static StringListOption option_names("names:", "list of names");
+static EnumOption option_mode(0, "mode", "mode of operation");
+static StringOption option_again(NULL, "again", "options to parse (with ParseString) after a Reset()");
+static UintOption option_threshold(1024, "threshold", "bytes of unused capacity that get an option marked");
+static UintOption option_constraints(0, "constraints", "number of constraints to add after the first report");
+
+int main(int argc, const char **argv)
+{
+    option_mode.AddEnum(0, "fast", "go fast");
+    option_mode.AddEnum(1, "slow", "go slow");
+    option_mode.AddEnum(2, "careful", "check everything");
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    CmdLineOptions::ParseOptions(argc, argv);
+    const char *again = option_again.value;
+    uint32_t threshold = option_threshold.value;
+    options->MemoryReport(std::cout, threshold);
+    if (again != NULL)
+    {
+        // the lists are cleared, but keep their capacity
+        options->Reset();
+        options->ParseString(again);
+        printf("after again:\n");
+        options->MemoryReport(std::cout, threshold);
+    }
+    if (option_constraints.value != 0)
+    {
+        for (uint32_t i = 0; i < option_constraints.value; i++)
+        {
+            new OptionConstraint(OPTION_AT_MOST, {&option_values, &option_names, &option_mode}, 3);
+        }
+        // the constraints are compiled into the registry's tables when they're first checked
+        options->FirstBrokenConstraint();
+        printf("after constraints:\n");
+        options->MemoryReport(std::cout, threshold);
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "cmd_line_options.h"
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_namespace
+  - demonstrates dotted option namespaces, e.g. dma.queue_depth=32 help=dma.*
+)~");
+
+static HelpOption option_help("help", "show the options, help=<namespace>.* for just the options in a namespace");
+static BoolOption option_reset_dma(false, "reset_dma", "reset the dma options after parsing");
+
+// a "library" that picks short names and puts them in a namespace
+static UintOption option_queue_depth(16, "queue_depth", "descriptors per queue");
+static BoolOption option_trace(false, "trace", "trace every descriptor");
+static OptionNamespace dma_namespace("dma", {&option_queue_depth, &option_trace});
+
+// options can also just have dotted names,... "hw" only has "hw.pcie" in it
+static UintOption option_lanes(4, "hw.pcie.lanes", "number of lanes");
+static UintOption option_gen(3, "hw.pcie.gen", "pcie generation");
+static UintOption option_level(1, "log.level", "log level");
+
+/**
+ * @brief
+ *   print the option values
+ */
+static void show_values()
+{
+    printf("dma.queue_depth = %u\n", option_queue_depth.value);
+    printf("dma.trace = %s\n", option_trace.value ? "true" : "false");
+    printf("hw.pcie.lanes = %u\n", option_lanes.value);
+    printf("hw.pcie.gen = %u\n", option_gen.value);
+    printf("log.level = %u\n", option_level.value);
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    show_values();
+    if (option_reset_dma.value)
+    {
+        CmdLineOptions::GetInstance()->ResetNamespace("dma.*");
+        printf("after reset:\n");
+        show_values();
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "cmd_line_options.h"
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_observer "<options>" "<options>" ...
+  - parses each argument like ParseString() (or calls Reset() for "reset", or writes rate and label directly
+    for "direct"), and shows what the observers are told
+)~");
+
+static UintOption option_rate(100, "rate", "packets per second");
+static UintOption option_burst(8, "burst", "packets per burst");
+static StringOption option_label("none", "label", "label for the results");
+static BoolOption option_verbose(false, "verbose", "print more");
+
+/**
+ * @brief
+ *   observer that prints what changed
+ */
+class PrintObserver : public OptionObserver
+{
+  public:
+    PrintObserver(const char *_name, std::initializer_list<CmdLineOption *> _options)
+        : OptionObserver(_options), name(_name)
+    {
+    }
+    void OptionsChanged(const std::vector<CmdLineOption *> &changed) override
+    {
+        printf("%s:", name);
+        for (std::vector<CmdLineOption *>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+        {
+            printf(" %s", (*it)->name);
+        }
+        printf("\n");
+    }
+    const char *name; ///< name to print
+};
+
+static PrintObserver rate_observer("rate observer", {&option_rate, &option_burst});
+static PrintObserver label_observer("label observer", {&option_label});
+
+/**
+ * @brief
+ *   worker thread, sleeps until the rate changes
+ */
+static void rate_worker()
+{
+    uint32_t generation = rate_observer.Wait(0);
+    printf("worker woke: generation %u, rate %u, burst %u\n", generation, option_rate.value, option_burst.value);
+}
+
+int main(int argc, const char **argv)
+{
+    std::thread worker(rate_worker);
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "reset") == 0)
+        {
+            printf("reset\n");
+            CmdLineOptions::GetInstance()->Reset();
+            printf("rate %u, label %s\n", option_rate.value, option_label.value);
+            continue;
+        }
+        if (strcmp(argv[i], "direct") == 0)
+        {
+            // not through the parser, so nobody is told,... Reset() still puts them back
+            printf("direct\n");
+            option_rate.value = 1;
+            option_label.value = "direct";
+            continue;
+        }
+        printf("parse \"%s\"\n", argv[i]);
+        CmdLineOptions::GetInstance()->ParseString(argv[i]);
+        if (worker.joinable() && (rate_observer.Generation() != 0))
+        {
+            worker.join();
+        }
+    }
+    uint32_t generation = label_observer.Generation();
+    if (label_observer.Wait(generation, 10) == generation)
+    {
+        printf("no label change in 10 ms\n");
+    }
+    if (worker.joinable())
+    {
+        printf("rate never changed\n");
+        CmdLineOptions::GetInstance()->ParseString("rate=0");
+        worker.join();
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "cmd_line_options_script.h"
+#include <iostream>
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_script
+  - runs a script file, one command line per line, e.g. example_script script=scenarios.txt
+)~");
+
+static StringOption option_script(NULL, "script", "script file");
+static BoolOption option_check(false, "check", "just check the script");
+static UintOption option_threads(0, "threads", "worker threads, 0 for one per CPU");
+
+static BoolOption option_diff(false, "diff", "apply only what changed from one line to the next");
+
+/**
+ * @brief
+ *   IntOption that says when it's set, to show which lines set it
+ */
+class CountOption : public IntOption
+{
+  public:
+    CountOption(int32_t default_value, const char *_name, const char *_usage_message)
+        : IntOption(default_value, _name, _usage_message)
+    {
+    }
+    virtual void OptionSet()
+    {
+        printf("count set to %d\n", value);
+    }
+};
+
+static CountOption option_count(1, "count", "number of times to run");
+static StringOption option_label("none", "label", "label for the results");
+static IntListOption option_channels("channels:", "channels to test");
+
+/**
+ * @brief
+ *   show the options of each line
+ *
+ * @param[in] line - script line
+ *
+ * @return bool - true to keep going
+ */
+static bool run_line(const ScriptLine &line, void *)
+{
+    if (line.error.code != PARSE_ERROR_NONE)
+    {
+        printf("line %llu:\n", (unsigned long long)line.number);
+        CmdLineOptions::GetInstance()->RenderError(line.error, line.argv, std::cout);
+        return true;
+    }
+    printf("line %llu: count = %d, label = %s, channels:", (unsigned long long)line.number, option_count.value,
+           option_label.value);
+    for (std::vector<int32_t>::const_iterator it = option_channels.value_list_.begin();
+         it != option_channels.value_list_.end(); ++it)
+    {
+        printf(" %d", *it);
+    }
+    printf("\n");
+    return true;
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    if (option_script.value == NULL)
+    {
+        printf("no script\n");
+        return 255;
+    }
+    // the script's lines are parsed on their own, starting from the defaults
+    const char *path = option_script.value;
+    bool check = option_check.value;
+    uint32_t num_threads = option_threads.value;
+    bool diff = option_diff.value;
+    CmdLineOptions::GetInstance()->Reset();
+
+    CmdLineOptionsScript script;
+    // small chunks, so even a short script is spread over the threads
+    script.chunk_size = 64;
+    script.incremental = diff;
+    if (!script.Open(path))
+    {
+        return 255;
+    }
+    if (check)
+    {
+        uint64_t bad_lines = script.Check(std::cout, num_threads);
+        printf("%llu bad lines\n", (unsigned long long)bad_lines);
+        return (bad_lines == 0) ? 0 : 255;
+    }
+    script.Run(run_line, NULL, num_threads);
+    return 0;
+}
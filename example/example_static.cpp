@@ -0,0 +1,32 @@
+#include "cmd_line_options_static.h"
+#include <stdio.h>
+
+void option_test();
+
+// options known at build time,... no constructors, the compiler builds the tables.
+#define STATIC_OPTIONS(X)                                                                                              \
+    X(BOOL, static_bool, false, "testing static bool option")                                                          \
+    X(INT, static_int, -1, "testing static_int")                                                                       \
+    X(UINT, static_uint, 0x10, "testing static_uint")                                                                  \
+    X(INT64, static_int64, 0, "testing static_int64")                                                                  \
+    X(UINT64, static_uint64, 0x123456789, "testing static_uint64")                                                     \
+    X(DOUBLE, static_double, 0.5, "testing static_double")                                                             \
+    X(STRING, static_string, "none", "testing static_string")
+CMD_LINE_STATIC_OPTIONS(static_options, STATIC_OPTIONS)
+CMD_LINE_STATIC_OPTIONS_REGISTER(static_options)
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    printf("static_bool = %s%s\n", static_options.static_bool ? "true" : "false",
+           static_options_table.is_set[static_options_index::static_bool] ? " (set)" : "");
+    printf("static_int = %d\n", static_options.static_int);
+    printf("static_uint = 0x%x\n", static_options.static_uint);
+    printf("static_int64 = %lld\n", (long long)static_options.static_int64);
+    printf("static_uint64 = 0x%llx\n", (unsigned long long)static_options.static_uint64);
+    printf("static_double = %g\n", static_options.static_double);
+    printf("static_string = %s\n", static_options.static_string);
+    // the options that registered themselves still work
+    option_test();
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "cmd_line_options.h"
+#include <stdio.h>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_subcommand
+  - demonstrates git style subcommands,... each one has its own options
+)~");
+
+static BoolOption option_verbose(false, "verbose", "lots of output (all subcommands)");
+
+static IntListOption option_channels("channels:", "channels to test");
+static UintOption option_test_time(10, "test_time", "seconds to run each test");
+static Subcommand run_command("run", "run the test", {&option_channels, &option_test_time});
+
+static OptionGroup dump_help("  dump reads registers, e.g. dump regs: 0xd00380..0xd0038c");
+static AddrMaskListOption option_regs("regs:", "registers to dump");
+static BoolOption option_dump_all(false, "dump_all", "dump every register");
+static Subcommand dump_command("dump", "dump registers", {&dump_help, &option_regs, &option_dump_all});
+
+int main(int argc, const char **argv)
+{
+    // global options have read their environment variables already, before anything is parsed
+    if (option_verbose.value)
+    {
+        printf("verbose before parsing\n");
+    }
+    CmdLineOptions::ParseOptions(argc, argv);
+    Subcommand *subcommand = CmdLineOptions::GetInstance()->SelectedSubcommand();
+    printf("subcommand: %s\n", subcommand != NULL ? subcommand->name : "none");
+    printf("verbose = %s\n", option_verbose.value ? "true" : "false");
+    if (subcommand == &run_command)
+    {
+        printf("channels:");
+        for (std::vector<int32_t>::const_iterator it = option_channels.value_list_.begin();
+             it != option_channels.value_list_.end(); ++it)
+        {
+            printf(" %d", *it);
+        }
+        printf("\ntest_time = %u\n", option_test_time.value);
+    }
+    else if (subcommand == &dump_command)
+    {
+        printf("regs:");
+        for (std::vector<addr_and_mask_t>::const_iterator it = option_regs.addr_mask_list_.begin();
+             it != option_regs.addr_mask_list_.end(); ++it)
+        {
+            printf(" 0x%x", it->addr);
+        }
+        printf("\ndump_all = %s\n", option_dump_all.value ? "true" : "false");
+    }
+    return 0;
+}
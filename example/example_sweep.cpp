@@ -0,0 +1,64 @@
+#include "cmd_line_options_sweep.h"
+#include <chrono>
+#include <inttypes.h>
+#include <thread>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_sweep
+  - runs a (pretend) test for every combination of channels, frame sizes and modes
+)~");
+
+class ModeOption : public EnumOption
+{
+  public:
+    ModeOption(uint32_t default_value, const char *_name, const char *_usage_message)
+        : EnumOption(default_value, _name, _usage_message)
+    {
+        AddEnum(0, "loopback", "internal loopback");
+        AddEnum(1, "external", "external loopback");
+    }
+};
+
+static IntListOption option_channels("channels:", "channels to test");
+static IntRangeOption option_frame_sizes("frame_sizes", "range of frame sizes to test");
+static ModeOption option_mode(0, "mode", "loopback mode (all modes if not set)");
+static UintOption option_threads(0, "threads", "number of threads (0 for one per CPU)");
+static UintOption option_test_time(0, "test_time", "milliseconds each test takes");
+
+/**
+ * @brief
+ *   pretend to run a test
+ */
+static int64_t run_test(const SweepContext &context, void *arg)
+{
+    (void)arg;
+    std::this_thread::sleep_for(std::chrono::milliseconds(option_test_time.value));
+    return context.Value(&option_channels) * 10000 + context.Value(&option_frame_sizes) * 10 +
+           context.Value(&option_mode);
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+
+    CmdLineOptionsSweep sweep;
+    sweep.AddAxis(&option_channels);
+    sweep.AddAxis(&option_frame_sizes);
+    sweep.AddAxis(&option_mode);
+    std::vector<int64_t> results;
+    if (!sweep.Run(run_test, NULL, results, option_threads.value))
+    {
+        return -1;
+    }
+    std::vector<int64_t> values(sweep.AxisCount());
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        sweep.Combination(i, values.data());
+        printf("combination %zu: channel %" PRId64 " frame size %" PRId64 " mode %s result %" PRId64 "\n", i,
+               values[0], values[1], option_mode.GetString(values[2]), results[i]);
+    }
+    printf("%zu combinations\n", results.size());
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "cmd_line_options.h"
+#include <iostream>
+
+void option_test();
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+example_try_parse
+  - demonstrates TryParseOptions(),... errors come back as a record, the message is only made on request
+)~");
+
+static const char *error_names[] = {"none", "no match", "bad value", "bad list item", "constraint"};
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    parse_error_t error;
+    if (options->TryParseOptions(argc - 1, &argv[1], &error))
+    {
+        option_test();
+        return 0;
+    }
+    printf("TryParseOptions returned false\n");
+    printf("error: %s, argument %d, option '%s', offset %u\n", error_names[error.code], error.arg_index,
+           error.option_index >= 0 ? options->GetOption(error.option_index)->name : "", error.offset);
+    options->RenderError(error, &argv[1], std::cout);
+    return 255;
+}
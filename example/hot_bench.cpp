@@ -0,0 +1,134 @@
+#include "cmd_line_options.h"
+#include "cmd_line_options_hot.h"
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+hot_bench
+  - compares reader throughput of an option value in .data with a HotOptions copy,
+    with and without a writer changing its neighbours and (now and then) the option
+)~");
+
+static UintOption option_threads(0, "threads", "reader threads, 0 for one per CPU");
+static UintOption option_ms(200, "ms", "milliseconds per measurement");
+static UintOption option_rate(100, "rate", "the value the readers read");
+
+static HotOptions hot({&option_rate});
+enum
+{
+    HOT_RATE
+};
+
+// like an option value packed into .data next to a counter someone else updates
+static struct
+{
+    volatile uint32_t rate;          ///< read by the readers
+    std::atomic<uint32_t> neighbour; ///< written by the writer
+} packed;
+
+/// reads done by one reader, padded so the counts don't share lines either
+typedef struct
+{
+    alignas(64) uint64_t reads; ///< number of reads
+} reader_count_t;
+
+static std::atomic<bool> stop;
+
+/**
+ * @brief
+ *   reader thread, reads the value until told to stop
+ */
+static void reader(bool use_hot, reader_count_t *count)
+{
+    uint64_t reads = 0;
+    uint64_t sum = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            sum += use_hot ? hot.Uint(HOT_RATE) : packed.rate;
+        }
+        reads += 256;
+    }
+    count->reads = reads + (sum == 1); // use sum so the reads aren't optimized away
+}
+
+/**
+ * @brief
+ *   writer thread, bumps the neighbour all the time and changes the rate every millisecond
+ */
+static void writer()
+{
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        packed.neighbour.fetch_add(1, std::memory_order_relaxed);
+        if (std::chrono::steady_clock::now() >= next)
+        {
+            next += std::chrono::milliseconds(1);
+            option_rate.value++;
+            packed.rate = option_rate.value;
+            options->SetOption(&option_rate);
+            options->NotifyObservers();
+        }
+    }
+}
+
+/**
+ * @brief
+ *   run the readers (and maybe the writer) for a while
+ *
+ * @return double - reads per second per reader
+ */
+static double measure(uint32_t num_threads, bool use_hot, bool with_writer)
+{
+    std::vector<reader_count_t> counts(num_threads);
+    std::vector<std::thread> threads;
+    stop = false;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        threads.push_back(std::thread(reader, use_hot, &counts[i]));
+    }
+    if (with_writer)
+    {
+        threads.push_back(std::thread(writer));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(option_ms.value));
+    stop = true;
+    uint64_t reads = 0;
+    for (uint32_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+        reads += (i < num_threads) ? counts[i].reads : 0;
+    }
+    return reads / (option_ms.value / 1000.0) / num_threads;
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    uint32_t num_threads = option_threads.value;
+    if (num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+        num_threads = (num_threads == 0) ? 1 : num_threads;
+    }
+    packed.rate = option_rate.value;
+    hot.Load();
+
+    printf("%u readers, %u ms each, %u copies of the hot values\n", num_threads, option_ms.value, hot.NumReplicas());
+    printf("                  writer idle    writer active   (million reads/s per reader)\n");
+    double idle = measure(num_threads, false, false);
+    double busy = measure(num_threads, false, true);
+    printf(".data value:      %11.1f      %11.1f\n", idle / 1e6, busy / 1e6);
+    idle = measure(num_threads, true, false);
+    busy = measure(num_threads, true, true);
+    printf("HotOptions value: %11.1f      %11.1f\n", idle / 1e6, busy / 1e6);
+    printf("final rate: %u, hot copy: %llu\n", option_rate.value, (unsigned long long)hot.Uint(HOT_RATE));
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "cmd_line_options.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+list_bench
+  - compares parsing a million value list with strtod()/strtoull() against DoubleListOption/Uint64ListOption
+)~");
+
+static DoubleListOption option_coefficients("coefficients:", "list of coefficients");
+
+static Uint64ListOption option_addresses("addresses:", "list of addresses");
+
+static const int NUM_VALUES = 1000000;
+
+/**
+ * @brief
+ *   the old way of parsing a list,... one strtod() call and one push_back() per value.
+ */
+static void strtod_list(const char *s, std::vector<double> *list)
+{
+    char *temp;
+    for (;;)
+    {
+        list->push_back(strtod(s, &temp));
+        if (*temp != ',')
+        {
+            break;
+        }
+        s = temp + 1;
+    }
+}
+
+/**
+ * @brief
+ *   the old way of parsing a list of 64 bit integers
+ */
+static void strtoull_list(const char *s, std::vector<uint64_t> *list)
+{
+    char *temp;
+    for (;;)
+    {
+        list->push_back(strtoull(s, &temp, 10));
+        if (*temp != ',')
+        {
+            break;
+        }
+        s = temp + 1;
+    }
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+
+    std::string doubles;
+    std::string integers;
+    srand(1);
+    for (int i = 0; i < NUM_VALUES; i++)
+    {
+        char value[64];
+        snprintf(value, sizeof(value), "%s%d.%04d", i ? "," : "", rand() % 2000 - 1000, rand() % 10000);
+        doubles += value;
+        snprintf(value, sizeof(value), "%s%llu", i ? "," : "", (unsigned long long)rand() * rand());
+        integers += value;
+    }
+
+    std::vector<double> double_list;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    strtod_list(doubles.c_str(), &double_list);
+    std::chrono::duration<double> strtod_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    bool ok = option_coefficients.ParseValue(doubles.c_str());
+    std::chrono::duration<double> double_list_time = std::chrono::steady_clock::now() - start;
+    ok = ok && (double_list == option_coefficients.value_list_);
+
+    std::vector<uint64_t> integer_list;
+    start = std::chrono::steady_clock::now();
+    strtoull_list(integers.c_str(), &integer_list);
+    std::chrono::duration<double> strtoull_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    ok = ok && option_addresses.ParseValue(integers.c_str());
+    std::chrono::duration<double> integer_list_time = std::chrono::steady_clock::now() - start;
+    ok = ok && (integer_list == option_addresses.value_list_);
+
+    printf("%d values, results %s\n", NUM_VALUES, ok ? "match" : "DON'T MATCH");
+    printf("strtod():          %8.1f ns per value %8.1f MB/s\n", strtod_time.count() * 1e9 / NUM_VALUES,
+           doubles.size() / strtod_time.count() / 1e6);
+    printf("DoubleListOption:  %8.1f ns per value %8.1f MB/s\n", double_list_time.count() * 1e9 / NUM_VALUES,
+           doubles.size() / double_list_time.count() / 1e6);
+    printf("strtoull():        %8.1f ns per value %8.1f MB/s\n", strtoull_time.count() * 1e9 / NUM_VALUES,
+           integers.size() / strtoull_time.count() / 1e6);
+    printf("Uint64ListOption:  %8.1f ns per value %8.1f MB/s\n", integer_list_time.count() * 1e9 / NUM_VALUES,
+           integers.size() / integer_list_time.count() / 1e6);
+    return ok ? 0 : -1;
+}
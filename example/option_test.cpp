@@ -14,7 +14,6 @@ class SomeEnumOption : public EnumOption
         AddEnum(2, "two", "you get the idea");
         AddEnum(3, "three", "each enum");
         AddEnum(4, "four", "has a usage message");
-        SetFromEnvironmentVariable();
     }
 };
 
@@ -38,10 +37,36 @@ static StringListOption option_some_stringlist("some_stringlist:", "testing some
 static OptionFreeStringListOption option_optionfreestringlist(
     "optionfreestringlist:", "testing optionfreestringlist (valid option terminates list)");
 
+static Int64ListOption option_some_int64list("some_int64list:", "testing some_int64list");
+
+static Uint64ListOption option_some_uint64list("some_uint64list:", "testing some_uint64list");
+
+static DoubleListOption option_some_doublelist("some_doublelist:", "testing some_doublelist");
+
 static DoubleOption option_some_double(0, "some_double", "testing some_double");
 
 static StringOption option_some_string("default", "some_string", "testing some_string");
 
+static AddrMaskOption option_some_addrmask("some_addrmask", "testing some_addrmask");
+
+static AddrMaskListOption option_some_addrmasklist("some_addrmasklist:", "testing some_addrmasklist");
+
+static void show_addr_mask(const char *name, const AddrMaskOption &option)
+{
+    printf("%s:", name);
+    for (std::vector<addr_and_mask_t>::const_iterator it = option.addr_mask_list_.begin();
+         it != option.addr_mask_list_.end(); ++it)
+    {
+        printf(" 0x%x:0x%x", it->addr, it->mask);
+    }
+    printf("\n");
+    for (std::vector<addr_mask_batch_t>::const_iterator it = option.batches_.begin(); it != option.batches_.end(); ++it)
+    {
+        const addr_and_mask_t *batch = &option.addr_mask_list_[it->first];
+        printf("%s batch: 0x%x count %u\n", name, batch->addr, it->count);
+    }
+}
+
 void option_test()
 {
     if (option_some_bool.is_set)
@@ -116,6 +141,39 @@ void option_test()
         }
         printf("\n");
     }
+    if (option_some_int64list.is_set)
+    {
+        printf("option_some_int64list.is_set\n");
+        printf("option_some_int64list:");
+        for (std::vector<int64_t>::const_iterator it = option_some_int64list.value_list_.begin();
+             it != option_some_int64list.value_list_.end(); ++it)
+        {
+            printf(" %" PRId64, *it);
+        }
+        printf("\n");
+    }
+    if (option_some_uint64list.is_set)
+    {
+        printf("option_some_uint64list.is_set\n");
+        printf("option_some_uint64list:");
+        for (std::vector<uint64_t>::const_iterator it = option_some_uint64list.value_list_.begin();
+             it != option_some_uint64list.value_list_.end(); ++it)
+        {
+            printf(" 0x%" PRIx64, *it);
+        }
+        printf("\n");
+    }
+    if (option_some_doublelist.is_set)
+    {
+        printf("option_some_doublelist.is_set\n");
+        printf("option_some_doublelist:");
+        for (std::vector<double>::const_iterator it = option_some_doublelist.value_list_.begin();
+             it != option_some_doublelist.value_list_.end(); ++it)
+        {
+            printf(" %g", *it);
+        }
+        printf("\n");
+    }
     if (option_some_double.is_set)
     {
         printf("option_some_double.is_set\n");
@@ -126,4 +184,14 @@ void option_test()
         printf("option_some_string.is_set\n");
         printf("option_some_string.value = \"%s\"\n", option_some_string.value);
     }
+    if (option_some_addrmask.is_set)
+    {
+        printf("option_some_addrmask.is_set\n");
+        show_addr_mask("option_some_addrmask", option_some_addrmask);
+    }
+    if (option_some_addrmasklist.is_set)
+    {
+        printf("option_some_addrmasklist.is_set\n");
+        show_addr_mask("option_some_addrmasklist", option_some_addrmasklist);
+    }
 }
@@ -0,0 +1,150 @@
+#include "cmd_line_options.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+registry_bench
+  - compares option lookup through the registry with a scan of the option objects (the old layout) and a scan
+    of packed name hashes and lengths (the registry's layout), and resetting every option with resetting the
+    options that were set
+)~");
+
+static const int NUM_OPTIONS = 10000;
+static const int NUM_LOOKUPS = 2000;
+
+/**
+ * @brief
+ *   the old way of finding an option,... strcmp against every option object.
+ */
+static CmdLineOption *scan_option_objects(CmdLineOptions *options, const char *name)
+{
+    for (size_t i = 0; i < options->OptionCount(); i++)
+    {
+        CmdLineOption *option = options->GetOption(i);
+        if (strcmp(name, option->name) == 0)
+        {
+            return option;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief
+ *   the same scan over the registry's layout,... a hash and a length per option, packed together,
+ *   and the option object is only touched when both match.
+ */
+static CmdLineOption *scan_packed_names(CmdLineOptions *options, const std::vector<uint32_t> &hashes,
+                                        const std::vector<uint16_t> &lengths, const char *name)
+{
+    uint32_t length;
+    uint32_t hash = (uint32_t)option_name_hash(name, &length);
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        if ((hashes[i] == hash) && (lengths[i] == length) && (memcmp(options->GetOption(i)->name, name, length) == 0))
+        {
+            return options->GetOption(i);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    std::vector<char *> names;
+    std::vector<char *> padding;
+    for (int i = 0; i < NUM_OPTIONS; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "bench_option_%05d", i);
+        names.push_back(strdup(name));
+        new IntOption(0, names.back(), "benchmark option");
+        // scatter the option objects through the heap, like options in many .data sections
+        padding.push_back(new char[200]);
+    }
+    CmdLineOptions::ParseOptions(argc, argv);
+
+    std::vector<const char *> queries;
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        queries.push_back(names[(i * 7919) % NUM_OPTIONS]);
+    }
+
+    // copies of the registry's _name_hash and _name_length
+    std::vector<uint32_t> hashes;
+    std::vector<uint16_t> lengths;
+    for (size_t i = 0; i < options->OptionCount(); i++)
+    {
+        uint32_t length;
+        hashes.push_back((uint32_t)option_name_hash(options->GetOption(i)->name, &length));
+        lengths.push_back(length);
+    }
+
+    // the first lookup builds the registry's hash table
+    size_t found = options->FindOption(queries[0]) != NULL;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        found += scan_option_objects(options, queries[i]) != NULL;
+    }
+    std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        found += scan_packed_names(options, hashes, lengths, queries[i]) != NULL;
+    }
+    std::chrono::duration<double> packed_scan_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        found += options->FindOption(queries[i]) != NULL;
+    }
+    std::chrono::duration<double> find_time = std::chrono::steady_clock::now() - start;
+
+    // a batch tool sets an option or two per line, then resets
+    const char *line[] = {"parse_string", "bench_option_00042=1"};
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        CmdLineOptions::ParseOptions(2, line);
+        options->Reset();
+    }
+    std::chrono::duration<double> reset_all_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        CmdLineOptions::ParseOptions(2, line);
+        options->ResetTouched();
+    }
+    std::chrono::duration<double> reset_time = std::chrono::steady_clock::now() - start;
+
+    printf("%d options, %zu lookups found\n", NUM_OPTIONS, found);
+    printf("scan of option objects: %10.1f ns per lookup\n", scan_time.count() * 1e9 / NUM_LOOKUPS);
+    printf("scan of packed names:   %10.1f ns per lookup\n", packed_scan_time.count() * 1e9 / NUM_LOOKUPS);
+    printf("registry FindOption():  %10.1f ns per lookup\n", find_time.count() * 1e9 / NUM_LOOKUPS);
+    printf("parse + Reset():        %10.1f ns per line\n", reset_all_time.count() * 1e9 / NUM_LOOKUPS);
+    printf("parse + ResetTouched(): %10.1f ns per line\n", reset_time.count() * 1e9 / NUM_LOOKUPS);
+    // a scan of the objects reads the pointer, the object's name pointer and the name (one line each)
+    size_t name_bytes = 0;
+    for (size_t i = 0; i < options->OptionCount(); i++)
+    {
+        name_bytes += strlen(options->GetOption(i)->name) + 1;
+    }
+    size_t object_bytes = options->OptionCount() * (sizeof(CmdLineOption *) + sizeof(IntOption)) + name_bytes;
+    size_t packed_bytes = options->OptionCount() * (sizeof(uint32_t) + sizeof(uint16_t));
+    printf("option objects layout:  %10zu bytes (%.1f bytes per option, pointers + objects + names)\n", object_bytes,
+           (double)object_bytes / options->OptionCount());
+    printf("packed names layout:    %10zu bytes (%.1f bytes per option, hash + length)\n", packed_bytes,
+           (double)packed_bytes / options->OptionCount());
+    printf("registry:               %10zu bytes (%.1f bytes per option, all its tables)\n", options->RegistryBytes(),
+           (double)options->RegistryBytes() / options->OptionCount());
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "cmd_line_options.h"
+#include "cmd_line_options_script.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// OptionGroup just inserts a help message, doesn't affect parsing.
+OptionGroup option_help_message(
+    R"~(
+script_bench
+  - compares running a script with CmdLineOptionsScript against parsing its lines one after another,
+    with 1, 2, 4, ... worker threads
+)~");
+
+static UintOption option_lines(200000, "lines", "number of lines in the script");
+static UintOption option_threads(0, "threads", "most worker threads to try, 0 for one per CPU");
+
+static IntOption option_count(1, "count", "number of times to run");
+static UintOption option_rate(100, "rate", "rate");
+static DoubleOption option_scale(1.0, "scale", "scale");
+static StringOption option_label("none", "label", "label for the results");
+static BoolOption option_verbose(false, "verbose", "verbose");
+static IntListOption option_channels("channels:", "channels to test");
+
+/**
+ * @brief
+ *   callback that just counts the lines
+ */
+static bool count_line(const ScriptLine &line, void *arg)
+{
+    *(uint64_t *)arg += (line.error.code == PARSE_ERROR_NONE);
+    return true;
+}
+
+/**
+ * @brief
+ *   CPU time of the calling thread, so the workers' time isn't counted
+ */
+static double thread_cpu_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief
+ *   seconds since 'start'
+ */
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+    uint32_t num_lines = option_lines.value;
+    uint32_t max_threads = option_threads.value;
+    if (max_threads == 0)
+    {
+        max_threads = std::thread::hardware_concurrency();
+        max_threads = (max_threads == 0) ? 1 : max_threads;
+    }
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    registry->Reset();
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/script_bench.%d", (int)getpid());
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        perror(path);
+        return 255;
+    }
+    for (uint32_t i = 0; i < num_lines; i++)
+    {
+        fprintf(f, "count=%u rate=%u scale=%u.5 label=run%u %s channels: %u %u %u\n", i % 10, i % 1000, i % 7,
+                i % 100, (i & 1) ? "verbose" : "", i % 16, i % 16 + 1, i % 16 + 2);
+    }
+    fclose(f);
+
+    // the lines one after another on this thread, split once beforehand so only the parse is timed,... reset the
+    // way Run() does
+    std::vector<std::string> text;
+    f = fopen(path, "r");
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), f) != NULL)
+    {
+        text.push_back(buffer);
+    }
+    fclose(f);
+    std::vector<std::vector<const char *>> lines(text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        char *s = &text[i][0];
+        for (char *arg = strtok(s, " \n"); arg != NULL; arg = strtok(NULL, " \n"))
+        {
+            lines[i].push_back(arg);
+        }
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t good = 0;
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        parse_error_t error;
+        registry->ResetTouched();
+        good += registry->TryParseOptions(lines[i].size(), lines[i].data(), &error);
+    }
+    double serial = seconds_since(start);
+    registry->Reset();
+    printf("%u lines, %u CPUs\n", num_lines, std::thread::hardware_concurrency());
+    printf("one after another:  %8.0f ns per line  (%llu good)\n", serial * 1e9 / num_lines,
+           (unsigned long long)good);
+
+    CmdLineOptionsScript script;
+    if (!script.Open(path))
+    {
+        return 255;
+    }
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        good = 0;
+        start = std::chrono::steady_clock::now();
+        double cpu_start = thread_cpu_seconds();
+        script.Run(count_line, &good, threads);
+        double caller = thread_cpu_seconds() - cpu_start;
+        double run = seconds_since(start);
+        // the calling thread applies the lines in order, so with enough CPUs a run can't take less than its part
+        printf("%2u worker threads: %8.0f ns per line, %5.2fx   calling thread %6.0f ns per line, at most %5.2fx"
+               "  (%llu good)\n",
+               threads, run * 1e9 / num_lines, serial / run, caller * 1e9 / num_lines, serial / caller,
+               (unsigned long long)good);
+    }
+    script.Close();
+    unlink(path);
+    return 0;
+}
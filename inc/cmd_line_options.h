@@ -6,8 +6,19 @@
  *   This file parses command line options.
  */
 
+#ifndef CMD_LINE_OPTIONS_H
+#define CMD_LINE_OPTIONS_H
+
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
 #include <ostream>
+#include <shared_mutex>
 #include <stdint.h>
+#include <string>
+#include <string_view>
 #include <vector>
 
 extern "C" void cmd_line_options_parse_options(int argc, const char **argv);
@@ -23,6 +34,44 @@ typedef struct
     uint32_t mask; ///< field mask
 } addr_and_mask_t;
 
+/**
+ * @brief
+ *  a batch of registers at consecutive addresses,
+ *  i.e. addr_mask_list_[first] .. addr_mask_list_[first + count - 1] are default_step apart.
+ */
+typedef struct
+{
+    uint32_t first; ///< index of the first register in addr_mask_list_
+    uint32_t count; ///< number of registers
+} addr_mask_batch_t;
+
+/**
+ * @brief
+ *   option types, so the registry can tell options apart without RTTI
+ */
+typedef enum
+{
+    CMD_LINE_OPTION_OTHER,       ///< user defined option
+    CMD_LINE_OPTION_GROUP,       ///< OptionGroup
+    CMD_LINE_OPTION_BOOL,        ///< BoolOption
+    CMD_LINE_OPTION_ENUM,        ///< EnumOption
+    CMD_LINE_OPTION_INT,         ///< IntOption
+    CMD_LINE_OPTION_UINT,        ///< UintOption
+    CMD_LINE_OPTION_INT64,       ///< Int64Option
+    CMD_LINE_OPTION_UINT64,      ///< Uint64Option
+    CMD_LINE_OPTION_INT_RANGE,   ///< IntRangeOption
+    CMD_LINE_OPTION_INT_LIST,    ///< IntListOption
+    CMD_LINE_OPTION_INT64_LIST,  ///< Int64ListOption
+    CMD_LINE_OPTION_UINT64_LIST, ///< Uint64ListOption
+    CMD_LINE_OPTION_DOUBLE_LIST, ///< DoubleListOption
+    CMD_LINE_OPTION_STRING_LIST, ///< StringListOption and OptionFreeStringListOption
+    CMD_LINE_OPTION_DOUBLE,      ///< DoubleOption
+    CMD_LINE_OPTION_STRING,      ///< StringOption
+    CMD_LINE_OPTION_ADDR_MASK,   ///< AddrMaskOption and AddrMaskListOption
+    CMD_LINE_OPTION_SUBCOMMAND,  ///< Subcommand
+    CMD_LINE_OPTION_CPU_SET,     ///< CpuSetOption
+} cmd_line_option_type_t;
+
 /**
  * @brief class used for parsing command line options
  */
@@ -34,16 +83,25 @@ class CmdLineOption
     /// pure virtual function
     virtual bool ParseValue(const char *s) = 0;
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool TryParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
+    virtual void CompleteValue(const char *prefix, std::vector<const char *> &matches);
+    virtual size_t MemoryBytes(size_t *unused);
+    virtual bool MapFile(const char *path);
+    virtual bool CheckFile(const char *path);
     void SetFromEnvironmentVariable();
     virtual void EndOfList();
     virtual void Reset();
     virtual void OptionSet();
-    const char *name;          ///< name of the option
-    const char *usage_message; ///< usage message for the option
-    bool is_set;               ///< was the option set on the command line
-    bool is_list;              ///< does the option take a list of parameters.
-    bool is_option_free_list;  ///< should the list terminate if a token looks like a command line option.
-    bool is_bool;              ///< is this option a 'bool' option which does not need an '='
+    const char *name;            ///< name of the option
+    const char *usage_message;   ///< usage message for the option
+    bool is_set;                 ///< was the option set on the command line
+    bool is_list;                ///< does the option take a list of parameters.
+    bool is_option_free_list;    ///< should the list terminate if a token looks like a command line option.
+    bool is_bool;                ///< is this option a 'bool' option which does not need an '='
+    cmd_line_option_type_t type; ///< type of option
+    uint32_t index;              ///< position of this option in the CmdLineOptions registry
 };
 
 /**
@@ -56,6 +114,9 @@ class BoolOption : public CmdLineOption
     BoolOption(bool default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
+    virtual void CompleteValue(const char *prefix, std::vector<const char *> &matches);
     virtual void Reset();
     bool value;          ///< boolean value
     bool _default_value; ///< boolean value
@@ -82,9 +143,14 @@ class EnumOption : public CmdLineOption
     EnumOption(uint32_t default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool TryParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
+    virtual void CompleteValue(const char *prefix, std::vector<const char *> &matches);
     const char *GetString(uint32_t value);
     void AddEnum(uint32_t value, const char *str, const char *usage_message = "");
     virtual void Reset();
+    virtual size_t MemoryBytes(size_t *unused);
     uint32_t value;                      ///< integer value
     uint32_t _default_value;             ///< integer value
     std::vector<value_str_t> enum_list_; ///< list of string value pairs
@@ -100,6 +166,8 @@ class IntOption : public CmdLineOption
     IntOption(int32_t default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     int32_t value;          ///< signed integer value
     int32_t _default_value; ///< signed integer value
@@ -115,6 +183,8 @@ class UintOption : public CmdLineOption
     UintOption(uint32_t default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     uint32_t value;          ///< unsigned integer value
     uint32_t _default_value; ///< unsigned integer value
@@ -130,6 +200,8 @@ class Int64Option : public CmdLineOption
     Int64Option(int64_t default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     int64_t value;          ///< signed 64 bit integer value
     int64_t _default_value; ///< signed 64 bit integer value
@@ -145,6 +217,8 @@ class Uint64Option : public CmdLineOption
     Uint64Option(uint64_t default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     uint64_t value;          ///< unsigned 64 bit integer value
     uint64_t _default_value; ///< unsigned 64 bit integer value
@@ -160,12 +234,107 @@ class IntRangeOption : public CmdLineOption
     IntRangeOption(const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
+    bool Contains(int32_t value) const;
     int32_t start_value; ///< start of a range
     int32_t end_value;   ///< end of a range
     int32_t size;        ///< size of the range
 };
 
+/**
+ * @brief
+ *   values of a list option that come from a file, 'name:=@file',... the file is mapped rather than read,
+ *   and the values are decoded as they're iterated over, so only the pages that are used are read in.
+ *
+ *   a text file has one value per line (empty lines are skipped).  for a list of integers, each line is a single
+ *   number, decimal or hex with 0x,... ranges and comma separated values aren't supported, and Map() rejects a file
+ *   with a line that isn't a number.  with 'name:=@raw:file', the file is an array of the list's values in the
+ *   machine's byte order.
+ */
+class MappedList
+{
+  public:
+    MappedList();
+    ~MappedList();
+    bool Map(const char *_path, size_t raw_size);
+    static bool Check(const char *_path, size_t raw_size);
+    void Unmap();
+    void DropPages() const;
+    const char *First() const;
+    const char *Next(const char *pos) const;
+    void Decode(const char *pos, int32_t *value) const;
+    void Decode(const char *pos, std::string_view *value) const;
+    /// end of the values, NULL if there's no file
+    const char *End() const
+    {
+        return end_;
+    }
+    const char *path; ///< the file, NULL if there isn't one
+
+  private:
+    const char *data_; ///< the mapped file
+    const char *end_;  ///< end of the values in the file (of the last whole value of a raw file)
+    size_t size_;      ///< size of the mapping
+    size_t raw_size_;  ///< size of a value in a raw file, 0 for a text file
+};
+
+/**
+ * @brief
+ *   iterator over a list option's values: the ones on the command line, then the ones in its file (if any),
+ *   which are only decoded when the iterator gets to them.
+ */
+template <typename T, typename E> class ListIterator
+{
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef T reference;
+    ListIterator(const std::vector<E> *list, size_t index, const MappedList *file, const char *pos)
+        : list_(list), index_(index), file_(file), pos_(pos)
+    {
+    }
+    T operator*() const
+    {
+        if (index_ < list_->size())
+        {
+            return T((*list_)[index_]);
+        }
+        T value;
+        file_->Decode(pos_, &value);
+        return value;
+    }
+    ListIterator &operator++()
+    {
+        if (index_ < list_->size())
+        {
+            index_++;
+        }
+        else
+        {
+            pos_ = file_->Next(pos_);
+        }
+        return *this;
+    }
+    bool operator==(const ListIterator &other) const
+    {
+        return (index_ == other.index_) && (pos_ == other.pos_);
+    }
+    bool operator!=(const ListIterator &other) const
+    {
+        return !(*this == other);
+    }
+
+  private:
+    const std::vector<E> *list_; ///< values from the command line
+    size_t index_;               ///< position in list_
+    const MappedList *file_;     ///< values from the file
+    const char *pos_;            ///< position in the file, once past list_
+};
+
 /**
  * @brief
  *   list of integers command line option
@@ -175,14 +344,174 @@ class IntListOption : public CmdLineOption
   public:
     IntListOption(const char *_name, const char *_usage_message, uint32_t _default_step = 1);
     virtual bool ParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual void ShowValue(std::ostream &out);
     virtual void AddValue(int32_t value);
     virtual void Reset();
     virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    virtual bool MapFile(const char *path);
+    virtual bool CheckFile(const char *path);
+    typedef ListIterator<int32_t, int32_t> const_iterator;
+    const_iterator begin() const;
+    const_iterator end() const;
+    const std::vector<int32_t> &Values();
+    bool Contains(int32_t value) const;
     std::vector<int32_t> value_list_;       ///< list of values
     std::vector<const char *> string_list_; ///< list of strings
+    MappedList file_;                       ///< values from 'name:=@file', after value_list_ (see begin())
     int32_t default_step;                   ///< step size
     uint32_t mask; ///< if the value list is a list of integers from 0..31,... mask is which bits are set.
+
+  private:
+    void BuildIndex() const;
+
+    // the first Contains() builds an index,... a bitmap if the values are close together, else runs
+    mutable std::vector<uint64_t> bitmap_;    ///< bit (value - index_base_) is set for each value
+    mutable std::vector<int32_t> run_start_;  ///< start of each run of consecutive values, in Eytzinger order from [1]
+    mutable std::vector<int32_t> run_end_;    ///< end (included) of each run, in the same order
+    mutable int32_t index_base_;              ///< value of bit 0 of bitmap_
+    mutable std::atomic<size_t> index_count_; ///< size of value_list_ when the index was built, SIZE_MAX if it wasn't
+    mutable std::mutex index_mutex_;          ///< held while the index is built, so only one thread builds it
+    std::vector<int32_t> values_;             ///< value_list_ and then the file's values, for Values()
+    size_t values_count_;                     ///< size of value_list_ when values_ was filled, SIZE_MAX if it wasn't
+};
+
+/**
+ * @brief
+ *   list of 64 bit integers command line option
+ *
+ *   each argument can hold several comma separated values, and each value can be a range,
+ *   e.g. 'offsets: 1,2,3 0x1000..0x1010 100+4/8'. long runs of plain numbers are parsed 8 digits at a time.
+ */
+class Int64ListOption : public CmdLineOption
+{
+  public:
+    Int64ListOption(const char *_name, const char *_usage_message, uint64_t _default_step = 1);
+    virtual bool ParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual void ShowValue(std::ostream &out);
+    virtual void Reset();
+    virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    std::vector<int64_t> value_list_; ///< list of values
+    uint64_t default_step;            ///< step size for ranges
+};
+
+/**
+ * @brief
+ *   list of unsigned 64 bit integers command line option (same formats as Int64ListOption)
+ */
+class Uint64ListOption : public CmdLineOption
+{
+  public:
+    Uint64ListOption(const char *_name, const char *_usage_message, uint64_t _default_step = 1);
+    virtual bool ParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual void ShowValue(std::ostream &out);
+    virtual void Reset();
+    virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    std::vector<uint64_t> value_list_; ///< list of values
+    uint64_t default_step;             ///< step size for ranges
+};
+
+/**
+ * @brief
+ *   set of CPUs command line option, e.g. for pinning threads: 'cpus=0-7,16-23,32+8/2'
+ *
+ *   the value is comma separated CPUs or ranges, in the Uint64ListOption formats (0..7, 32+8/2)
+ *   or the Linux a-b format.  every CPU must be online.  without a value, the set is all the online CPUs.
+ *
+ *   the CPUs are kept in the order they were given (without repeats), so threads can be spread over them
+ *   round robin with CpuForThread() or PinThread(), and mask_ has the same layout as a cpu_set_t
+ *   (CPU_ALLOC_SIZE() bytes for the CPUs of the machine), for sched_setaffinity() and friends.
+ *
+ *   the default is worked out by the constructor and Reset(), on the thread that parses, so the accessors
+ *   only read and any number of worker threads can call them at once.
+ */
+class CpuSetOption : public CmdLineOption
+{
+  public:
+    CpuSetOption(const char *default_value, const char *_name, const char *_usage_message);
+    virtual bool ParseValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
+    virtual void Reset();
+    virtual size_t MemoryBytes(size_t *unused);
+    const std::vector<uint32_t> &Cpus() const;
+    const std::vector<unsigned long> &Mask() const;
+    uint32_t CpuForThread(uint32_t thread) const;
+    bool PinThread(uint32_t thread) const;
+    bool PinToSet() const;
+    std::vector<uint32_t> value_list_; ///< CPUs in the set, in the order given (the default's if it isn't set)
+    std::vector<unsigned long> mask_;  ///< the set as a cpu_set_t bitmap
+    const char *_default_value;        ///< default set, NULL or "" for all the online CPUs
+
+  private:
+    void SetDefault();
+};
+
+/**
+ * @brief
+ *   list of doubles command line option
+ *
+ *   each argument can hold several comma separated values, e.g. 'coefficients: 0.25,0.5,0.25 1e-3'
+ */
+class DoubleListOption : public CmdLineOption
+{
+  public:
+    DoubleListOption(const char *_name, const char *_usage_message);
+    virtual bool ParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual void ShowValue(std::ostream &out);
+    virtual void Reset();
+    virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    std::vector<double> value_list_; ///< list of values
+};
+
+/**
+ * @brief
+ *   register address and mask command line option
+ *
+ *   formats are addr, addr:mask, start..end:mask and start+count/stride:mask (the mask defaults to 0xffffffff).
+ *   the registers are kept sorted by address with duplicates merged, and grouped into batches of consecutive
+ *   registers, so a range of registers can be read or written with as few accesses as possible.
+ */
+class AddrMaskOption : public CmdLineOption
+{
+  public:
+    AddrMaskOption(const char *_name, const char *_usage_message, uint32_t _default_step = 4);
+    virtual bool ParseValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
+    virtual void Reset();
+    virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    std::vector<addr_and_mask_t> addr_mask_list_; ///< registers sorted by address, one entry per address
+    std::vector<addr_mask_batch_t> batches_;      ///< runs of consecutive registers in addr_mask_list_
+    uint32_t default_step;                        ///< distance between consecutive registers
+
+  protected:
+    void Coalesce();
+};
+
+/**
+ * @brief
+ *   list of register addresses and masks command line option
+ */
+class AddrMaskListOption : public AddrMaskOption
+{
+  public:
+    AddrMaskListOption(const char *_name, const char *_usage_message, uint32_t _default_step = 4);
+    virtual bool ParseValue(const char *s);
 };
 
 /**
@@ -194,9 +523,23 @@ class StringListOption : public CmdLineOption
   public:
     StringListOption(const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     virtual void EndOfList();
+    virtual size_t MemoryBytes(size_t *unused);
+    virtual bool MapFile(const char *path);
+    virtual bool CheckFile(const char *path);
+    typedef ListIterator<std::string_view, const char *> const_iterator;
+    const_iterator begin() const;
+    const_iterator end() const;
+    const std::vector<const char *> &Strings();
     std::vector<const char *> string_list_; ///< list of strings
+    MappedList file_;                       ///< strings from 'name:=@file', after string_list_ (see begin())
+
+  private:
+    std::vector<const char *> strings_; ///< string_list_ and then the file's lines, for Strings()
+    std::vector<char> lines_;           ///< the file's lines, 0 terminated, that strings_ points to
+    size_t strings_count_;              ///< size of string_list_ when strings_ was filled, SIZE_MAX if it wasn't
 };
 
 /**
@@ -219,6 +562,8 @@ class DoubleOption : public CmdLineOption
     DoubleOption(double default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
     virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool CheckValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     double value;          ///< double command line value
     double _default_value; ///< double command line value
@@ -233,6 +578,7 @@ class StringOption : public CmdLineOption
   public:
     StringOption(const char *default_value, const char *_name, const char *_usage_message);
     virtual bool ParseValue(const char *s);
+    virtual void ShowValue(std::ostream &out);
     virtual void Reset();
     const char *value;          ///< string command line option
     const char *_default_value; ///< string command line option
@@ -250,12 +596,337 @@ class OptionGroup : public CmdLineOption
     {
         return false;
     }
+    /// not a real command line option
+    virtual bool CheckValue(const char *)
+    {
+        return false;
+    }
     /// constructor
     OptionGroup(const char *_usage_message) : CmdLineOption("", _usage_message)
     {
+        this->type = CMD_LINE_OPTION_GROUP;
     }
 };
 
+/**
+ * @brief
+ *   a git style verb (e.g. "run", "dump"),... its options can only be used after it on the command line.
+ *
+ *   options that aren't in any subcommand are global, and can be used with every subcommand.
+ *   a subcommand's options aren't looked up, reset or read from the environment unless it is selected,
+ *   so a tool with lots of verbs only pays for the one it runs.  like OptionConstraint, the options are listed:
+ *
+ *     static Subcommand run_command("run", "run the test", {&option_channels, &option_test_time});
+ *     static Subcommand dump_command("dump", "dump registers", {&dump_help, &option_regs});
+ *
+ *   an OptionGroup in the list goes in the subcommand's section of the usage message.
+ */
+class Subcommand : public CmdLineOption
+{
+  public:
+    Subcommand(const char *_name, const char *_usage_message, std::initializer_list<CmdLineOption *> _options);
+    virtual bool ParseValue(const char *s);
+    virtual bool ParseValueWithError(const char *s, std::ostream &error_message);
+    virtual bool TryParseValue(const char *s);
+    virtual bool CheckValue(const char *s);
+    virtual void Reset();
+    virtual void OptionSet();
+    virtual size_t MemoryBytes(size_t *unused);
+    std::vector<CmdLineOption *> options_; ///< options of this subcommand
+    std::vector<uint32_t> hash_table_;     ///< lookup table of options_, built the first time it's selected
+};
+
+/**
+ * @brief
+ *   puts a library's options under a dotted prefix, so libraries can pick short names without colliding:
+ *
+ *     static IntOption option_queue_depth(16, "queue_depth", "descriptors per queue");
+ *     static BoolOption option_trace(false, "trace", "trace every descriptor");
+ *     static OptionNamespace dma_namespace("dma", {&option_queue_depth, &option_trace});
+ *
+ *   the options are then "dma.queue_depth" and "dma.trace".  an option can also just be given a dotted name.
+ *   namespaces nest, "hw.dma.trace" is in "hw.dma" and "hw".  the names are changed when the namespace is
+ *   constructed, so declare it after its options, like a Subcommand.
+ */
+class OptionNamespace
+{
+  public:
+    OptionNamespace(const char *_prefix, std::initializer_list<CmdLineOption *> _options);
+    const char *prefix; ///< namespace name, e.g. "dma"
+
+  private:
+    std::vector<std::string> names_; ///< new names of the options
+};
+
+/**
+ * @brief
+ *   "help" shows the usage message, "help=dma.*" just the options in a namespace, then the program exits.
+ *
+ *     static HelpOption option_help("help", "show the options, help=<namespace>.* for just some");
+ */
+class HelpOption : public CmdLineOption
+{
+  public:
+    HelpOption(const char *_name, const char *_usage_message);
+    virtual bool ParseValue(const char *s);
+    virtual void Reset();
+    virtual void OptionSet();
+    const char *value; ///< namespace to show, "" for every option
+};
+
+/**
+ * @brief
+ *   what went wrong while parsing
+ */
+typedef enum
+{
+    PARSE_ERROR_NONE,          ///< no error
+    PARSE_ERROR_NO_MATCH,      ///< argument doesn't match an option
+    PARSE_ERROR_BAD_VALUE,     ///< option value can't be parsed
+    PARSE_ERROR_BAD_LIST_ITEM, ///< list item can't be parsed (and isn't an option that ends the list)
+    PARSE_ERROR_CONSTRAINT,    ///< an OptionConstraint is broken
+    PARSE_ERROR_BAD_FILE,      ///< the file of a 'name:=@file' list can't be used
+} parse_error_code_t;
+
+/**
+ * @brief
+ *   parse error,... just the facts, CmdLineOptions::RenderError() turns it into a message.
+ */
+typedef struct
+{
+    parse_error_code_t code; ///< what went wrong
+    int32_t arg_index;       ///< index of the bad argument in argv, -1 for PARSE_ERROR_CONSTRAINT
+    int32_t option_index;    ///< option (CmdLineOptions::GetOption()), or the constraint for PARSE_ERROR_CONSTRAINT
+    uint32_t offset;         ///< byte offset of the bad part of the argument (e.g. the value after '=')
+} parse_error_t;
+
+/**
+ * @brief
+ *   kinds of relations between options
+ */
+typedef enum
+{
+    OPTION_REQUIRES,  ///< if the first option is set, all the others must be set too
+    OPTION_CONFLICTS, ///< at most one of the options can be set
+    OPTION_ONE_OF,    ///< exactly one of the options must be set
+    OPTION_AT_MOST,   ///< at most 'count' of the options can be set
+} option_constraint_t;
+
+/**
+ * @brief
+ *   a rule about which options can be used together,... checked after the options are parsed.
+ *
+ *   like options, constraints are static objects that add themselves to the CmdLineOptions singleton:
+ *
+ *     static OptionConstraint range_needs_uint(OPTION_REQUIRES, {&option_some_intrange, &option_some_uint});
+ *     static OptionConstraint pick_one(OPTION_ONE_OF, {&option_smoke_test, &option_endurance_test});
+ *     static OptionConstraint at_most_two(OPTION_AT_MOST, {&option_a, &option_b, &option_c}, 2);
+ */
+class OptionConstraint
+{
+  public:
+    OptionConstraint(option_constraint_t _kind, std::initializer_list<CmdLineOption *> _options, uint32_t _count = 1);
+    option_constraint_t kind;              ///< kind of relation
+    std::vector<CmdLineOption *> options_; ///< options in the relation
+    uint32_t count;                        ///< limit for OPTION_AT_MOST
+};
+
+/**
+ * @brief
+ *   watches a set of options, and is told once per parse which of them were set.
+ *
+ *   a parse (TryParseOptions(), ParseString(), CmdLineOptionParser::Finish(), or the CmdLineOptionsControl::Apply()
+ *   after a control plane "set") collects the options it sets, and when it's done, each observer that watches any
+ *   of them gets one call of OptionsChanged() with the list.  the call comes from the thread that parsed (or called
+ *   Apply()),... the registry isn't thread safe, so that should always be the same thread.  Reset(), ResetTouched() and
+ *   ResetNamespace() are changes too,... the options they put back to their defaults are handed out the same way.
+ *
+ *   every notification also bumps the observer's generation, so other threads can sleep until something
+ *   changes instead of polling the values (on Linux, Wait() is a futex wait):
+ *
+ *     static OptionObserver rate_observer({&option_rate, &option_burst});
+ *
+ *     uint32_t generation = rate_observer.Generation();
+ *     while (running)
+ *     {
+ *         generation = rate_observer.Wait(generation);
+ *         ApplyRate(option_rate.value, option_burst.value);
+ *     }
+ *
+ *   options of static tables aren't CmdLineOption's, so they can't be watched.
+ */
+class OptionObserver
+{
+  public:
+    OptionObserver(std::initializer_list<CmdLineOption *> _options);
+    virtual ~OptionObserver();
+    virtual void OptionsChanged(const std::vector<CmdLineOption *> &changed);
+    uint32_t Wait(uint32_t generation, int32_t timeout_ms = -1);
+    /// number of notifications so far
+    uint32_t Generation() const
+    {
+        return generation_.load(std::memory_order_acquire);
+    }
+    std::vector<CmdLineOption *> options_; ///< options being watched
+
+  private:
+    friend class CmdLineOptions;
+    void Notify();
+
+    std::atomic<uint32_t> generation_;    ///< bumped after every notification
+    std::atomic<uint32_t> waiters_;       ///< threads in Wait(), so Notify() only wakes when needed
+    std::vector<CmdLineOption *> changed_; ///< options changed in the parse being notified
+};
+
+/**
+ * @brief
+ *   hash an option name (64 bit FNV-1a),... constexpr so static option tables can be hashed by the compiler.
+ *
+ * @param[in] name - option name
+ * @param[out] length - length of the name
+ *
+ * @return uint64_t - hash of the name
+ */
+constexpr uint64_t option_name_hash(const char *name, uint32_t *length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    uint32_t i = 0;
+    for (; name[i] != 0; i++)
+    {
+        hash = (hash ^ (uint8_t)name[i]) * 1099511628211ull;
+    }
+    *length = i;
+    return hash;
+}
+
+/**
+ * @brief
+ *   pick a slot for a name hash (murmur3 finalizer),... different seeds give independent slots.
+ *
+ * @param[in] hash - hash of the name
+ * @param[in] seed - 0 for the bucket, or the displacement of the bucket
+ *
+ * @return uint32_t - slot, to be masked with the table size - 1
+ */
+constexpr uint32_t option_hash_slot(uint64_t hash, uint32_t seed)
+{
+    hash += seed * 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return (uint32_t)(hash ^ (hash >> 33));
+}
+
+/**
+ * @brief
+ *   one option of a StaticOptionTable
+ */
+typedef struct
+{
+    const char *name;            ///< name of the option
+    const char *usage_message;   ///< usage message for the option
+    cmd_line_option_type_t type; ///< BOOL, INT, UINT, INT64, UINT64, DOUBLE or STRING
+    uint32_t offset;             ///< offset of the value in the table's values
+} static_option_t;
+
+/**
+ * @brief
+ *   one slot of the perfect hash table of a StaticOptionTable
+ */
+typedef struct
+{
+    uint32_t hash;   ///< low 32 bits of the name hash, so most misses don't touch the name
+    uint32_t option; ///< index of the option in this slot, UINT32_MAX if the slot is empty
+} static_option_slot_t;
+
+/**
+ * @brief
+ *   options declared at compile time (see cmd_line_options_static.h)
+ *
+ *   the compiler builds the tables, so a StaticOptionTable is just constant data: no constructor runs,
+ *   and nothing happens until it is added with CmdLineOptions::AddStaticOptions(),
+ *   or found in the linker section by the registry (CMD_LINE_STATIC_OPTIONS_REGISTER).
+ *
+ *   names are found with a perfect hash (hash and displace),... the name hash picks a bucket,
+ *   and the bucket says which slot its names are in, either directly (< 0) or as the seed of a second hash (> 0).
+ */
+class StaticOptionTable
+{
+  public:
+    int32_t Find(const char *name, uint32_t length, uint64_t hash) const;
+    bool Parse(uint32_t i, const char *s);
+    bool Check(uint32_t i, const char *s) const;
+    void Reset(uint32_t i);
+    const char *name;                  ///< name of the table, tables in the linker section are added in name order
+    const static_option_t *options;    ///< options
+    uint32_t count;                    ///< number of options
+    uint32_t mask;                     ///< number of buckets (and slots) - 1
+    const int32_t *displacement;       ///< per bucket: 0 empty, -(slot + 1) or the seed of the second hash
+    const static_option_slot_t *slots; ///< perfect hash table
+    void *values;                      ///< values of the options, a struct generated by CMD_LINE_STATIC_OPTIONS
+    const void *defaults;              ///< default values, same layout as values
+    uint8_t *is_set;                   ///< was each option set
+    StaticOptionTable *next;           ///< next table added to CmdLineOptions
+};
+
+/**
+ * @brief
+ *   an option in a StaticOptionTable
+ */
+typedef struct
+{
+    StaticOptionTable *table; ///< table
+    uint32_t index;           ///< index of the option in the table
+} static_option_ref_t;
+
+/**
+ * @brief
+ *   memory used by the options and the registry, from CmdLineOptions::MemoryUsage()
+ */
+typedef struct
+{
+    size_t registry;     ///< the registry's own tables, RegistryBytes()
+    size_t options;      ///< held by the options, e.g. list values and enum tables
+    size_t unused;       ///< the part of options that is allocated but not in use
+    size_t parse_memory; ///< the parse arena (ParseString() tokens), until the next Reset()
+    size_t string_pool;  ///< the StringPool's strings and table, if there is one
+    size_t total;        ///< all of the above (unused is part of options)
+} memory_usage_t;
+
+/**
+ * @brief
+ *   pool of interned strings,... each distinct string is kept once, so equal strings get the same pointer.
+ *
+ *   after CmdLineOptions::SetStringPool(), StringOption and StringListOption values are interned: comparing two
+ *   values is a pointer compare, and they stay valid after the argv (or ParseString() line) they came from is gone.
+ *   the pool only grows with the number of distinct strings.  defaults aren't interned.
+ *
+ *   a string that's already in the pool is found under a shared lock, so any number of threads can intern at once.
+ *   Release() frees every string in one go,... only once nothing uses them (e.g. right after a Reset()).
+ */
+class StringPool
+{
+  public:
+    StringPool(std::pmr::memory_resource *upstream = NULL);
+    const char *Intern(const char *s);
+    const char *Find(const char *s);
+    void Release();
+    size_t Count();
+    size_t Bytes();
+
+  private:
+    const char *Lookup(const char *s, uint32_t length, uint32_t hash);
+    void Grow();
+
+    std::shared_mutex mutex_;                   ///< shared to look strings up, exclusive to add them or release
+    std::pmr::monotonic_buffer_resource arena_; ///< the strings
+    std::vector<const char *> table_;           ///< open addressing hash table of the strings, NULL is empty
+    std::vector<uint32_t> hashes_;              ///< hash of each table_ entry
+    size_t count_;                              ///< number of strings
+    size_t bytes_;                              ///< bytes of the strings (with their 0's)
+};
+
+class CountingResource;
+
 /**
  * @brief
  *   singleton integer range command line option
@@ -263,6 +934,7 @@ class OptionGroup : public CmdLineOption
 class CmdLineOptions
 {
   public:
+    CmdLineOptions();
     ~CmdLineOptions();
     /// singleton
     static CmdLineOptions *GetInstance();
@@ -271,17 +943,235 @@ class CmdLineOptions
     void Usage();
     void ShowUsage(std::ostream &error_message);
     void Reset();
+    void ResetTouched();
+    void Prepare();
     static void ParseOptions(int argc, const char **argv);
     bool ParseOptionsOrError(int argc, const char **argv, std::ostream &error_message);
+    bool TryParseOptions(int argc, const char **argv, parse_error_t *error);
+    void RenderError(const parse_error_t &error, const char **argv, std::ostream &error_message);
     void ParseString(const char *argv_string);
+    void SetMemoryResource(std::pmr::memory_resource *resource);
+    std::pmr::memory_resource *ParseMemory();
     bool MatchesAnOption(const char *s);
+    CmdLineOption *FindOption(const char *name);
+    CmdLineOption *FindOption(const char *name, const Subcommand *subcommand);
+    void AddStaticOptions(StaticOptionTable *table);
+    bool FindStaticOption(const char *name, static_option_ref_t *ref);
+    bool SetStaticOption(const static_option_ref_t &ref, const char *s);
+    void SetOption(CmdLineOption *option);
+    void Touch(CmdLineOption *option);
+    void ResetOption(CmdLineOption *option);
+    void ResetStaticOption(const static_option_ref_t &ref);
+    void SelectSubcommand(Subcommand *subcommand);
+    /// subcommand on the command line, or NULL
+    Subcommand *SelectedSubcommand()
+    {
+        return _selected;
+    }
+    bool IsActive(const CmdLineOption *option);
+    bool EnvironmentDue(const CmdLineOption *option);
+    void DeferEnvironment(const std::vector<CmdLineOption *> &options);
+    bool HoldEnvironmentMessage(const CmdLineOption *option);
+    void RenameOption(CmdLineOption *option, const char *name);
+    size_t NamespaceOptions(const char *pattern, std::vector<CmdLineOption *> &options);
+    void ShowNamespaceUsage(const char *pattern, std::ostream &out);
+    void ResetNamespace(const char *pattern);
+    size_t RegistryBytes();
+    void MemoryUsage(memory_usage_t *usage);
+    void MemoryReport(std::ostream &out, size_t unused_threshold = 4096);
+    void SetStringPool(StringPool *pool);
+    /// pool that string option values are interned in, or NULL
+    StringPool *GetStringPool()
+    {
+        return _string_pool;
+    }
+    void AddConstraint(OptionConstraint *constraint);
+    bool CheckConstraints(std::ostream &error_message);
+    int32_t FirstBrokenConstraint();
+    void AddObserver(OptionObserver *observer);
+    void RemoveObserver(OptionObserver *observer);
+    void NotifyObservers();
+    void Complete(const char *partial, std::ostream &out);
+    void CompletionScript(const char *program, const char *shell, std::ostream &out);
+    /// number of options (including OptionGroup's)
+    size_t OptionCount()
+    {
+        return _option_list.size();
+    }
+    /// get an option by index
+    CmdLineOption *GetOption(size_t i)
+    {
+        return _option_list[i];
+    }
 
   private:
     void ParseOptionsInternal(int argc, const char **argv);
+    void AddSectionTables();
+    CmdLineOption *FindOption(const char *name, uint32_t length, uint64_t hash);
+    CmdLineOption *FindInTable(const std::vector<uint32_t> &table, const char *name, uint32_t length, uint32_t hash);
+    void InsertInTable(std::vector<uint32_t> &table, uint32_t i);
+    void BuildSubcommandTable(Subcommand *subcommand);
+    void BuildLookupTables();
+    void SortOptions();
+    void BuildNamespaceNode(uint32_t node);
+    bool FindNamespace(const char *pattern, uint32_t *first, uint32_t *end);
+    size_t UsageLines(std::vector<CmdLineOption *> &lines);
+    bool FindStaticOption(const char *name, uint32_t length, uint64_t hash, static_option_ref_t *ref);
+    void ShowStaticError(const char *arg, uint32_t offset, std::ostream &error_message);
+    bool ConstraintBroken(size_t c, uint32_t *num_set);
+    void SyncRegistry();
+    void CompileConstraints();
+    bool ParseArguments(int argc, const char **argv, parse_error_t *error);
+    void LinkObservers();
+    void MarkChanged(uint32_t index);
+
+    /**
+     * @brief
+     *   node of the namespace trie,... each namespace is a range of _sorted_index, since names that start with
+     *   "dma." sort together.  a namespace with no options of its own and only one namespace in it is merged with
+     *   that one, so "hw.dma" is a single node if there's nothing else in "hw".
+     */
+    typedef struct
+    {
+        uint32_t option;        ///< _option_list index of an option in the namespace, its name spells the prefix
+        uint32_t prefix_length; ///< length of the namespace name, e.g. 6 for "hw.dma", 0 for the root
+        uint32_t first;         ///< first _sorted_index entry in the namespace
+        uint32_t end;           ///< end of the namespace in _sorted_index
+        uint32_t first_child;   ///< index in _namespace_nodes of the first child, the children are consecutive
+        uint32_t num_children;  ///< number of namespaces directly in this one
+    } namespace_node_t;
+
+    std::pmr::memory_resource *_upstream_resource;  ///< where _arena gets its memory, NULL for the default resource
+    std::pmr::monotonic_buffer_resource *_arena;    ///< strings created by ParseString, released by Reset()
+    CountingResource *_arena_upstream;              ///< between _arena and its upstream, counts what _arena holds
+    StringPool *_string_pool;                       ///< where string values are interned, NULL to keep the argv's
+    std::vector<CmdLineOption *> _option_list;      ///< list of valid command line options
+    std::vector<uint32_t> _sorted_index;            ///< _option_list indexes sorted by name (for Complete)
+    std::vector<namespace_node_t> _namespace_nodes; ///< namespace trie over _sorted_index, [0] is the root
+    StaticOptionTable *_static_tables;              ///< tables added with AddStaticOptions(), looked up first
+    std::vector<static_option_ref_t> _static_set;   ///< static options set since the last Reset()
+
+    // the registry keeps its own compact copy of what lookups need, indexed the same as _option_list,
+    // so finding an option doesn't chase pointers to option objects scattered through every .data section.
+    std::vector<uint32_t> _name_hash;   ///< hash of each option name
+    std::vector<uint16_t> _name_length; ///< length of each option name
+    std::vector<uint64_t> _is_set_bits; ///< CmdLineOption::is_set of each option, one bit per option
+    std::vector<uint32_t> _hash_table;  ///< open addressing hash table of (index + 1) of the global options
+    size_t _synced_count;               ///< number of options the lookup tables know about
+
+    // subcommands split the options,... 0 is global, n is _subcommands[n - 1]
+    std::vector<Subcommand *> _subcommands;  ///< subcommands, in the order they were registered
+    std::vector<uint16_t> _option_subcommand; ///< subcommand each option belongs to
+    Subcommand *_selected;                    ///< subcommand on the command line, or NULL
+
+    // options read their environment variable when they're constructed, except the options of a subcommand,
+    // which wait until it's selected (see EnvironmentDue())
+    std::vector<uint8_t> _env_checked;         ///< 1 once the environment has been checked, 2 if it set the option
+    std::vector<CmdLineOption *> _env_waiting; ///< subcommand options that haven't been constructed yet
+
+    // ResetTouched() only resets the options touched since the last reset,... an option is on the _touched list
+    // if its stamp matches the current epoch, so a reset is just clearing the list and bumping the epoch.
+    std::vector<uint32_t> _touched_epoch; ///< epoch in which each option was last touched
+    std::vector<uint32_t> _touched;       ///< indexes of the options touched in this epoch
+    uint32_t _epoch;                      ///< current epoch, starts at 1 (0 is never current)
+
+    // constraints are compiled into masks over _is_set_bits,... each term is one word of a mask.
+    std::vector<OptionConstraint *> _constraints; ///< list of constraints
+    std::vector<uint32_t> _constraint_first_term; ///< first term of each constraint (plus one extra at the end)
+    std::vector<uint32_t> _constraint_trigger;    ///< index of the option that triggers a requires constraint
+    std::vector<uint32_t> _constraint_size;       ///< number of options in the mask of each constraint
+    std::vector<uint32_t> _term_word;             ///< index into _is_set_bits of each term
+    std::vector<uint64_t> _term_bits;             ///< mask bits of each term
+    size_t _compiled_constraints;                 ///< number of constraints that have been compiled
+
+    // SetOption() stamps the options it sets while there are observers,... NotifyObservers() hands them out
+    // through a list of observers per option (observers of option i are _observer_list[_observer_first[i] ..]).
+    std::vector<OptionObserver *> _observers;    ///< observers, in the order they were added
+    std::vector<uint32_t> _observer_first;       ///< first _observer_list entry of each option (plus one at the end)
+    std::vector<OptionObserver *> _observer_list; ///< observers of each option
+    std::vector<uint32_t> _changed_batch;        ///< batch in which each option was last set
+    std::vector<uint32_t> _changed;              ///< indexes of the options set in this batch
+    uint32_t _batch;                             ///< current batch, starts at 1 (0 is never current)
+};
+
+/**
+ * @brief
+ *   incremental (push style) command line parser.
+ *
+ *   tokens are fed one at a time with Feed(),... a list option stays pending until
+ *   a token ends the list, or until Flush() or Finish() is called.
+ *
+ *   tokens are not copied, so like argv they must stay valid while the option values are used.
+ */
+class CmdLineOptionParser
+{
+  public:
+    CmdLineOptionParser(std::ostream &error_message);
+    virtual ~CmdLineOptionParser(){};
+    bool Feed(const char *s);
+    bool Flush();
+    bool Finish();
+    virtual void OptionParsed(CmdLineOption *option);
+    CmdLineOption *pending_list; ///< list option still accepting items, or NULL
+    bool error;                  ///< an error was found since the last Finish()
 
-    std::vector<const char *> _tokens_allocated_by_ParseString; ///< extra strings created by ParseString
-    std::vector<CmdLineOption *> _option_list;                  ///< list of valid command line options
+  private:
+    bool StartOption(const char *s);
+    void OptionDone(CmdLineOption *option);
+    std::ostream &error_message_; ///< where error messages are written
+};
+
+/**
+ * @brief
+ *   parser for a stream of whole command lines that applies only what changed from the previous line.
+ *
+ *   Parse() remembers the arguments of each option on the line.  on the next line, options that are gone
+ *   go back to their defaults, new and changed options are parsed and set, and options given exactly as before
+ *   aren't touched at all,... their OptionSet() doesn't run again and observers don't hear about them.
+ *   the result is the same as Reset() and TryParseOptions() on every line.
+ *
+ *   the arguments are copied, so unlike argv they don't need to stay valid after Parse() returns.
+ *   options changed some other way (or a Reset()) between lines need a Forget(), so the next line is applied in full.
+ */
+class CmdLineDiffParser
+{
+  public:
+    CmdLineDiffParser();
+    bool Parse(int argc, const char **argv, parse_error_t *error);
+    void Forget();
+    uint32_t changed; ///< number of options the last Parse() set or reset (arguments, if it parsed in full)
+
+  private:
+    /// the arguments of one option on a line
+    typedef struct
+    {
+        CmdLineOption *option;   ///< option, NULL for an option of a static table
+        static_option_ref_t ref; ///< option of a static table
+        std::vector<char> args;  ///< arguments, each one a '\1' (option) or '\2' (list item), the text and a 0
+    } line_option_t;
+
+    bool GroupLine(int argc, const char **argv, parse_error_t *error, bool *subcommand);
+    line_option_t *AddEntry(CmdLineOption *option, const static_option_ref_t &ref);
+    line_option_t *FindStatic(std::vector<line_option_t> &entries, size_t count, const static_option_ref_t &ref);
+    void Restore(const line_option_t &entry);
+    bool Apply(const line_option_t &entry);
+    void ClearCurrent();
+    void ParseInFull(int argc, const char **argv, parse_error_t *error);
+
+    // the entries past the counts are kept for their buffers,... a line reuses them instead of allocating
+    std::vector<line_option_t> previous_; ///< options of the previous line
+    std::vector<line_option_t> current_;  ///< options of the line being parsed
+    size_t num_previous_;                 ///< number of entries in previous_
+    size_t num_current_;                  ///< number of entries in current_
+    std::vector<uint32_t> previous_slot_; ///< per option index, position in previous_ + 1, 0 if it isn't there
+    std::vector<uint32_t> current_slot_;  ///< per option index, position in current_ + 1, 0 if it isn't there
+    bool reset_needed_;                   ///< the options don't match previous_, reset them before the next line
+    std::vector<char> full_line_;         ///< copy of the arguments of a line ParseInFull() parsed
+    std::vector<const char *> full_argv_; ///< the arguments in full_line_
 };
 
 int32_t parse_int(const char *s, char **temp);
 uint32_t parse_uint(const char *s, char **temp);
+const char *split_option_token(const char *s, char *token, size_t token_size);
+
+#endif // CMD_LINE_OPTIONS_H
@@ -0,0 +1,157 @@
+/*  COPYRIGHT (C) 2022 Microchip with MIT license */
+
+/**
+ * @file
+ * @brief
+ *   This file reads command line options from C (or through a foreign function interface).
+ *
+ *   an option is looked up by name once, and the handle points straight at its value, so reading the value
+ *   afterwards is just a load:
+ *
+ *     static cmdopt_handle_t num_channels;
+ *
+ *     cmd_line_options_parse_options(argc, argv);
+ *     num_channels = cmdopt_find("num_channels", CMDOPT_TYPE_UINT);
+ *     ...
+ *     for (uint32_t i = 0; i < cmdopt_get_u32(num_channels); i++)
+ *
+ *   the getters read the value with a relaxed atomic load (a plain load on x86 and arm), so they're safe while a
+ *   CmdLineOptionsControl 'set' changes it.
+ *
+ *   handles stay valid for the life of the program, and are the same every time an option is looked up.
+ *   list values aren't copied,... cmdopt_get_xxx_list() returns a pointer into the list, which is valid
+ *   until the options are parsed or reset again.  the exception is an int or string list with a file
+ *   ('name:=@file'),... its values are copied into one array by the first call.
+ *
+ *   other languages can't call the inline getters, but they can use cmdopt_value() once and read the value
+ *   through the address it returns (e.g. ctypes.c_uint32.from_address() in Python).
+ */
+
+#ifndef CMD_LINE_OPTIONS_C_H
+#define CMD_LINE_OPTIONS_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ *   option types, the same values as cmd_line_option_type_t
+ */
+typedef enum
+{
+    CMDOPT_TYPE_ANY = -1,    /**< don't check the type */
+    CMDOPT_TYPE_OTHER = 0,   /**< user defined option */
+    CMDOPT_TYPE_GROUP,       /**< OptionGroup */
+    CMDOPT_TYPE_BOOL,        /**< BoolOption, read with cmdopt_get_bool() */
+    CMDOPT_TYPE_ENUM,        /**< EnumOption, read with cmdopt_get_u32() */
+    CMDOPT_TYPE_INT,         /**< IntOption, read with cmdopt_get_i32() */
+    CMDOPT_TYPE_UINT,        /**< UintOption, read with cmdopt_get_u32() */
+    CMDOPT_TYPE_INT64,       /**< Int64Option, read with cmdopt_get_i64() */
+    CMDOPT_TYPE_UINT64,      /**< Uint64Option, read with cmdopt_get_u64() */
+    CMDOPT_TYPE_INT_RANGE,   /**< IntRangeOption, read with cmdopt_get_range() */
+    CMDOPT_TYPE_INT_LIST,    /**< IntListOption, read with cmdopt_get_i32_list() */
+    CMDOPT_TYPE_INT64_LIST,  /**< Int64ListOption, read with cmdopt_get_i64_list() */
+    CMDOPT_TYPE_UINT64_LIST, /**< Uint64ListOption, read with cmdopt_get_u64_list() */
+    CMDOPT_TYPE_DOUBLE_LIST, /**< DoubleListOption, read with cmdopt_get_double_list() */
+    CMDOPT_TYPE_STRING_LIST, /**< StringListOption, read with cmdopt_get_string_list() */
+    CMDOPT_TYPE_DOUBLE,      /**< DoubleOption, read with cmdopt_get_double() */
+    CMDOPT_TYPE_STRING,      /**< StringOption, read with cmdopt_get_string() */
+    CMDOPT_TYPE_ADDR_MASK,   /**< AddrMaskOption */
+    CMDOPT_TYPE_SUBCOMMAND,  /**< Subcommand, read with cmdopt_is_set() */
+    CMDOPT_TYPE_CPU_SET,     /**< CpuSetOption, read with cmdopt_get_u32_list() */
+} cmdopt_type_t;
+
+/**
+ * @brief
+ *   what a handle points at,... the layout is part of the ABI, so FFI code can read it too.
+ */
+typedef struct cmdopt_option_s
+{
+    const void *value;     /**< the option's value, NULL for lists and user defined options */
+    const void *range_end; /**< end of an int range option, NULL for other options */
+    const uint8_t *set;    /**< the option's is_set flag (a C++ bool) */
+    const char *name;      /**< option name */
+    int32_t type;          /**< cmdopt_type_t */
+    uint32_t index;        /**< position of the option in the registry */
+    void *option;          /**< the CmdLineOption */
+} cmdopt_option_t;
+
+/** handle of an option */
+typedef const cmdopt_option_t *cmdopt_handle_t;
+
+void cmd_line_options_parse_options(int argc, const char **argv);
+cmdopt_handle_t cmdopt_find(const char *name, cmdopt_type_t type);
+const void *cmdopt_value(cmdopt_handle_t handle);
+size_t cmdopt_get_i32_list(cmdopt_handle_t handle, const int32_t **values);
+size_t cmdopt_get_u32_list(cmdopt_handle_t handle, const uint32_t **values);
+size_t cmdopt_get_i64_list(cmdopt_handle_t handle, const int64_t **values);
+size_t cmdopt_get_u64_list(cmdopt_handle_t handle, const uint64_t **values);
+size_t cmdopt_get_double_list(cmdopt_handle_t handle, const double **values);
+size_t cmdopt_get_string_list(cmdopt_handle_t handle, const char *const **values);
+
+/** was the option set (on the command line, by the environment, ...) */
+static inline int cmdopt_is_set(cmdopt_handle_t handle)
+{
+    return __atomic_load_n(handle->set, __ATOMIC_RELAXED) != 0;
+}
+
+/** value of a bool option */
+static inline int cmdopt_get_bool(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const uint8_t *)handle->value, __ATOMIC_RELAXED) != 0;
+}
+
+/** value of an int option */
+static inline int32_t cmdopt_get_i32(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const int32_t *)handle->value, __ATOMIC_RELAXED);
+}
+
+/** value of a uint or enum option */
+static inline uint32_t cmdopt_get_u32(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const uint32_t *)handle->value, __ATOMIC_RELAXED);
+}
+
+/** value of an int64 option */
+static inline int64_t cmdopt_get_i64(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const int64_t *)handle->value, __ATOMIC_RELAXED);
+}
+
+/** value of a uint64 option */
+static inline uint64_t cmdopt_get_u64(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const uint64_t *)handle->value, __ATOMIC_RELAXED);
+}
+
+/** value of a double option */
+static inline double cmdopt_get_double(cmdopt_handle_t handle)
+{
+    double value;
+    __atomic_load((const double *)handle->value, &value, __ATOMIC_RELAXED);
+    return value;
+}
+
+/** value of a string option */
+static inline const char *cmdopt_get_string(cmdopt_handle_t handle)
+{
+    return __atomic_load_n((const char *const *)handle->value, __ATOMIC_RELAXED);
+}
+
+/** value of an int range option */
+static inline void cmdopt_get_range(cmdopt_handle_t handle, int32_t *start, int32_t *end)
+{
+    *start = __atomic_load_n((const int32_t *)handle->value, __ATOMIC_RELAXED);
+    *end = __atomic_load_n((const int32_t *)handle->range_end, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMD_LINE_OPTIONS_C_H */
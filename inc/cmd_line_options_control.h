@@ -0,0 +1,88 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ *   This file lets a running process query and change its command line options over a UNIX domain socket.
+ */
+
+#ifndef CMD_LINE_OPTIONS_CONTROL_H
+#define CMD_LINE_OPTIONS_CONTROL_H
+
+#include "cmd_line_options.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief
+ *   control plane for changing command line options in a running process.
+ *
+ *   a background thread listens on a UNIX domain socket,... each line received is one command:
+ *
+ *     set name=value [name=value ...]   - change one or more options (all or nothing)
+ *     get name [name ...]               - show option values
+ *     dump [namespace.*]                - show all option values, or the ones in a namespace
+ *
+ *   the reply ends with "ok" or "error: <message>".
+ *
+ *   readers never lock,... but while the control plane is running, a value 'set' can change must be read with
+ *   Load(), one relaxed atomic load (the same instruction as a plain load on x86 and arm), since the listener
+ *   thread stores the new values atomically. a reader that needs a consistent view of several options can use
+ *   ReadBegin() and ReadRetry():
+ *
+ *     do {
+ *         seq = control.ReadBegin();
+ *         a = CmdLineOptionsControl::Load(option_a.value);
+ *         b = CmdLineOptionsControl::Load(option_b.value);
+ *     } while (control.ReadRetry(seq));
+ *
+ *   only bool, enum, int, uint, int64, uint64, double, string and int range options can be changed.  string
+ *   values are interned in a pool that lives as long as this object, so a string read from an option stays valid
+ *   however often it's changed (the pool only grows with the number of distinct values).  list options can't be
+ *   changed while readers may be walking the vectors, so 'set' refuses them.
+ *
+ *   the listener thread only stores the values,... the registry's own bookkeeping (is_set, what the next Reset()
+ *   resets) belongs to the thread that parses.  that thread calls Apply() now and then (e.g. once per main loop),
+ *   which marks the options 'set' changed since the last call as set, and notifies their observers from there.
+ */
+class CmdLineOptionsControl
+{
+  public:
+    CmdLineOptionsControl();
+    ~CmdLineOptionsControl();
+    bool Start(const char *socket_path);
+    void Stop();
+    bool Command(const char *command, std::ostream &reply);
+    size_t Apply();
+    static bool Send(const char *socket_path, const char *command, std::ostream &reply);
+    uint32_t ReadBegin();
+    bool ReadRetry(uint32_t sequence);
+
+    /// read a value that 'set' may be changing
+    template <typename T>
+    static T Load(const T &value)
+    {
+        T result;
+        __atomic_load(&value, &result, __ATOMIC_RELAXED);
+        return result;
+    }
+
+  private:
+    bool Set(char *args, std::ostream &reply);
+    bool Get(char *args, std::ostream &reply);
+    bool Dump(char *args, std::ostream &reply);
+    void Listen();
+    void Serve(int fd);
+
+    int listen_fd_;                        ///< listening socket, or -1
+    int wake_pipe_[2];                     ///< written by Stop() to wake up the listener thread
+    std::thread thread_;                   ///< listener thread
+    std::mutex write_mutex_;               ///< serializes writers, and protects applied_
+    std::atomic<uint32_t> sequence_;       ///< odd while an update is in progress
+    StringPool strings_;                   ///< string values set by 'set'
+    std::vector<CmdLineOption *> applied_; ///< options 'set' changed since the last Apply()
+    char socket_path_[108];                ///< socket path, removed by Stop()
+};
+
+#endif // CMD_LINE_OPTIONS_CONTROL_H
@@ -0,0 +1,136 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ *   This file keeps copies of a few option values where many threads can read them without cache line sharing.
+ */
+
+#ifndef CMD_LINE_OPTIONS_HOT_H
+#define CMD_LINE_OPTIONS_HOT_H
+
+#include "cmd_line_options.h"
+#include <string.h>
+
+/**
+ * @brief
+ *   how many copies of the values to keep
+ */
+typedef enum
+{
+    HOT_REPLICA_ONE,      ///< one copy for every thread
+    HOT_REPLICA_PER_NODE, ///< one copy per NUMA node, in that node's memory
+    HOT_REPLICA_PER_CPU,  ///< one copy per CPU
+} hot_replica_t;
+
+/**
+ * @brief
+ *   CPU the calling thread first asked about, -1 until then
+ */
+inline int32_t &hot_options_thread_cpu()
+{
+    static thread_local int32_t cpu = -1;
+    return cpu;
+}
+
+/**
+ * @brief
+ *   what a reader needs to find its copy of a value,... written once by Load(), then only read
+ *
+ *   it's on a cache line of its own, so the observer state next to it (written by every notification and by
+ *   threads waiting for one) doesn't take the line away from the readers.
+ */
+typedef struct alignas(64)
+{
+    std::atomic<uint64_t> *values; ///< the copies, each on its own cache lines (pages, per node)
+    const uint16_t *cpu_replica;   ///< copy read by each CPU, in the same mapping as the values
+    uint32_t num_cpus;             ///< number of entries in cpu_replica
+    uint32_t stride;               ///< values from one copy to the next
+} hot_descriptor_t;
+
+/**
+ * @brief
+ *   read-mostly copies of some option values, for threads that read them on hot paths
+ *
+ *   the option objects are in .data next to whatever else the linker put there, so a write to a neighbouring
+ *   variable takes the cache line away from every thread reading an option.  HotOptions copies the values
+ *   into its own cache line aligned pages, where nothing else is written, and can keep a copy per NUMA node
+ *   (or per CPU) so readers on different sockets don't share lines at all:
+ *
+ *     static HotOptions hot({&option_rate, &option_burst});
+ *     enum { HOT_RATE, HOT_BURST };        // slots, in the order of the options
+ *
+ *     CmdLineOptions::ParseOptions(argc, argv);
+ *     hot.Load();                          // before the readers start
+ *     ...
+ *     uint64_t rate = hot.Uint(HOT_RATE);  // in the readers
+ *
+ *   it's an observer, so a parse, ParseString(), a control plane "set" or a Reset() (or ResetTouched(),
+ *   ResetNamespace(), or a CmdLineDiffParser putting an option back) that changes a hot option writes the
+ *   new value into every copy.  each value is read and written as one 64 bit word, so a reader sees the old
+ *   or the new value, but two values may come from different updates.  code that changes the option
+ *   objects directly calls Load() again.
+ *
+ *   bool, int, uint, int64, uint64, double and enum options can be hot.  a thread reads the copy of the CPU it
+ *   first read on, so readers should be pinned to a CPU (or at least a node).
+ */
+class HotOptions : public OptionObserver
+{
+  public:
+    HotOptions(std::initializer_list<CmdLineOption *> _options, hot_replica_t _policy = HOT_REPLICA_PER_NODE);
+    ~HotOptions();
+    void Load();
+    void OptionsChanged(const std::vector<CmdLineOption *> &changed) override;
+    /// number of copies of the values
+    uint32_t NumReplicas() const
+    {
+        return num_replicas_;
+    }
+    /// the 64 bits of a value (slot is the option's position in the list), from this thread's copy
+    uint64_t Raw(uint32_t slot) const
+    {
+        int32_t &cpu = hot_options_thread_cpu();
+        if (cpu < 0)
+        {
+            cpu = CurrentCpu();
+        }
+        uint32_t replica = ((uint32_t)cpu < hot_.num_cpus) ? hot_.cpu_replica[cpu] : 0;
+        return hot_.values[replica * hot_.stride + slot].load(std::memory_order_relaxed);
+    }
+    /// value of a bool option
+    bool Bool(uint32_t slot) const
+    {
+        return Raw(slot) != 0;
+    }
+    /// value of an int or int64 option
+    int64_t Int(uint32_t slot) const
+    {
+        return (int64_t)Raw(slot);
+    }
+    /// value of a uint, uint64 or enum option
+    uint64_t Uint(uint32_t slot) const
+    {
+        return Raw(slot);
+    }
+    /// value of a double option
+    double Double(uint32_t slot) const
+    {
+        uint64_t bits = Raw(slot);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+  private:
+    static int32_t CurrentCpu();
+    static uint64_t ValueBits(const CmdLineOption *option);
+    void Allocate();
+    void Store(uint32_t slot);
+
+    hot_replica_t policy_;  ///< how many copies to keep
+    size_t mapped_bytes_;   ///< size of the mapping holding the copies and the CPU table
+    uint32_t num_replicas_; ///< number of copies, 0 until Load()
+    hot_descriptor_t hot_;  ///< what Raw() reads, nothing else is on its cache line
+};
+
+#endif // CMD_LINE_OPTIONS_HOT_H
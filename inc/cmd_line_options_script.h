@@ -0,0 +1,133 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ *   This file parses big option scripts (one command line per line) on a pool of threads.
+ */
+
+#ifndef CMD_LINE_OPTIONS_SCRIPT_H
+#define CMD_LINE_OPTIONS_SCRIPT_H
+
+#include "cmd_line_options.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief
+ *   one line of a script, as the callback sees it
+ */
+class ScriptLine
+{
+  public:
+    uint64_t number;     ///< line number, the first line is 1
+    int argc;            ///< number of arguments
+    const char **argv;   ///< arguments, valid until the callback returns
+    parse_error_t error; ///< what's wrong with the line, error.code is PARSE_ERROR_NONE if nothing
+};
+
+/**
+ * @brief
+ *   what the worker threads know about an option,... copied from the registry before they start,
+ *   so nothing the calling thread does to the registry while the script runs is seen by them.
+ */
+typedef struct
+{
+    CmdLineOption *option;    ///< the option, the workers only call its CheckValue() and CheckFile()
+    const char *name;         ///< its name
+    uint32_t hash;            ///< low 32 bits of option_name_hash() of the name
+    uint32_t owner;           ///< 0 for a global option, else the subcommand (numbered from 1) it belongs to
+    uint32_t subcommand;      ///< n (from 1) if the option is a subcommand, 0 if not
+    bool is_list;             ///< CmdLineOption::is_list
+    bool is_option_free_list; ///< CmdLineOption::is_option_free_list
+} script_option_t;
+
+/**
+ * @brief
+ *   one option of a good line, as a worker resolved it,... the calling thread only has to parse the value into it.
+ */
+typedef struct
+{
+    CmdLineOption *option;   ///< the option, NULL for an option of a static table
+    static_option_ref_t ref; ///< option of a static table
+    const char *value;       ///< the value, after the name and '='
+    uint32_t arg;            ///< index of the option's argument on the line
+    uint32_t num_items;      ///< number of list items in the arguments after it
+} script_step_t;
+
+/**
+ * @brief
+ *   function called for every line of a script, in order,... return false to stop.
+ */
+typedef bool (*script_callback_t)(const ScriptLine &line, void *arg);
+
+/**
+ * @brief
+ *   run a script file, one command line per line, like calling ParseString() for each line
+ *
+ *   the file is mapped, and split into chunks that end at a line boundary.  worker threads copy each chunk,
+ *   split it into arguments, look up the options and check the values (without changing any option),
+ *   then the calling thread takes the chunks in order and, for each good line, just parses the values into the
+ *   options the workers found (script_step_t).  the workers look options up in a copy of the registry's
+ *   names taken before they start, never in the registry itself, so the calling thread can change the registry
+ *   (reset, parse, select subcommands) while they run.  options registered, renamed or given new static tables
+ *   during a run aren't seen until the next one, and a user defined option's CheckValue() must not read anything
+ *   its ParseValue() writes.  Run() resets the options before each line and calls the callback after it,... with
+ *   ResetTouched(), so a callback that changes options directly calls Touch() on them.
+ *   Check() just reports the bad lines, so checking a script costs about as much as reading it.
+ *
+ *   only a few chunks per worker are parsed ahead of the calling thread, so memory doesn't grow with the
+ *   size of the script, and pages of the file that have been used are dropped.
+ *
+ *     CmdLineOptionsScript script;
+ *     if (script.Open("scenario.txt"))
+ *         script.Run(run_test, NULL);
+ *
+ *   with incremental set, Run() parses the lines with a CmdLineDiffParser instead,... options that are the same
+ *   as on the line before aren't touched, and a bad line leaves the options as the line before left them.
+ *
+ *   empty lines are skipped.  constraints and user defined options (whose CheckValue() accepts anything)
+ *   are only checked when a line is parsed into the options, so Check() doesn't see those errors.
+ */
+class CmdLineOptionsScript
+{
+  public:
+    CmdLineOptionsScript();
+    ~CmdLineOptionsScript();
+    bool Open(const char *path);
+    void Close();
+    bool Run(script_callback_t callback, void *arg, uint32_t num_threads = 0);
+    uint64_t Check(std::ostream &errors, uint32_t num_threads = 0);
+    size_t chunk_size;          ///< bytes per chunk (a chunk is made longer to end at a line)
+    uint32_t chunks_per_thread; ///< chunks each worker can get ahead of the calling thread
+    bool incremental;           ///< Run() applies only what changed from one line to the next
+
+  private:
+    bool Process(script_callback_t callback, void *arg, uint32_t num_threads, bool check_only);
+    void Worker();
+    void ParseChunk(void *chunk);
+    bool CheckLine(int argc, const char **argv, parse_error_t *error, std::vector<script_step_t> *steps);
+    bool ApplyLine(const script_step_t *steps, uint32_t num_steps, const char **argv, parse_error_t *error);
+    bool MatchesAnOption(const char *s, uint32_t subcommand);
+    void Freeze();
+    const script_option_t *Lookup(const char *name, uint32_t subcommand);
+
+    int fd_;                               ///< script file, or -1
+    const char *data_;                     ///< the mapped file
+    size_t size_;                          ///< size of the file
+    std::mutex mutex_;                     ///< protects everything below
+    std::condition_variable chunk_done_;   ///< signaled when a worker finishes a chunk
+    std::condition_variable slot_free_;    ///< signaled when the calling thread is done with a chunk
+    void *chunks_;                         ///< ring of chunks being parsed (while Process() is running)
+    uint32_t num_slots_;                   ///< size of the ring
+    const char *next_start_;               ///< where the next chunk starts
+    uint64_t next_chunk_;                  ///< number of the next chunk to hand out
+    uint64_t consumed_;                    ///< number of chunks the calling thread is done with
+    bool stop_;                            ///< the workers should stop, the calling thread is done
+    CmdLineDiffParser diff_;               ///< parses the lines when incremental is set
+    std::vector<script_option_t> options_; ///< the registered options, as of the start of the run
+    std::vector<uint32_t> table_;          ///< open addressing hash table of (index + 1) of options_
+};
+
+#endif // CMD_LINE_OPTIONS_SCRIPT_H
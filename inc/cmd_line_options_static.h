@@ -0,0 +1,316 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ *   This file declares command line options at compile time.
+ *
+ *   a module lists its options once, with an X macro,
+ *   and CMD_LINE_STATIC_OPTIONS() turns the list into a struct of values, a table of names and a perfect hash,
+ *   all built by the compiler:
+ *
+ *     #define MY_OPTIONS(X)                                  \
+ *         X(BOOL, verbose, false, "print more")              \
+ *         X(INT, count, 1, "number of times to run")         \
+ *         X(STRING, label, "none", "label for the results")
+ *     CMD_LINE_STATIC_OPTIONS(my_options, MY_OPTIONS)
+ *
+ *     CMD_LINE_STATIC_OPTIONS_REGISTER(my_options)
+ *
+ *     CmdLineOptions::ParseOptions(argc, argv);
+ *     if (my_options.verbose) ...
+ *
+ *   the types are BOOL, INT, UINT, INT64, UINT64, DOUBLE and STRING.  every variable is constant initialized,
+ *   so a module with static options has no constructors, and no static initialization order to worry about.
+ *   without CMD_LINE_STATIC_OPTIONS_REGISTER(), add the table with CmdLineOptions::AddStaticOptions(&my_options_table).
+ *
+ *   to use the values from other files, put CMD_LINE_STATIC_OPTIONS_DECLARE() in a header,
+ *   and CMD_LINE_STATIC_OPTIONS_DEFINE() in one source file.
+ */
+
+#ifndef CMD_LINE_OPTIONS_STATIC_H
+#define CMD_LINE_OPTIONS_STATIC_H
+
+#include "cmd_line_options.h"
+#include <stddef.h>
+
+/// C type of each static option type
+typedef bool static_option_BOOL_t;
+typedef int32_t static_option_INT_t;
+typedef uint32_t static_option_UINT_t;
+typedef int64_t static_option_INT64_t;
+typedef uint64_t static_option_UINT64_t;
+typedef double static_option_DOUBLE_t;
+typedef const char *static_option_STRING_t;
+
+/**
+ * @brief
+ *   number of buckets (and slots) for a table of options, a power of 2 so the hash can be masked
+ *
+ * @param[in] count - number of options
+ *
+ * @return uint32_t - table size
+ */
+constexpr uint32_t static_option_table_size(size_t count)
+{
+    uint32_t size = 1;
+    while (size < count)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+/**
+ * @brief
+ *   perfect hash of a table of options
+ */
+template <size_t N> struct static_option_index_t
+{
+    int32_t displacement[static_option_table_size(N)];      ///< per bucket: 0 empty, -(slot + 1) or a seed
+    static_option_slot_t slots[static_option_table_size(N)]; ///< option in each slot
+};
+
+/// not constexpr,... calling it while building a table stops the compile
+inline void static_option_duplicate_name()
+{
+}
+
+/// not constexpr,... calling it while building a table stops the compile
+inline void static_option_no_perfect_hash()
+{
+}
+
+/**
+ * @brief
+ *   compare two option names
+ *
+ * @param[in] a - name
+ * @param[in] b - name
+ *
+ * @return true if the names are the same
+ */
+constexpr bool static_option_same_name(const char *a, const char *b)
+{
+    for (; *a != 0; a++, b++)
+    {
+        if (*a != *b)
+        {
+            return false;
+        }
+    }
+    return *b == 0;
+}
+
+/**
+ * @brief
+ *   build the perfect hash of a table of options (hash and displace)
+ *
+ *   names are hashed into buckets, then the buckets with more than one name, biggest first,
+ *   each search for a seed that puts all their names in free slots.  buckets with one name take
+ *   whatever slot is left, so the table can be completely full.  this runs in the compiler.
+ *
+ * @param[in] options - options
+ *
+ * @return static_option_index_t<N> - displacement of each bucket and option in each slot
+ */
+template <size_t N> constexpr static_option_index_t<N> make_static_option_index(const static_option_t (&options)[N])
+{
+    constexpr uint32_t size = static_option_table_size(N);
+    constexpr uint32_t mask = size - 1;
+    static_assert(N < UINT16_MAX, "too many static options in one table");
+    static_option_index_t<N> index = {};
+    uint64_t hash[N] = {};
+    uint32_t bucket[N] = {};
+    uint32_t bucket_first[size + 1] = {}; // names of bucket b are member[bucket_first[b] .. bucket_first[b + 1] - 1]
+    uint32_t member[N] = {};
+    uint32_t taken[N] = {}; // slots for the names of the bucket being placed
+    bool used[size] = {};
+    for (uint32_t slot = 0; slot < size; slot++)
+    {
+        index.slots[slot].option = UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < N; i++)
+    {
+        uint32_t length = 0;
+        hash[i] = option_name_hash(options[i].name, &length);
+        bucket[i] = option_hash_slot(hash[i], 0) & mask;
+        bucket_first[bucket[i] + 1]++;
+    }
+    uint32_t max_bucket_size = 0;
+    for (uint32_t b = 0; b < size; b++)
+    {
+        max_bucket_size = (bucket_first[b + 1] > max_bucket_size) ? bucket_first[b + 1] : max_bucket_size;
+        bucket_first[b + 1] += bucket_first[b];
+    }
+    uint32_t fill[size] = {};
+    for (uint32_t i = 0; i < N; i++)
+    {
+        member[bucket_first[bucket[i]] + fill[bucket[i]]++] = i;
+    }
+    for (uint32_t b = 0; b < size; b++)
+    {
+        for (uint32_t i = bucket_first[b]; i < bucket_first[b + 1]; i++)
+        {
+            for (uint32_t j = bucket_first[b]; j < i; j++)
+            {
+                if ((hash[member[j]] == hash[member[i]]) &&
+                    static_option_same_name(options[member[j]].name, options[member[i]].name))
+                {
+                    static_option_duplicate_name();
+                }
+            }
+        }
+    }
+
+    for (uint32_t n = max_bucket_size; n >= 2; n--)
+    {
+        for (uint32_t b = 0; b < size; b++)
+        {
+            if (bucket_first[b + 1] - bucket_first[b] != n)
+            {
+                continue;
+            }
+            for (int32_t seed = 1;; seed++)
+            {
+                if (seed == (1 << 20))
+                {
+                    static_option_no_perfect_hash();
+                }
+                uint32_t k = 0;
+                for (; k < n; k++)
+                {
+                    uint32_t slot = option_hash_slot(hash[member[bucket_first[b] + k]], seed) & mask;
+                    bool clash = used[slot];
+                    for (uint32_t j = 0; j < k; j++)
+                    {
+                        clash = clash || (taken[j] == slot);
+                    }
+                    if (clash)
+                    {
+                        break;
+                    }
+                    taken[k] = slot;
+                }
+                if (k < n)
+                {
+                    continue;
+                }
+                for (k = 0; k < n; k++)
+                {
+                    uint32_t i = member[bucket_first[b] + k];
+                    used[taken[k]] = true;
+                    index.slots[taken[k]].hash = (uint32_t)hash[i];
+                    index.slots[taken[k]].option = i;
+                }
+                index.displacement[b] = seed;
+                break;
+            }
+        }
+    }
+
+    uint32_t free_slot = 0;
+    for (uint32_t b = 0; b < size; b++)
+    {
+        if (bucket_first[b + 1] - bucket_first[b] != 1)
+        {
+            continue;
+        }
+        uint32_t i = member[bucket_first[b]];
+        while (used[free_slot])
+        {
+            free_slot++;
+        }
+        used[free_slot] = true;
+        index.slots[free_slot].hash = (uint32_t)hash[i];
+        index.slots[free_slot].option = i;
+        index.displacement[b] = -(int32_t)(free_slot + 1);
+    }
+    return index;
+}
+
+/// X macro helpers
+#define CMD_LINE_STATIC_OPTION_FIELD(type, name, default_value, usage_message) static_option_##type##_t name;
+#define CMD_LINE_STATIC_OPTION_INDEX(type, name, default_value, usage_message) name,
+#define CMD_LINE_STATIC_OPTION_DEFAULT(type, name, default_value, usage_message) default_value,
+#define CMD_LINE_STATIC_OPTION_ENTRY(type, name, default_value, usage_message)                                         \
+    {#name, usage_message, CMD_LINE_OPTION_##type, (uint32_t)offsetof(values_t, name)},
+
+/**
+ * @brief
+ *   declare a table of static options:
+ *     struct <table>_t                 - the values, one field per option
+ *     <table>                          - the values
+ *     <table>_index::<name>            - index of each option in the table, e.g. for <table>_table.is_set[]
+ *     <table>_table                    - the StaticOptionTable to pass to CmdLineOptions::AddStaticOptions()
+ */
+#define CMD_LINE_STATIC_OPTIONS_DECLARE(table, LIST)                                                                   \
+    struct table##_t                                                                                                   \
+    {                                                                                                                  \
+        LIST(CMD_LINE_STATIC_OPTION_FIELD)                                                                             \
+    };                                                                                                                 \
+    namespace table##_index                                                                                            \
+    {                                                                                                                  \
+    enum                                                                                                               \
+    {                                                                                                                  \
+        LIST(CMD_LINE_STATIC_OPTION_INDEX)                                                                             \
+    };                                                                                                                 \
+    }                                                                                                                  \
+    extern table##_t table;                                                                                            \
+    extern StaticOptionTable table##_table;
+
+/**
+ * @brief
+ *   define a table of static options that was declared with CMD_LINE_STATIC_OPTIONS_DECLARE()
+ */
+#define CMD_LINE_STATIC_OPTIONS_DEFINE(table, LIST)                                                                    \
+    namespace table##_static                                                                                           \
+    {                                                                                                                  \
+    typedef table##_t values_t;                                                                                        \
+    constexpr values_t defaults = {LIST(CMD_LINE_STATIC_OPTION_DEFAULT)};                                              \
+    constexpr static_option_t options[] = {LIST(CMD_LINE_STATIC_OPTION_ENTRY)};                                        \
+    constexpr size_t count = sizeof(options) / sizeof(options[0]);                                                     \
+    constexpr static_option_index_t<count> index = make_static_option_index(options);                                  \
+    uint8_t is_set[count];                                                                                             \
+    }                                                                                                                  \
+    table##_t table = table##_static::defaults;                                                                        \
+    StaticOptionTable table##_table = {#table,                                                                         \
+                                       table##_static::options,                                                        \
+                                       table##_static::count,                                                          \
+                                       static_option_table_size(table##_static::count) - 1,                            \
+                                       table##_static::index.displacement,                                             \
+                                       table##_static::index.slots,                                                    \
+                                       &table,                                                                         \
+                                       &table##_static::defaults,                                                      \
+                                       table##_static::is_set,                                                         \
+                                       NULL};
+
+/**
+ * @brief
+ *   register a table of static options without calling CmdLineOptions::AddStaticOptions()
+ *
+ *   a pointer to the table goes in the "cmd_line_options" ELF section, the linker collects them all between
+ *   __start_cmd_line_options and __stop_cmd_line_options, and the registry adds them (sorted by table name)
+ *   when it is created.  nothing runs before main() and the order doesn't depend on the link order.
+ *   elsewhere, a constructor function adds the table instead.
+ */
+#if defined(__ELF__)
+#define CMD_LINE_STATIC_OPTIONS_REGISTER(table)                                                                        \
+    __attribute__((used, section("cmd_line_options"))) StaticOptionTable *const table##_section_entry = &table##_table;
+#else
+#define CMD_LINE_STATIC_OPTIONS_REGISTER(table)                                                                        \
+    __attribute__((constructor)) static void table##_register()                                                        \
+    {                                                                                                                  \
+        CmdLineOptions::GetInstance()->AddStaticOptions(&table##_table);                                               \
+    }
+#endif
+
+/**
+ * @brief
+ *   declare and define a table of static options in one go
+ */
+#define CMD_LINE_STATIC_OPTIONS(table, LIST)                                                                           \
+    CMD_LINE_STATIC_OPTIONS_DECLARE(table, LIST)                                                                       \
+    CMD_LINE_STATIC_OPTIONS_DEFINE(table, LIST)
+
+#endif // CMD_LINE_OPTIONS_STATIC_H
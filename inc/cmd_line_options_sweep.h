@@ -0,0 +1,103 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ *   This file runs a test for every combination of some list, range and enum options, on a pool of threads.
+ */
+
+#ifndef CMD_LINE_OPTIONS_SWEEP_H
+#define CMD_LINE_OPTIONS_SWEEP_H
+
+#include "cmd_line_options.h"
+
+class CmdLineOptionsSweep;
+
+/**
+ * @brief
+ *   option values for one combination of a sweep
+ */
+class SweepContext
+{
+  public:
+    int64_t Value(const CmdLineOption *option) const;
+    uint64_t index;                   ///< combination number, 0 .. CmdLineOptionsSweep::Count() - 1
+    uint32_t thread;                  ///< worker thread running this combination
+    const int64_t *values;            ///< one value per axis, in the order the axes were added
+    const CmdLineOptionsSweep *sweep; ///< sweep this combination belongs to
+};
+
+/**
+ * @brief
+ *   function called for every combination, the return value is saved in the results.
+ */
+typedef int64_t (*sweep_callback_t)(const SweepContext &context, void *arg);
+
+/**
+ * @brief
+ *   sweep over the cartesian product of some options
+ *
+ *   each axis is an option:
+ *     IntListOption, Int64ListOption, Uint64ListOption - every value in the list
+ *     IntRangeOption                                   - every value from start_value to end_value
+ *     EnumOption                                       - the value that was set, or every enumeration if not set
+ *     BoolOption                                       - the value that was set, or false and true if not set
+ *
+ *   an axis with no values (an empty list, or a range that isn't set) isn't swept,... it's one value, 0, so the
+ *   other axes still run.
+ *
+ *   combinations are numbered like nested loops with the first axis outermost, and are decoded from their number
+ *   when they run, so the product is never built.  each worker thread starts with a contiguous block of combinations
+ *   and steals half of another worker's remaining block when it runs out, so slow combinations don't leave threads
+ *   idle.  results are stored by combination number, so they come out in the same order no matter which thread
+ *   ran what.
+ *
+ *     CmdLineOptionsSweep sweep;
+ *     sweep.AddAxis(&option_channels);
+ *     sweep.AddAxis(&option_test);
+ *     std::vector<int64_t> results;
+ *     sweep.Run(run_test, NULL, results);
+ */
+class CmdLineOptionsSweep
+{
+  public:
+    CmdLineOptionsSweep();
+    bool AddAxis(CmdLineOption *option);
+    uint64_t Count();
+    void Combination(uint64_t index, int64_t *values);
+    bool Run(sweep_callback_t callback, void *arg, std::vector<int64_t> &results, uint32_t num_threads = 0);
+    size_t AxisCount() const
+    {
+        return axes_.size();
+    }
+    CmdLineOption *GetAxis(size_t i) const
+    {
+        return axes_[i].option;
+    }
+
+  private:
+    /**
+     * @brief
+     *   values of one axis,... either a list of values or start, start + 1, ...
+     */
+    typedef struct
+    {
+        CmdLineOption *option;       ///< option the values come from
+        std::vector<int64_t> values; ///< values, empty for a range
+        int64_t start;               ///< first value of a range
+        uint64_t count;              ///< number of values
+    } sweep_axis_t;
+
+    void LoadAxes();
+    void Worker(uint32_t thread);
+    bool NextCombination(uint32_t thread, uint64_t *index);
+
+    std::vector<sweep_axis_t> axes_; ///< axes, first one is the outermost loop
+    sweep_callback_t callback_;      ///< function to call for each combination
+    void *arg_;                      ///< argument for callback_
+    int64_t *results_;               ///< result of each combination
+    void *queues_;                   ///< per thread blocks of combinations (while Run() is running)
+    uint32_t num_threads_;           ///< number of worker threads
+};
+
+#endif // CMD_LINE_OPTIONS_SWEEP_H
@@ -7,11 +7,30 @@
  */
 
 #include "cmd_line_options.h"
+#include <algorithm>
+#include <ctype.h>
+#include <fcntl.h>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
 
 /**
  * @brief
@@ -21,7 +40,8 @@
  * @param[in] _usage_message - option usage message
  */
 CmdLineOption::CmdLineOption(const char *_name, const char *_usage_message)
-    : name(_name), usage_message(_usage_message), is_set(), is_list(), is_option_free_list(), is_bool()
+    : name(_name), usage_message(_usage_message), is_set(), is_list(), is_option_free_list(), is_bool(),
+      type(CMD_LINE_OPTION_OTHER), index()
 {
     // add this option to a global list of options.
     CmdLineOptions::GetInstance()->AddOption(this);
@@ -46,6 +66,116 @@ bool CmdLineOption::ParseValueWithError(const char *s, std::ostream &error_messa
     return false;
 }
 
+/**
+ * @brief
+ *   parse a value without printing anything or exiting
+ *
+ *   this is what the parsers call,... the error message is only made if someone asks for it.
+ *   ParseValue() is quiet for most options, the ones whose ParseValue() explains errors override this.
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if argument string is valid
+ */
+bool CmdLineOption::TryParseValue(const char *s)
+{
+    return ParseValue(s);
+}
+
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *   the default can't check without parsing, so accepts everything.
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool CmdLineOption::CheckValue(const char *)
+{
+    return true;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *   the default doesn't know the value, so displays nothing.
+ *
+ * @param[out] out - output stream
+ */
+void CmdLineOption::ShowValue(std::ostream &)
+{
+}
+
+/**
+ * @brief
+ *   find the values that start with a prefix, for shell completion
+ *   the default doesn't know any values.
+ *
+ * @param[in] prefix - start of the value typed so far
+ * @param[out] matches - matching values
+ */
+void CmdLineOption::CompleteValue(const char *, std::vector<const char *> &)
+{
+}
+
+/**
+ * @brief
+ *   heap memory of a vector
+ *
+ * @param[in] v - vector
+ * @param[in,out] unused - the allocated but unused part is added to this
+ *
+ * @return size_t - bytes allocated
+ */
+template <typename T> static size_t vector_bytes(const std::vector<T> &v, size_t *unused)
+{
+    *unused += (v.capacity() - v.size()) * sizeof(T);
+    return v.capacity() * sizeof(T);
+}
+
+/**
+ * @brief
+ *   heap memory the option holds (not the option object itself)
+ *   the default doesn't hold any.
+ *
+ * @param[out] unused - bytes allocated but not in use, e.g. spare capacity of a vector
+ *
+ * @return size_t - bytes
+ */
+size_t CmdLineOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return 0;
+}
+
+/**
+ * @brief
+ *   take the values from a file, for 'name:=@file'
+ *   the default can't read values from a file.
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file can be used
+ */
+bool CmdLineOption::MapFile(const char *)
+{
+    return false;
+}
+
+/**
+ * @brief
+ *   check if MapFile() would work, without changing the option
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file can be used
+ */
+bool CmdLineOption::CheckFile(const char *)
+{
+    return false;
+}
+
 /**
  * @brief
  *   Return the singleton instance
@@ -95,6 +225,8 @@ void CmdLineOption::OptionSet()
 BoolOption::BoolOption(bool default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_BOOL;
+    this->is_bool = true;
     SetFromEnvironmentVariable();
 }
 
@@ -119,6 +251,7 @@ void BoolOption::Reset()
 IntOption::IntOption(int32_t default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_INT;
     SetFromEnvironmentVariable();
 }
 
@@ -192,6 +325,32 @@ bool IntOption::ParseValueWithError(const char *s, std::ostream &error_message)
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool IntOption::CheckValue(const char *s)
+{
+    char *temp;
+    parse_int(s, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void IntOption::ShowValue(std::ostream &out)
+{
+    out << value;
+}
+
 /**
  * @brief
  *   constructor
@@ -203,6 +362,7 @@ bool IntOption::ParseValueWithError(const char *s, std::ostream &error_message)
 UintOption::UintOption(uint32_t default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_UINT;
     SetFromEnvironmentVariable();
 }
 
@@ -276,6 +436,32 @@ bool UintOption::ParseValueWithError(const char *s, std::ostream &error_message)
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool UintOption::CheckValue(const char *s)
+{
+    char *temp;
+    parse_uint(s, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void UintOption::ShowValue(std::ostream &out)
+{
+    out << value;
+}
+
 /**
  * @brief
  *   constructor
@@ -287,6 +473,7 @@ bool UintOption::ParseValueWithError(const char *s, std::ostream &error_message)
 Int64Option::Int64Option(int64_t default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_INT64;
     SetFromEnvironmentVariable();
 }
 
@@ -360,6 +547,32 @@ bool Int64Option::ParseValueWithError(const char *s, std::ostream &error_message
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool Int64Option::CheckValue(const char *s)
+{
+    char *temp;
+    parse_int64(s, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void Int64Option::ShowValue(std::ostream &out)
+{
+    out << value;
+}
+
 /**
  * @brief
  *   constructor
@@ -371,6 +584,7 @@ bool Int64Option::ParseValueWithError(const char *s, std::ostream &error_message
 Uint64Option::Uint64Option(uint64_t default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_UINT64;
     SetFromEnvironmentVariable();
 }
 
@@ -444,6 +658,32 @@ bool Uint64Option::ParseValueWithError(const char *s, std::ostream &error_messag
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool Uint64Option::CheckValue(const char *s)
+{
+    char *temp;
+    parse_uint64(s, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void Uint64Option::ShowValue(std::ostream &out)
+{
+    out << value;
+}
+
 /**
  * @brief
  *   case insensitive string compare
@@ -474,29 +714,43 @@ static int my_stricmp(const char *s1, const char *s2)
 
 /**
  * @brief
- *   parse the command line option
+ *   parse a boolean value
  *
- * @param[in] s - default value if not specified on command line
+ * @param[in] s - string to parse
+ * @param[out] value - boolean value, unchanged if the string is not valid
  *
- * @return bool - true if option was valid.
+ * @return bool - true if the string was valid.
  */
-bool BoolOption::ParseValue(const char *s)
+static bool parse_bool(const char *s, bool *value)
 {
     if ((my_stricmp(s, "") == 0) || (my_stricmp(s, "1") == 0) || (my_stricmp(s, "on") == 0) ||
         (my_stricmp(s, "yes") == 0) || (my_stricmp(s, "true") == 0))
     {
-        value = true;
+        *value = true;
         return true;
     }
     if ((my_stricmp(s, "0") == 0) || (my_stricmp(s, "no") == 0) || (my_stricmp(s, "off") == 0) ||
         (my_stricmp(s, "false") == 0))
     {
-        value = false;
+        *value = false;
         return true;
     }
     return false;
 }
 
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool BoolOption::ParseValue(const char *s)
+{
+    return parse_bool(s, &value);
+}
+
 /**
  * @brief
  *   Parse a command line option
@@ -517,6 +771,50 @@ bool BoolOption::ParseValueWithError(const char *s, std::ostream &error_message)
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool BoolOption::CheckValue(const char *s)
+{
+    bool temp;
+    return parse_bool(s, &temp);
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void BoolOption::ShowValue(std::ostream &out)
+{
+    out << (value ? "true" : "false");
+}
+
+/**
+ * @brief
+ *   find the values that start with a prefix, for shell completion
+ *
+ * @param[in] prefix - start of the value typed so far
+ * @param[out] matches - matching values
+ */
+void BoolOption::CompleteValue(const char *prefix, std::vector<const char *> &matches)
+{
+    static const char *keywords[] = {"true", "false", "yes", "no", "on", "off"};
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+    {
+        if (strncasecmp(keywords[i], prefix, strlen(prefix)) == 0)
+        {
+            matches.push_back(keywords[i]);
+        }
+    }
+}
+
 /**
  * @brief
  *   constructor
@@ -528,6 +826,7 @@ bool BoolOption::ParseValueWithError(const char *s, std::ostream &error_message)
 EnumOption::EnumOption(uint32_t default_value, const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
 {
+    this->type = CMD_LINE_OPTION_ENUM;
 }
 
 /**
@@ -557,6 +856,20 @@ void EnumOption::AddEnum(uint32_t _value, const char *_str, const char *_usage_m
     enum_list_.push_back(value_string);
 }
 
+/**
+ * @brief
+ *   heap memory of the enumeration table
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t EnumOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(enum_list_, unused);
+}
+
 /**
  * @brief
  *   find an enumeration
@@ -618,6 +931,25 @@ bool EnumOption::ParseValue(const char *s)
     return false; // never gets here
 }
 
+/**
+ * @brief
+ *   parse the command line option without printing anything or exiting
+ *
+ * @param[in] s - enumeration string or integer
+ *
+ * @return bool - true if option was valid.
+ */
+bool EnumOption::TryParseValue(const char *s)
+{
+    if (find_enum(&enum_list_, s, &value))
+    {
+        return true;
+    }
+    char *temp;
+    value = parse_int(s, &temp);
+    return *temp == 0;
+}
+
 /**
  * @brief
  *   parse the enumeration
@@ -664,6 +996,63 @@ bool EnumOption::ParseValueWithError(const char *s, std::ostream &error_message)
     return false;
 }
 
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool EnumOption::CheckValue(const char *s)
+{
+    uint32_t temp_value;
+    if (find_enum(&enum_list_, s, &temp_value))
+    {
+        return true;
+    }
+    char *temp;
+    parse_int(s, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void EnumOption::ShowValue(std::ostream &out)
+{
+    const char *str = GetString(value);
+    if (strcmp(str, "undefined") == 0)
+    {
+        out << value;
+    }
+    else
+    {
+        out << str;
+    }
+}
+
+/**
+ * @brief
+ *   find the enumerations that start with a prefix, for shell completion
+ *
+ * @param[in] prefix - start of the value typed so far
+ * @param[out] matches - matching enumerations
+ */
+void EnumOption::CompleteValue(const char *prefix, std::vector<const char *> &matches)
+{
+    for (std::vector<value_str_t>::const_iterator it = enum_list_.begin(); it != enum_list_.end(); ++it)
+    {
+        if (strncasecmp(it->str, prefix, strlen(prefix)) == 0)
+        {
+            matches.push_back(it->str);
+        }
+    }
+}
+
 /**
  * @brief
  *   returns the string associated with that value. (defined by AddEnum())
@@ -695,6 +1084,7 @@ const char *EnumOption::GetString(uint32_t x)
 IntRangeOption::IntRangeOption(const char *_name, const char *_usage_message)
     : CmdLineOption(_name, _usage_message), start_value(), end_value(), size()
 {
+    this->type = CMD_LINE_OPTION_INT_RANGE;
     SetFromEnvironmentVariable();
 }
 
@@ -705,29 +1095,35 @@ IntRangeOption::IntRangeOption(const char *_name, const char *_usage_message)
 void IntRangeOption::Reset()
 {
     is_set = false;
+    start_value = 0;
+    end_value = 0;
+    size = 0;
 }
 
 /**
  * @brief
- *   parse the command line option
+ *   parse an integer range
  *
- * @param[in] s - default value if not specified on command line
+ * @param[in] s - string to parse, start..end or start+count
+ * @param[out] start_value - start of the range
+ * @param[out] end_value - end of the range
+ * @param[out] size - size of the range
  *
- * @return bool - true if option was valid.
+ * @return bool - true if the range was valid.
  */
-bool IntRangeOption::ParseValue(const char *s)
+static bool parse_range(const char *s, int32_t *start_value, int32_t *end_value, int32_t *size)
 {
     char *temp;
-    start_value = parse_int(s, &temp);
+    *start_value = parse_int(s, &temp);
     s = temp;
     if (*s == '+')
     {
         s++;
-        size = parse_int(s, &temp);
+        *size = parse_int(s, &temp);
         if (*temp != 0)
             return false;
 
-        end_value = start_value + size;
+        *end_value = *start_value + *size;
 
         /* printf("%s=%d (%x)\n",name,option_field,option_field); */
         return true;
@@ -738,11 +1134,11 @@ bool IntRangeOption::ParseValue(const char *s)
     if (*s != '.')
         return false;
     s++;
-    end_value = parse_int(s, &temp);
+    *end_value = parse_int(s, &temp);
     if (*temp != 0)
         return false;
 
-    size = end_value - start_value;
+    *size = *end_value - *start_value;
 
     /* printf("%s=%d (%x)\n",name,option_field,option_field); */
     return true;
@@ -750,14 +1146,40 @@ bool IntRangeOption::ParseValue(const char *s)
 
 /**
  * @brief
- *   Parse a command line option
+ *   parse the command line option
  *
- * @param[in] s - command line argument string
- * @param[in] error_message - error message
+ * @param[in] s - default value if not specified on command line
  *
- * @return bool - true if argument string is valid
+ * @return bool - true if option was valid.
  */
-bool IntRangeOption::ParseValueWithError(const char *s, std::ostream &error_message)
+bool IntRangeOption::ParseValue(const char *s)
+{
+    return parse_range(s, &start_value, &end_value, &size);
+}
+
+/**
+ * @brief
+ *   is a value in the range, start_value to end_value with both included (so 100+10 is 100..110)
+ *
+ * @param[in] value - value
+ *
+ * @return bool - true if the value is in the range, false if the option isn't set
+ */
+bool IntRangeOption::Contains(int32_t value) const
+{
+    return is_set & (value >= start_value) & (value <= end_value);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool IntRangeOption::ParseValueWithError(const char *s, std::ostream &error_message)
 {
     if (ParseValue(s))
         return true;
@@ -772,795 +1194,5990 @@ bool IntRangeOption::ParseValueWithError(const char *s, std::ostream &error_mess
 
 /**
  * @brief
- *   constructor
+ *   check if a string is a valid value without changing the option
  *
- * @param[in] _name - option name
- * @param[in] _usage_message - option usage message
- * @param[in] _default_step - default step size for ranges (e.g. integer lists that are register addresses use a default
- * step of 4)
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
  */
-IntListOption::IntListOption(const char *_name, const char *_usage_message, uint32_t _default_step)
-    : CmdLineOption(_name, _usage_message)
+bool IntRangeOption::CheckValue(const char *s)
 {
-    this->is_list = true;
-    this->default_step = _default_step;
-    this->mask = 0;
-    SetFromEnvironmentVariable();
+    int32_t temp_start, temp_end, temp_size;
+    return parse_range(s, &temp_start, &temp_end, &temp_size);
 }
 
 /**
- * @brief end of list parsing
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
  */
-void IntListOption::EndOfList()
+void IntRangeOption::ShowValue(std::ostream &out)
 {
+    out << start_value << ".." << end_value;
 }
 
 /**
- * @brief end of list parsing
+ * @brief
+ *   constructor, nothing mapped
  */
-void IntListOption::Reset()
+MappedList::MappedList() : path(NULL), data_(NULL), end_(NULL), size_(0), raw_size_(0)
 {
-    CmdLineOption::Reset();
-    value_list_.clear();
-    string_list_.clear();
+}
+
+MappedList::~MappedList()
+{
+    Unmap();
 }
 
 /**
  * @brief
- *   parse the command line option
+ *   split 'raw:file' from 'file'
  *
- * @param[in] s - default value if not specified on command line
+ * @param[in] path - path, maybe with raw: in front
+ * @param[in] raw_size - size of a value in a raw file, 0 if the list can't be raw
+ * @param[out] value_size - size of a raw value, 0 for a text file
  *
- * @return bool - true if option was valid.
+ * @return const char * - the file name, NULL if the list can't be raw
  */
-bool IntListOption::ParseValue(const char *s)
+static const char *mapped_list_file(const char *path, size_t raw_size, size_t *value_size)
 {
-    char *temp;
-    int32_t value;
-    value = parse_int(s, &temp);
-    if (*temp == 0)
+    *value_size = 0;
+    if (strncmp(path, "raw:", 4) != 0)
     {
-        value_list_.push_back(value);
-        mask |= 1 << value;
-        string_list_.push_back(s);
-        return true;
+        return path;
     }
-    int32_t start_value = value;
-    int32_t end_value;
-    int32_t size;
-    int32_t i;
-    s = temp;
-    if (*s == '+')
-    {
-        s++;
-        size = parse_int(s, &temp);
-        uint32_t step = default_step;
-        if (*temp == '/')
-        {
-            s = temp;
-            s++;
-            step = parse_int(s, &temp);
-        }
-        if (*temp != 0)
-            return false;
+    *value_size = raw_size;
+    return (raw_size != 0) ? path + 4 : NULL;
+}
 
-        end_value = start_value + size * step;
+/**
+ * @brief
+ *   decode a line of a text file of integers,... one number, in the IntOption formats
+ *
+ * @param[in] pos - start of the line
+ * @param[in] end - end of the file
+ * @param[out] value - value
+ *
+ * @return bool - true if the line is a number
+ */
+static bool decode_int_line(const char *pos, const char *end, int32_t *value)
+{
+    // the line isn't 0 terminated, and the file may end right after it
+    const char *eol = (const char *)memchr(pos, '\n', end - pos);
+    size_t length = ((eol == NULL) ? end : eol) - pos;
+    if ((length != 0) && (pos[length - 1] == '\r'))
+    {
+        length--;
+    }
+    char line[32];
+    if (length >= sizeof(line))
+    {
+        return false;
+    }
+    memcpy(line, pos, length);
+    line[length] = 0;
+    char *temp;
+    *value = parse_int(line, &temp);
+    return *temp == 0;
+}
 
-        for (i = start_value; i < end_value; i += step)
+/**
+ * @brief
+ *   map a file, instead of the one mapped before (if any)
+ *
+ *   every line of a text file of integers is checked here, so Decode() can't meet a bad one.  the pages that
+ *   reads in are dropped again afterwards.
+ *
+ * @param[in] _path - file, 'raw:file' for an array of values
+ * @param[in] raw_size - size of a value in a raw file, 0 for a list of strings (which can't be raw, and whose
+ *                       lines are all valid)
+ *
+ * @return bool - true if the file was mapped, false if it can't be or has a line that isn't valid
+ */
+bool MappedList::Map(const char *_path, size_t raw_size)
+{
+    Unmap();
+    size_t value_size;
+    const char *file = mapped_list_file(_path, raw_size, &value_size);
+    int fd = (file != NULL) ? open(file, O_RDONLY) : -1;
+    struct stat info;
+    if ((fd < 0) || (fstat(fd, &info) != 0) || !S_ISREG(info.st_mode))
+    {
+        if (fd >= 0)
         {
-            value_list_.push_back(i);
-            mask |= 1 << i;
+            close(fd);
         }
-
-        string_list_.push_back(s);
-        /* printf("%s=%d (%x)\n",name,option_field,option_field); */
-        return true;
-    }
-    if (*s != '.')
-        return false;
-    s++;
-    if (*s != '.')
         return false;
-    s++;
-    end_value = parse_int(s, &temp);
-    if (*temp != 0)
+    }
+    size_t size = info.st_size;
+    void *data = (size != 0) ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
         return false;
-
-    size = end_value - start_value;
-    for (i = start_value; i <= end_value; i += default_step)
+    }
+    if (data != NULL)
     {
-        value_list_.push_back(i);
-        mask |= 1 << i;
+        // read once, front to back,... the kernel can read ahead and drop pages behind
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    path = _path;
+    data_ = (const char *)data;
+    size_ = size;
+    raw_size_ = value_size;
+    end_ = data_ + ((raw_size_ != 0) ? size - size % raw_size_ : size);
+    if ((raw_size != 0) && (raw_size_ == 0))
+    {
+        int32_t value;
+        for (const char *pos = First(); pos != end_; pos = Next(pos))
+        {
+            if (!decode_int_line(pos, end_, &value))
+            {
+                Unmap();
+                return false;
+            }
+        }
+        DropPages();
     }
-
-    string_list_.push_back(s);
-    /* printf("%s=%d (%x)\n",name,option_field,option_field); */
     return true;
 }
 
 /**
  * @brief
- *   Parse a command line option
+ *   check if a file can be used, including every line of it,... it's mapped, checked and unmapped again.
  *
- * @param[in] s - command line argument string
- * @param[in] error_message - error message
+ * @param[in] _path - file, 'raw:file' for an array of values
+ * @param[in] raw_size - size of a value in a raw file, 0 for a list of strings
  *
- * @return bool - true if argument string is valid
+ * @return bool - true if Map() would work
  */
-bool IntListOption::ParseValueWithError(const char *s, std::ostream &error_message)
+bool MappedList::Check(const char *_path, size_t raw_size)
 {
-    if (ParseValue(s))
-        return true;
-    error_message << "error parsing '" << s << "'\n";
-    error_message << " for IntList option '" << name << "'\n";
-    error_message << " option description: " << usage_message << "\n";
-    error_message << "list formats are:\n";
-    if (default_step == 0x4)
-    {
-        error_message << "   start..end       e.g. " << name << " 0xd00380..0xd00388\n";
-        error_message << "   start+count      e.g. " << name << " 0xd00380+2 (that's 0xd00380 0xd00384)\n";
-        error_message << "   start+count/skip e.g. " << name << " 0xd00380+2/0x20 (that's 0xd00380 0xd003A0) \n";
-    }
-    else
+    MappedList list;
+    return list.Map(_path, raw_size);
+}
+
+/**
+ * @brief
+ *   unmap the file (if any)
+ */
+void MappedList::Unmap()
+{
+    if (data_ != NULL)
     {
-        error_message << "   start..end       e.g. " << name << " 0..10\n";
-        error_message << "   start+count      e.g. " << name << " 5+2 (that's 5 6)\n";
-        error_message << "   start+count/skip e.g. " << name << " 11+3/100 (that's 11 111 211) \n";
+        munmap((void *)data_, size_);
     }
-    return false;
+    path = NULL;
+    data_ = NULL;
+    end_ = NULL;
+    size_ = 0;
 }
 
 /**
  * @brief
- *   add a value to an integer list
- *
- * @param[in] value - value to add
+ *   drop the pages of the file that have been read in,... after a pass over the whole file, so they don't stay
+ *   in the process's RSS.  they're read in again (from the page cache, if they're still there) when they're used.
  */
-void IntListOption::AddValue(const int32_t value)
+void MappedList::DropPages() const
 {
-    this->value_list_.push_back(value);
-    this->mask |= 1 << value;
+    if (data_ != NULL)
+    {
+        madvise((void *)data_, size_, MADV_DONTNEED);
+    }
 }
 
 /**
  * @brief
- *   same as a StringList, but stop if you find another command line option.
+ *   skip empty lines of a text file
  *
- * @param[in] _name - option name
- * @param[in] _usage_message - option usage message
+ * @param[in] pos - start of a line
+ * @param[in] end - end of the file
+ *
+ * @return const char * - start of the next line that isn't empty, or the end
  */
-OptionFreeStringListOption::OptionFreeStringListOption(const char *_name, const char *_usage_message)
-    : StringListOption(_name, _usage_message)
+static const char *skip_empty_lines(const char *pos, const char *end)
 {
-    this->is_option_free_list = true;
-    SetFromEnvironmentVariable();
+    while ((pos < end) && ((*pos == '\n') || (*pos == '\r')))
+    {
+        pos++;
+    }
+    return pos;
 }
 
 /**
  * @brief
- *   constructor
+ *   position of the first value in the file
  *
- * @param[in] _name - option name
- * @param[in] _usage_message - option usage message
+ * @return const char * - first value, End() if there are none
  */
-StringListOption::StringListOption(const char *_name, const char *_usage_message) : CmdLineOption(_name, _usage_message)
+const char *MappedList::First() const
 {
-    this->is_list = true;
-    SetFromEnvironmentVariable();
+    return (raw_size_ != 0) ? data_ : skip_empty_lines(data_, end_);
 }
 
 /**
- * @brief end of list parsing
+ * @brief
+ *   position of the value after a value
+ *
+ * @param[in] pos - a value
+ *
+ * @return const char * - next value, End() after the last one
  */
-void StringListOption::EndOfList()
+const char *MappedList::Next(const char *pos) const
 {
+    if (raw_size_ != 0)
+    {
+        return pos + raw_size_;
+    }
+    const char *eol = (const char *)memchr(pos, '\n', end_ - pos);
+    return (eol == NULL) ? end_ : skip_empty_lines(eol + 1, end_);
 }
 
 /**
- * @brief end of list parsing
+ * @brief
+ *   decode an integer,... Map() has checked that each line is a number.
+ *
+ * @param[in] pos - the value
+ * @param[out] value - value
  */
-void StringListOption::Reset()
+void MappedList::Decode(const char *pos, int32_t *value) const
 {
-    CmdLineOption::Reset();
-    string_list_.clear();
+    if (raw_size_ != 0)
+    {
+        memcpy(value, pos, sizeof(*value));
+        return;
+    }
+    decode_int_line(pos, end_, value);
 }
 
 /**
  * @brief
- *   parse the command line option
+ *   decode a string,... the line without its end of line
  *
- * @param[in] s - default value if not specified on command line
- *
- * @return bool - true if option was valid.
+ * @param[in] pos - the value
+ * @param[out] value - value, points into the file
  */
-bool StringListOption::ParseValue(const char *s)
+void MappedList::Decode(const char *pos, std::string_view *value) const
 {
-    string_list_.push_back(s);
-    return true;
+    const char *eol = (const char *)memchr(pos, '\n', end_ - pos);
+    size_t length = ((eol == NULL) ? end_ : eol) - pos;
+    if ((length != 0) && (pos[length - 1] == '\r'))
+    {
+        length--;
+    }
+    *value = std::string_view(pos, length);
 }
 
 /**
  * @brief
  *   constructor
  *
- * @param[in] default_value - default value if not specified on command line
  * @param[in] _name - option name
  * @param[in] _usage_message - option usage message
+ * @param[in] _default_step - default step size for ranges (e.g. integer lists that are register addresses use a default
+ * step of 4)
  */
-DoubleOption::DoubleOption(double default_value, const char *_name, const char *_usage_message)
-    : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
+IntListOption::IntListOption(const char *_name, const char *_usage_message, uint32_t _default_step)
+    : CmdLineOption(_name, _usage_message)
 {
+    this->type = CMD_LINE_OPTION_INT_LIST;
+    this->is_list = true;
+    this->default_step = _default_step;
+    this->mask = 0;
+    this->index_base_ = 0;
+    this->index_count_ = SIZE_MAX;
+    this->values_count_ = SIZE_MAX;
     SetFromEnvironmentVariable();
 }
 
 /**
  * @brief
- *   reset value to default
+ *   bit of a value in IntListOption::mask,... only 0..31 have one.
+ *
+ * @param[in] value - value
+ *
+ * @return uint32_t - the bit, 0 if the value is out of range
  */
-void DoubleOption::Reset()
+static uint32_t int_list_bit(int32_t value)
 {
-    is_set = false;
-    value = _default_value;
+    return ((uint32_t)value < 32) ? (uint32_t)1 << value : 0;
 }
 
 /**
  * @brief
- *   parse the command line option
+ *   lay out sorted runs in Eytzinger order (the order of a breadth first walk of a balanced search tree),
+ *   so a search goes through the array in a predictable pattern and its first steps share cache lines.
  *
- * @param[in] s - default value if not specified on command line
+ * @param[in] runs - sorted runs, start and end (inclusive) of each
+ * @param[in] i - next run to place
+ * @param[in] k - node to fill, 1 is the root, 2k and 2k + 1 are its children
+ * @param[out] starts - starts of the runs, in Eytzinger order from [1]
+ * @param[out] ends - ends of the runs, in the same order
  *
- * @return bool - true if option was valid.
+ * @return size_t - next run to place
  */
-bool DoubleOption::ParseValue(const char *s)
+static size_t eytzinger_fill(const std::vector<std::pair<int32_t, int32_t>> &runs, size_t i, size_t k,
+                             std::vector<int32_t> &starts, std::vector<int32_t> &ends)
 {
-    char *temp = NULL;
-    value = strtod(s, &temp);
-    if (*temp == '/')
+    if (k <= runs.size())
     {
-        temp++;
-        double denominator = strtod(temp, &temp);
-        double numerator = value;
-        value = numerator / denominator;
-        printf("setting %s to %g/%g = %g\n", name, numerator, denominator, value);
+        i = eytzinger_fill(runs, i, 2 * k, starts, ends);
+        starts[k] = runs[i].first;
+        ends[k] = runs[i].second;
+        i++;
+        i = eytzinger_fill(runs, i, 2 * k + 1, starts, ends);
     }
+    return i;
+}
 
-    if (*temp != 0)
+/**
+ * @brief
+ *   end of list parsing,... adds the file's values (if any) to mask.
+ *
+ *   the index Contains() uses is built the first time it's needed, so a list that's never searched doesn't pay
+ *   for it (a big file list would be decoded and copied).
+ */
+void IntListOption::EndOfList()
+{
+    index_count_.store(SIZE_MAX, std::memory_order_relaxed);
+    if (file_.End() == NULL)
     {
-        return false;
+        return;
     }
-    else
+    for (const char *pos = file_.First(); pos != file_.End(); pos = file_.Next(pos))
     {
-        return true;
+        int32_t value;
+        file_.Decode(pos, &value);
+        mask |= int_list_bit(value);
     }
+    file_.DropPages();
 }
 
 /**
  * @brief
- *   Parse a command line option
+ *   build the index Contains() uses, over value_list_ and the file's values (if any)
  *
- * @param[in] s - command line argument string
- * @param[in] error_message - error message
- *
- * @return bool - true if argument string is valid
+ *   values that are close together get a bitmap (no bigger than the values themselves), anything else is sorted
+ *   and merged into runs of consecutive values, which are searched in Eytzinger order.
+ *   threads that call Contains() at the same time wait for the one that builds it.
  */
-bool DoubleOption::ParseValueWithError(const char *s, std::ostream &error_message)
+void IntListOption::BuildIndex() const
 {
-    if (ParseValue(s))
-        return true;
-    error_message << "error parsing '" << s << "'\n";
-    error_message << " for Double option '" << name << "'\n";
-    error_message << " option description: " << usage_message << "\n";
-    error_message << "double is parsed with strtod, or numerator/denominator\n";
-    error_message << "   " << name << "="
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (index_count_.load(std::memory_order_relaxed) == value_list_.size())
+    {
+        return;
+    }
+    bitmap_.clear();
+    run_start_.clear();
+    run_end_.clear();
+    size_t count = 0;
+    int32_t min_value = INT32_MAX;
+    int32_t max_value = INT32_MIN;
+    for (const_iterator it = begin(); it != end(); ++it)
+    {
+        min_value = std::min(min_value, *it);
+        max_value = std::max(max_value, *it);
+        count++;
+    }
+    if (count == 0)
+    {
+        index_count_.store(value_list_.size(), std::memory_order_release);
+        return;
+    }
+    index_base_ = min_value;
+    uint64_t span = (uint64_t)((int64_t)max_value - min_value) + 1;
+    if (span <= 32 * (uint64_t)count + 64)
+    {
+        bitmap_.assign((span + 63) / 64, 0);
+        for (const_iterator it = begin(); it != end(); ++it)
+        {
+            uint64_t bit = (uint64_t)((int64_t)*it - index_base_);
+            bitmap_[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+    }
+    else
+    {
+        std::vector<int32_t> sorted(begin(), end());
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<std::pair<int32_t, int32_t>> runs;
+        for (std::vector<int32_t>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+        {
+            if (!runs.empty() && ((int64_t)*it <= (int64_t)runs.back().second + 1))
+            {
+                runs.back().second = std::max(runs.back().second, *it);
+            }
+            else
+            {
+                runs.push_back(std::make_pair(*it, *it));
+            }
+        }
+        run_start_.resize(runs.size() + 1);
+        run_end_.resize(runs.size() + 1);
+        eytzinger_fill(runs, 0, 1, run_start_, run_end_);
+    }
+    file_.DropPages();
+    index_count_.store(value_list_.size(), std::memory_order_release);
+}
+
+/**
+ * @brief
+ *   is a value in the list,... nanoseconds however long the list is, once the first call has built the index.
+ *
+ *   the index is built again after the list changes (EndOfList(), or a value added with AddValue()).
+ *   any number of threads can call this, as long as none of them changes the list.
+ *
+ * @param[in] value - value
+ *
+ * @return bool - true if the value is in value_list_ or the file
+ */
+bool IntListOption::Contains(int32_t value) const
+{
+    if (index_count_.load(std::memory_order_acquire) != value_list_.size())
+    {
+        BuildIndex();
+    }
+    if (!bitmap_.empty())
+    {
+        uint64_t bit = (uint64_t)((int64_t)value - index_base_);
+        return (bit < bitmap_.size() * 64) && ((bitmap_[bit / 64] >> (bit % 64)) & 1);
+    }
+    // find the first run that ends at or after the value,... the loop always takes about log2(runs) steps,
+    // and the path it took says where it went right last
+    size_t n = (run_end_.size() > 0) ? run_end_.size() - 1 : 0;
+    size_t k = 1;
+    while (k <= n)
+    {
+        k = 2 * k + (run_end_[k] < value);
+    }
+    k >>= __builtin_ffsll(~k);
+    return (k != 0) && (run_start_[k] <= value);
+}
+
+
+/**
+ * @brief end of list parsing
+ */
+void IntListOption::Reset()
+{
+    CmdLineOption::Reset();
+    value_list_.clear();
+    string_list_.clear();
+    file_.Unmap();
+    mask = 0;
+    bitmap_.clear();
+    run_start_.clear();
+    run_end_.clear();
+    index_count_ = SIZE_MAX;
+    values_.clear();
+    values_count_ = SIZE_MAX;
+}
+
+/**
+ * @brief
+ *   take more values from a file, for 'name:=@file' (or '@raw:file' for an array of int32_t's)
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file was mapped
+ */
+bool IntListOption::MapFile(const char *path)
+{
+    values_count_ = SIZE_MAX;
+    return file_.Map(path, sizeof(int32_t));
+}
+
+/**
+ * @brief
+ *   check if MapFile() would work, without changing the option
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file can be used
+ */
+bool IntListOption::CheckFile(const char *path)
+{
+    return MappedList::Check(path, sizeof(int32_t));
+}
+
+/**
+ * @brief
+ *   first value, of value_list_ and then the file,... the file's values are decoded as they're reached.
+ *
+ * @return const_iterator - first value
+ */
+IntListOption::const_iterator IntListOption::begin() const
+{
+    return const_iterator(&value_list_, 0, &file_, file_.First());
+}
+
+/**
+ * @brief
+ *   end of the values
+ *
+ * @return const_iterator - past the last value
+ */
+IntListOption::const_iterator IntListOption::end() const
+{
+    return const_iterator(&value_list_, value_list_.size(), &file_, file_.End());
+}
+
+/**
+ * @brief
+ *   all the values in one array, for code that can't use begin()/end() (e.g. the C API)
+ *
+ *   without a file that's value_list_.  with one, the file's values are decoded into a copy the first time
+ *   (and again if value_list_ has grown since).
+ *
+ * @return const std::vector<int32_t> & - value_list_ and then the file's values
+ */
+const std::vector<int32_t> &IntListOption::Values()
+{
+    if (file_.path == NULL)
+    {
+        return value_list_;
+    }
+    if (values_count_ != value_list_.size())
+    {
+        values_.assign(begin(), end());
+        values_count_ = value_list_.size();
+    }
+    return values_;
+}
+
+/**
+ * @brief
+ *   heap memory of the values and strings
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t IntListOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(value_list_, unused) + vector_bytes(string_list_, unused) + vector_bytes(bitmap_, unused) +
+           vector_bytes(run_start_, unused) + vector_bytes(run_end_, unused) + vector_bytes(values_, unused);
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool IntListOption::ParseValue(const char *s)
+{
+    char *temp;
+    int32_t value;
+    value = parse_int(s, &temp);
+    if (*temp == 0)
+    {
+        value_list_.push_back(value);
+        mask |= int_list_bit(value);
+        string_list_.push_back(s);
+        return true;
+    }
+    int32_t start_value = value;
+    int32_t end_value;
+    int32_t size;
+    int32_t i;
+    s = temp;
+    if (*s == '+')
+    {
+        s++;
+        size = parse_int(s, &temp);
+        uint32_t step = default_step;
+        if (*temp == '/')
+        {
+            s = temp;
+            s++;
+            step = parse_int(s, &temp);
+        }
+        if (*temp != 0)
+            return false;
+
+        end_value = start_value + size * step;
+
+        for (i = start_value; i < end_value; i += step)
+        {
+            value_list_.push_back(i);
+            mask |= int_list_bit(i);
+        }
+
+        string_list_.push_back(s);
+        /* printf("%s=%d (%x)\n",name,option_field,option_field); */
+        return true;
+    }
+    if (*s != '.')
+        return false;
+    s++;
+    if (*s != '.')
+        return false;
+    s++;
+    end_value = parse_int(s, &temp);
+    if (*temp != 0)
+        return false;
+
+    size = end_value - start_value;
+    for (i = start_value; i <= end_value; i += default_step)
+    {
+        value_list_.push_back(i);
+        mask |= int_list_bit(i);
+    }
+
+    string_list_.push_back(s);
+    /* printf("%s=%d (%x)\n",name,option_field,option_field); */
+    return true;
+}
+
+/**
+ * @brief
+ *   check if a list item is valid without changing the list
+ *
+ * @param[in] s - list item, e.g. 5, 0..9 or 100+4/8
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool IntListOption::CheckValue(const char *s)
+{
+    char *temp;
+    parse_int(s, &temp);
+    if (*temp == 0)
+    {
+        return true;
+    }
+    if (*temp == '+')
+    {
+        parse_int(temp + 1, &temp);
+        if (*temp == '/')
+        {
+            parse_int(temp + 1, &temp);
+        }
+        return *temp == 0;
+    }
+    if ((temp[0] != '.') || (temp[1] != '.'))
+    {
+        return false;
+    }
+    parse_int(temp + 2, &temp);
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool IntListOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for IntList option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    error_message << "list formats are:\n";
+    if (default_step == 0x4)
+    {
+        error_message << "   start..end       e.g. " << name << " 0xd00380..0xd00388\n";
+        error_message << "   start+count      e.g. " << name << " 0xd00380+2 (that's 0xd00380 0xd00384)\n";
+        error_message << "   start+count/skip e.g. " << name << " 0xd00380+2/0x20 (that's 0xd00380 0xd003A0) \n";
+    }
+    else
+    {
+        error_message << "   start..end       e.g. " << name << " 0..10\n";
+        error_message << "   start+count      e.g. " << name << " 5+2 (that's 5 6)\n";
+        error_message << "   start+count/skip e.g. " << name << " 11+3/100 (that's 11 111 211) \n";
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void IntListOption::ShowValue(std::ostream &out)
+{
+    for (const_iterator it = begin(); it != end(); ++it)
+    {
+        if (it != begin())
+        {
+            out << " ";
+        }
+        out << *it;
+    }
+}
+
+/**
+ * @brief
+ *   add a value to an integer list
+ *
+ * @param[in] value - value to add
+ */
+void IntListOption::AddValue(const int32_t value)
+{
+    this->value_list_.push_back(value);
+    this->mask |= int_list_bit(value);
+}
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+/**
+ * @brief
+ *   check if 8 characters (loaded little endian) are all decimal digits
+ */
+static inline bool is_eight_digits(uint64_t chunk)
+{
+    return ((chunk & 0xf0f0f0f0f0f0f0f0) | (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ==
+           0x3333333333333333;
+}
+
+/**
+ * @brief
+ *   convert 8 decimal digits (loaded little endian) to an integer with 3 multiplies instead of 8
+ */
+static inline uint32_t parse_eight_digits(uint64_t chunk)
+{
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000ff000000ff) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000ff000000ff) * (1 + (10000ULL << 32)))) >>
+            32;
+    return (uint32_t)chunk;
+}
+#endif
+
+/**
+ * @brief
+ *   scan a decimal number
+ *
+ * @param[in] s - start of the number
+ * @param[in] end - end of the string (the number can't go past this)
+ * @param[out] value - value of the number
+ *
+ * @return const char * - first character after the number, NULL if there are no digits or the number overflows.
+ */
+static const char *scan_decimal(const char *s, const char *end, uint64_t *value)
+{
+    const char *start = s;
+    uint64_t v = 0;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    // 8 digits at a time, up to 16 digits so this can't overflow
+    while ((end - s >= 8) && (s - start < 16))
+    {
+        uint64_t chunk;
+        memcpy(&chunk, s, sizeof(chunk));
+        if (!is_eight_digits(chunk))
+        {
+            break;
+        }
+        v = v * 100000000 + parse_eight_digits(chunk);
+        s += 8;
+    }
+#endif
+    while ((s < end) && (*s >= '0') && (*s <= '9'))
+    {
+        if (__builtin_mul_overflow(v, 10, &v) || __builtin_add_overflow(v, (uint64_t)(*s - '0'), &v))
+        {
+            return NULL;
+        }
+        s++;
+    }
+    if (s == start)
+    {
+        return NULL;
+    }
+    *value = v;
+    return s;
+}
+
+/**
+ * @brief
+ *   scan an unsigned number, handles leading '0x'
+ *
+ * @param[in] s - start of the number
+ * @param[in] end - end of the string
+ * @param[out] value - value of the number
+ *
+ * @return const char * - first character after the number, NULL if it isn't a valid number.
+ */
+static const char *scan_number(const char *s, const char *end, uint64_t *value)
+{
+    if ((end - s > 2) && (s[0] == '0') && (s[1] == 'x'))
+    {
+        uint64_t v = 0;
+        const char *start = s + 2;
+        for (s = start; s < end; s++)
+        {
+            uint32_t digit;
+            if ((*s >= '0') && (*s <= '9'))
+                digit = *s - '0';
+            else if ((*s >= 'a') && (*s <= 'f'))
+                digit = *s - 'a' + 10;
+            else if ((*s >= 'A') && (*s <= 'F'))
+                digit = *s - 'A' + 10;
+            else
+                break;
+            if (v >> 60)
+            {
+                return NULL;
+            }
+            v = (v << 4) | digit;
+        }
+        if (s == start)
+        {
+            return NULL;
+        }
+        *value = v;
+        return s;
+    }
+    return scan_decimal(s, end, value);
+}
+
+/**
+ * @brief
+ *   scan a signed number, handles leading '-' and '0x'
+ *
+ * @param[in] s - start of the number
+ * @param[in] end - end of the string
+ * @param[out] value - value of the number
+ *
+ * @return const char * - first character after the number, NULL if it isn't a valid number.
+ */
+static const char *scan_number(const char *s, const char *end, int64_t *value)
+{
+    bool negative = (s < end) && (*s == '-');
+    uint64_t magnitude;
+    s = scan_number(s + negative, end, &magnitude);
+    if ((s == NULL) || (magnitude > (uint64_t)INT64_MAX + negative))
+    {
+        return NULL;
+    }
+    *value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+    return s;
+}
+
+/**
+ * @brief
+ *   scan a floating point number
+ *
+ *   numbers with a mantissa that fits in a double and a small exponent (which covers most numbers people type)
+ *   are converted exactly with one multiply or divide, anything else (more digits, inf, nan, hex) goes to strtod().
+ *
+ * @param[in] s - start of the number
+ * @param[in] end - end of the string
+ * @param[out] value - value of the number
+ *
+ * @return const char * - first character after the number, NULL if it isn't a valid number.
+ */
+static const char *scan_number(const char *s, const char *end, double *value)
+{
+    static const double powers_of_10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = s;
+    bool negative = (p < end) && (*p == '-');
+    p += negative;
+    uint64_t mantissa = 0;
+    int32_t digits = 0;
+    int32_t exponent = 0;
+    const char *next = scan_decimal(p, end, &mantissa);
+    if (next != NULL)
+    {
+        digits = next - p;
+        p = next;
+    }
+    if ((p < end) && (*p == '.'))
+    {
+        uint64_t fraction;
+        next = scan_decimal(p + 1, end, &fraction);
+        if ((next != NULL) && (digits + (next - p - 1) <= 19))
+        {
+            exponent = -(int32_t)(next - p - 1);
+            digits -= exponent;
+            for (int32_t i = 0; i < -exponent; i++)
+            {
+                mantissa *= 10;
+            }
+            mantissa += fraction;
+            p = next;
+        }
+        else
+        {
+            digits = 0;
+        }
+    }
+    if ((digits > 0) && (p < end) && ((*p == 'e') || (*p == 'E')))
+    {
+        const char *q = p + 1;
+        bool negative_exponent = (q < end) && (*q == '-');
+        q += (q < end) && ((*q == '-') || (*q == '+'));
+        uint64_t e;
+        next = scan_decimal(q, end, &e);
+        if ((next != NULL) && (e < 100))
+        {
+            exponent += negative_exponent ? -(int32_t)e : (int32_t)e;
+            p = next;
+        }
+        else
+        {
+            digits = 0;
+        }
+    }
+    if ((digits > 0) && (digits <= 19) && (mantissa <= (1ULL << 53)) && (exponent >= -22) && (exponent <= 22) &&
+        ((p == end) || (*p == ',')))
+    {
+        // both the mantissa and the power of 10 are exact, so this is correctly rounded
+        double v = (double)mantissa;
+        v = (exponent < 0) ? v / powers_of_10[-exponent] : v * powers_of_10[exponent];
+        *value = negative ? -v : v;
+        return p;
+    }
+    if ((s == end) || isspace(*s))
+    {
+        return NULL;
+    }
+    char *temp;
+    *value = strtod(s, &temp);
+    if ((temp == s) || (temp > end))
+    {
+        return NULL;
+    }
+    return temp;
+}
+
+/**
+ * @brief
+ *   make room for all the comma separated values in a list argument, so they go into one contiguous buffer.
+ *
+ * @param[in] s - list argument
+ * @param[in] end - end of the list argument
+ * @param[in] list - list to grow
+ */
+template <typename T> static void reserve_list_values(const char *s, const char *end, std::vector<T> *list)
+{
+    size_t needed = list->size() + std::count(s, end, ',') + 1;
+    if (needed > list->capacity())
+    {
+        list->reserve(std::max(needed, 2 * list->capacity()));
+    }
+}
+
+/// most values one list argument can expand to,... so a slip like 0..4000000000 is an error rather than out of memory
+static const uint64_t max_list_expansion = (uint64_t)1 << 24;
+
+/**
+ * @brief
+ *   parse comma separated integers or ranges of integers, e.g. 1,2,3 or 0..9 or 100+4/8
+ *
+ *   an argument can't expand to more than max_list_expansion values.
+ *
+ * @param[in] s - list argument
+ * @param[in] default_step - step for ranges without an explicit step
+ * @param[out] list - values are appended to the list (nothing is appended if the argument isn't valid),
+ *                    NULL to just check the argument
+ * @param[in] dash_ranges - also accept a-b ranges (only for unsigned lists, e.g. CPU lists)
+ * @param[in,out] max_value - largest value allowed, checked before a range is expanded (NULL for no limit),
+ *                            set to the first value past it if the argument has one
+ *
+ * @return bool - true if the argument was valid
+ */
+template <typename T>
+static bool parse_integer_list(const char *s, uint64_t default_step, std::vector<T> *list, bool dash_ranges = false,
+                               uint64_t *max_value = NULL)
+{
+    const char *end = s + strlen(s);
+    size_t original_size = (list != NULL) ? list->size() : 0;
+    if (list != NULL)
+    {
+        reserve_list_values(s, end, list);
+    }
+    uint64_t total = 0;
+    for (;;)
+    {
+        T start;
+        s = scan_number(s, end, &start);
+        if (s == NULL)
+        {
+            break;
+        }
+        uint64_t count = 1;
+        uint64_t step = default_step;
+        bool dash = dash_ranges && (s < end) && (*s == '-');
+        if (dash || ((end - s >= 2) && (s[0] == '.') && (s[1] == '.')))
+        {
+            T last;
+            s = scan_number(s + (dash ? 1 : 2), end, &last);
+            if ((s == NULL) || (last < start) || (step == 0))
+            {
+                break;
+            }
+            count = ((uint64_t)last - (uint64_t)start) / step + 1;
+            if (count == 0)
+            {
+                // the whole 64 bit range
+                break;
+            }
+        }
+        else if ((s < end) && (*s == '+'))
+        {
+            s = scan_number(s + 1, end, &count);
+            if ((s != NULL) && (s < end) && (*s == '/'))
+            {
+                s = scan_number(s + 1, end, &step);
+            }
+            uint64_t span;
+            T last;
+            if ((s == NULL) || (step == 0) ||
+                ((count > 0) && (__builtin_mul_overflow(count - 1, step, &span) ||
+                                 __builtin_add_overflow(start, span, &last))))
+            {
+                break;
+            }
+        }
+        if ((max_value != NULL) && (count > 0) && ((uint64_t)start + (count - 1) * step > *max_value))
+        {
+            *max_value = ((uint64_t)start > *max_value)
+                             ? (uint64_t)start
+                             : (uint64_t)start + ((*max_value - (uint64_t)start) / step + 1) * step;
+            break;
+        }
+        total += count;
+        if ((count > max_list_expansion) || (total > max_list_expansion))
+        {
+            break;
+        }
+        if (list == NULL)
+        {
+            // just checking
+        }
+        else if (count == 1)
+        {
+            list->push_back(start);
+        }
+        else
+        {
+            for (uint64_t i = 0; i < count; i++)
+            {
+                list->push_back((T)((uint64_t)start + i * step));
+            }
+        }
+        if (s == end)
+        {
+            return true;
+        }
+        if (*s != ',')
+        {
+            break;
+        }
+        s++;
+    }
+    if (list != NULL)
+    {
+        list->resize(original_size);
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   parse comma separated doubles, e.g. 0.25,0.5,0.25
+ *
+ * @param[in] s - list argument
+ * @param[out] list - values are appended to the list (nothing is appended if the argument isn't valid),
+ *                    NULL to just check the argument
+ *
+ * @return bool - true if the argument was valid
+ */
+static bool parse_double_list(const char *s, std::vector<double> *list)
+{
+    const char *end = s + strlen(s);
+    size_t original_size = (list != NULL) ? list->size() : 0;
+    if (list != NULL)
+    {
+        reserve_list_values(s, end, list);
+    }
+    for (;;)
+    {
+        double value;
+        s = scan_number(s, end, &value);
+        if (s == NULL)
+        {
+            break;
+        }
+        if (list != NULL)
+        {
+            list->push_back(value);
+        }
+        if (s == end)
+        {
+            return true;
+        }
+        if (*s != ',')
+        {
+            break;
+        }
+        s++;
+    }
+    if (list != NULL)
+    {
+        list->resize(original_size);
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   show the list formats for the integer list options
+ *
+ * @param[in] name - option name
+ * @param[out] error_message - error message
+ */
+static void show_integer_list_formats(const char *name, std::ostream &error_message)
+{
+    error_message << "list formats are:\n";
+    error_message << "   a,b,c            e.g. " << name << " 1,2,3\n";
+    error_message << "   start..end       e.g. " << name << " 0..10\n";
+    error_message << "   start+count      e.g. " << name << " 5+2 (that's 5 6)\n";
+    error_message << "   start+count/skip e.g. " << name << " 11+3/100 (that's 11 111 211)\n";
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ * @param[in] _default_step - default step size for ranges
+ */
+Int64ListOption::Int64ListOption(const char *_name, const char *_usage_message, uint64_t _default_step)
+    : CmdLineOption(_name, _usage_message), default_step(_default_step)
+{
+    this->type = CMD_LINE_OPTION_INT64_LIST;
+    this->is_list = true;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief end of list parsing
+ */
+void Int64ListOption::EndOfList()
+{
+}
+
+/**
+ * @brief
+ *   heap memory of the values
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t Int64ListOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(value_list_, unused);
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void Int64ListOption::Reset()
+{
+    CmdLineOption::Reset();
+    value_list_.clear();
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - list argument, e.g. 1,2,3 or 0..9
+ *
+ * @return bool - true if option was valid.
+ */
+bool Int64ListOption::ParseValue(const char *s)
+{
+    return parse_integer_list(s, default_step, &value_list_);
+}
+
+/**
+ * @brief
+ *   check if a list argument is valid without changing the list
+ *
+ * @param[in] s - list argument
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool Int64ListOption::CheckValue(const char *s)
+{
+    return parse_integer_list<int64_t>(s, default_step, NULL);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool Int64ListOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for Int64List option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    show_integer_list_formats(name, error_message);
+    return false;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void Int64ListOption::ShowValue(std::ostream &out)
+{
+    for (std::vector<int64_t>::const_iterator it = value_list_.begin(); it != value_list_.end(); ++it)
+    {
+        if (it != value_list_.begin())
+        {
+            out << " ";
+        }
+        out << *it;
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ * @param[in] _default_step - default step size for ranges (e.g. 4 for lists of register addresses)
+ */
+Uint64ListOption::Uint64ListOption(const char *_name, const char *_usage_message, uint64_t _default_step)
+    : CmdLineOption(_name, _usage_message), default_step(_default_step)
+{
+    this->type = CMD_LINE_OPTION_UINT64_LIST;
+    this->is_list = true;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief end of list parsing
+ */
+void Uint64ListOption::EndOfList()
+{
+}
+
+/**
+ * @brief
+ *   heap memory of the values
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t Uint64ListOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(value_list_, unused);
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void Uint64ListOption::Reset()
+{
+    CmdLineOption::Reset();
+    value_list_.clear();
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - list argument, e.g. 0x1000,0x2000 or 0x1000+4/0x10
+ *
+ * @return bool - true if option was valid.
+ */
+bool Uint64ListOption::ParseValue(const char *s)
+{
+    return parse_integer_list(s, default_step, &value_list_);
+}
+
+/**
+ * @brief
+ *   check if a list argument is valid without changing the list
+ *
+ * @param[in] s - list argument
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool Uint64ListOption::CheckValue(const char *s)
+{
+    return parse_integer_list<uint64_t>(s, default_step, NULL);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool Uint64ListOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for Uint64List option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    show_integer_list_formats(name, error_message);
+    return false;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void Uint64ListOption::ShowValue(std::ostream &out)
+{
+    for (std::vector<uint64_t>::const_iterator it = value_list_.begin(); it != value_list_.end(); ++it)
+    {
+        if (it != value_list_.begin())
+        {
+            out << " ";
+        }
+        out << *it;
+    }
+}
+
+/**
+ * @brief
+ *   read which CPUs of the machine are online from /sys/devices/system/cpu/online
+ *
+ * @return std::vector<uint8_t> - 1 for each CPU that is online, sized for all the CPUs the machine can have
+ */
+static std::vector<uint8_t> read_online_cpus()
+{
+    std::vector<uint8_t> online;
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    online.assign((num_cpus < 1) ? 1 : num_cpus, 0);
+    std::vector<uint64_t> list;
+    FILE *file = fopen("/sys/devices/system/cpu/online", "r");
+    char line[4096];
+    if ((file != NULL) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        line[strcspn(line, "\n")] = 0;
+        parse_integer_list(line, 1, &list, true);
+    }
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    if (list.empty())
+    {
+        for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); cpu++)
+        {
+            list.push_back(cpu);
+        }
+    }
+    for (std::vector<uint64_t>::const_iterator it = list.begin(); it != list.end(); ++it)
+    {
+        if (*it < online.size())
+        {
+            online[*it] = 1;
+        }
+    }
+    return online;
+}
+
+/**
+ * @brief
+ *   which CPUs of the machine are online,... read the first time, which C++ makes thread safe.
+ *
+ * @return const std::vector<uint8_t> & - 1 for each CPU that is online, sized for all the CPUs the machine can have
+ */
+static const std::vector<uint8_t> &online_cpus()
+{
+    static const std::vector<uint8_t> online = read_online_cpus();
+    return online;
+}
+
+/**
+ * @brief
+ *   parse a set of CPUs, e.g. 0-7,16-23,32+8/2
+ *
+ * @param[in] s - CPU list
+ * @param[out] cpus - CPUs in the order given, without repeats, NULL to just check the list
+ * @param[out] bad_cpu - CPU that isn't online, UINT64_MAX if the list itself is bad
+ *
+ * @return bool - true if the list is valid and every CPU in it is online
+ */
+static bool parse_cpu_set(const char *s, std::vector<uint32_t> *cpus, uint64_t *bad_cpu)
+{
+    const std::vector<uint8_t> &online = online_cpus();
+    std::vector<uint64_t> list;
+    *bad_cpu = UINT64_MAX;
+    // a range past the last CPU is caught before it's expanded
+    uint64_t last_cpu = online.size() - 1;
+    if (!parse_integer_list(s, 1, &list, true, &last_cpu))
+    {
+        if (last_cpu != online.size() - 1)
+        {
+            *bad_cpu = last_cpu;
+        }
+        return false;
+    }
+    std::vector<uint8_t> seen(online.size(), 0);
+    for (std::vector<uint64_t>::const_iterator it = list.begin(); it != list.end(); ++it)
+    {
+        if ((*it >= online.size()) || !online[*it])
+        {
+            *bad_cpu = *it;
+            return false;
+        }
+        if ((cpus != NULL) && !seen[*it])
+        {
+            seen[*it] = 1;
+            cpus->push_back(*it);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   write a set of CPUs the way Linux does, e.g. 0-3,8
+ *
+ * @param[in] cpus - CPUs
+ * @param[out] out - output stream
+ */
+static void show_cpu_list(const std::vector<uint32_t> &cpus, std::ostream &out)
+{
+    for (size_t i = 0; i < cpus.size();)
+    {
+        size_t j = i + 1;
+        while ((j < cpus.size()) && (cpus[j] == cpus[j - 1] + 1))
+        {
+            j++;
+        }
+        out << ((i == 0) ? "" : ",") << cpus[i];
+        if (j - i > 1)
+        {
+            out << "-" << cpus[j - 1];
+        }
+        i = j;
+    }
+}
+
+/**
+ * @brief
+ *   make a cpu_set_t bitmap for some CPUs, sized for the machine
+ *
+ * @param[in] cpus - CPUs
+ * @param[out] mask - bitmap
+ */
+static void make_cpu_mask(const std::vector<uint32_t> &cpus, std::vector<unsigned long> &mask)
+{
+    const uint32_t bits = 8 * sizeof(unsigned long);
+    mask.assign((online_cpus().size() + bits - 1) / bits, 0);
+    for (std::vector<uint32_t>::const_iterator it = cpus.begin(); it != cpus.end(); ++it)
+    {
+        mask[*it / bits] |= 1ul << (*it % bits);
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] default_value - default set of CPUs, NULL or "" for all the online CPUs
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+CpuSetOption::CpuSetOption(const char *default_value, const char *_name, const char *_usage_message)
+    : CmdLineOption(_name, _usage_message), _default_value(default_value)
+{
+    this->type = CMD_LINE_OPTION_CPU_SET;
+    SetDefault();
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void CpuSetOption::Reset()
+{
+    CmdLineOption::Reset();
+    SetDefault();
+}
+
+/**
+ * @brief
+ *   set the CPUs to the default set,... all the online CPUs if there's no default, or it can't be used here.
+ */
+void CpuSetOption::SetDefault()
+{
+    uint64_t bad_cpu;
+    value_list_.clear();
+    if ((_default_value == NULL) || (_default_value[0] == 0) || !parse_cpu_set(_default_value, &value_list_, &bad_cpu))
+    {
+        value_list_.clear();
+        for (size_t cpu = 0; cpu < online_cpus().size(); cpu++)
+        {
+            if (online_cpus()[cpu])
+            {
+                value_list_.push_back(cpu);
+            }
+        }
+    }
+    make_cpu_mask(value_list_, mask_);
+}
+
+/**
+ * @brief
+ *   heap memory of the CPU list and mask
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t CpuSetOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(value_list_, unused) + vector_bytes(mask_, unused);
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - CPU list, e.g. 0-7,16-23
+ *
+ * @return bool - true if option was valid.
+ */
+bool CpuSetOption::ParseValue(const char *s)
+{
+    std::vector<uint32_t> cpus;
+    uint64_t bad_cpu;
+    if (!parse_cpu_set(s, &cpus, &bad_cpu))
+    {
+        return false;
+    }
+    value_list_.swap(cpus);
+    make_cpu_mask(value_list_, mask_);
+    return true;
+}
+
+/**
+ * @brief
+ *   check if a CPU list is valid without changing the option
+ *
+ * @param[in] s - CPU list
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool CpuSetOption::CheckValue(const char *s)
+{
+    uint64_t bad_cpu;
+    return parse_cpu_set(s, NULL, &bad_cpu);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool CpuSetOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    uint64_t bad_cpu;
+    parse_cpu_set(s, NULL, &bad_cpu);
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for CpuSet option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    if (bad_cpu != UINT64_MAX)
+    {
+        std::vector<uint32_t> online;
+        for (size_t cpu = 0; cpu < online_cpus().size(); cpu++)
+        {
+            if (online_cpus()[cpu])
+            {
+                online.push_back(cpu);
+            }
+        }
+        error_message << "cpu " << bad_cpu << " isn't online, the online cpus are ";
+        show_cpu_list(online, error_message);
+        error_message << "\n";
+        return false;
+    }
+    error_message << "cpu set formats are:\n";
+    error_message << "   a,b,c            e.g. " << name << "=0,2,4\n";
+    error_message << "   a-b or a..b      e.g. " << name << "=0-7\n";
+    error_message << "   start+count/skip e.g. " << name << "=32+8/2 (that's 32 34 .. 46)\n";
+    return false;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void CpuSetOption::ShowValue(std::ostream &out)
+{
+    show_cpu_list(value_list_, out);
+}
+
+/**
+ * @brief
+ *   the CPUs in the set
+ *
+ * @return const std::vector<uint32_t> & - CPUs, in the order given on the command line
+ */
+const std::vector<uint32_t> &CpuSetOption::Cpus() const
+{
+    return value_list_;
+}
+
+/**
+ * @brief
+ *   the set as a cpu_set_t bitmap, e.g. sched_setaffinity(0, sizeof(unsigned long) * mask.size(), mask.data())
+ *
+ * @return const std::vector<unsigned long> & - bitmap
+ */
+const std::vector<unsigned long> &CpuSetOption::Mask() const
+{
+    return mask_;
+}
+
+/**
+ * @brief
+ *   CPU for a worker thread,... threads are spread over the set round robin
+ *
+ * @param[in] thread - thread number, 0, 1, 2, ...
+ *
+ * @return uint32_t - CPU
+ */
+uint32_t CpuSetOption::CpuForThread(uint32_t thread) const
+{
+    return value_list_[thread % value_list_.size()];
+}
+
+/**
+ * @brief
+ *   pin the calling thread to its CPU from CpuForThread()
+ *
+ * @param[in] thread - thread number, 0, 1, 2, ...
+ *
+ * @return bool - true if the thread was pinned
+ */
+bool CpuSetOption::PinThread(uint32_t thread) const
+{
+    std::vector<uint32_t> cpu(1, CpuForThread(thread));
+    std::vector<unsigned long> mask;
+    make_cpu_mask(cpu, mask);
+#if defined(__linux__)
+    return sched_setaffinity(0, mask.size() * sizeof(unsigned long), (cpu_set_t *)mask.data()) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief
+ *   let the calling thread run on any CPU of the set
+ *
+ * @return bool - true if the thread's affinity was set
+ */
+bool CpuSetOption::PinToSet() const
+{
+#if defined(__linux__)
+    return sched_setaffinity(0, mask_.size() * sizeof(unsigned long), (const cpu_set_t *)mask_.data()) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+DoubleListOption::DoubleListOption(const char *_name, const char *_usage_message)
+    : CmdLineOption(_name, _usage_message)
+{
+    this->type = CMD_LINE_OPTION_DOUBLE_LIST;
+    this->is_list = true;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief end of list parsing
+ */
+void DoubleListOption::EndOfList()
+{
+}
+
+/**
+ * @brief
+ *   heap memory of the values
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t DoubleListOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(value_list_, unused);
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void DoubleListOption::Reset()
+{
+    CmdLineOption::Reset();
+    value_list_.clear();
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - list argument, e.g. 0.25,0.5,0.25
+ *
+ * @return bool - true if option was valid.
+ */
+bool DoubleListOption::ParseValue(const char *s)
+{
+    return parse_double_list(s, &value_list_);
+}
+
+/**
+ * @brief
+ *   check if a list argument is valid without changing the list
+ *
+ * @param[in] s - list argument
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool DoubleListOption::CheckValue(const char *s)
+{
+    return parse_double_list(s, NULL);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool DoubleListOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for DoubleList option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    error_message << "list format is a number or comma separated numbers, e.g. " << name << " 0.25,0.5,0.25\n";
+    return false;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void DoubleListOption::ShowValue(std::ostream &out)
+{
+    for (std::vector<double>::const_iterator it = value_list_.begin(); it != value_list_.end(); ++it)
+    {
+        if (it != value_list_.begin())
+        {
+            out << " ";
+        }
+        out << *it;
+    }
+}
+
+/**
+ * @brief
+ *   parse a 32 bit address, count, stride or mask
+ *
+ * @param[in] s - string to parse, decimal or 0x hex
+ * @param[out] temp - first character after the number
+ * @param[out] value - the number
+ *
+ * @return bool - true if there's a number and it fits in 32 bits
+ */
+static bool parse_addr_number(const char *s, char **temp, uint64_t *value)
+{
+    const char *digits = (strncmp(s, "0x", 2) == 0) ? s + 2 : s;
+    *value = parse_uint64(s, temp);
+    return (*temp != digits) && (*value <= 0xffffffff);
+}
+
+/**
+ * @brief
+ *   parse a register address and mask, e.g. 0x100:0xff, 0x100..0x10c:0xff or 0x100+4/0x10:0xff
+ *
+ *   addresses are 32 bits, a range can't be empty or backwards, and it can't expand to more than
+ *   max_list_expansion registers.
+ *
+ * @param[in] s - string to parse
+ * @param[in] step - distance between registers in a range if no stride is given
+ * @param[out] list - registers are appended to this list (NULL to just check the string)
+ *
+ * @return bool - true if the string was valid.
+ */
+static bool parse_addr_mask(const char *s, uint32_t step, std::vector<addr_and_mask_t> *list)
+{
+    char *temp;
+    uint64_t start;
+    if (!parse_addr_number(s, &temp, &start))
+    {
+        return false;
+    }
+    uint64_t end = start;
+    uint64_t stride = step;
+    if ((temp[0] == '.') && (temp[1] == '.'))
+    {
+        if (!parse_addr_number(temp + 2, &temp, &end) || (end < start))
+        {
+            return false;
+        }
+    }
+    else if (*temp == '+')
+    {
+        uint64_t count;
+        if (!parse_addr_number(temp + 1, &temp, &count) || (count == 0))
+        {
+            return false;
+        }
+        if ((*temp == '/') && !parse_addr_number(temp + 1, &temp, &stride))
+        {
+            return false;
+        }
+        // both are 32 bits, so this can't overflow
+        end = start + (count - 1) * stride;
+    }
+    uint64_t mask = 0xffffffff;
+    if ((*temp == ':') && !parse_addr_number(temp + 1, &temp, &mask))
+    {
+        return false;
+    }
+    if ((*temp != 0) || (stride == 0) || (end > 0xffffffff) || ((end - start) / stride >= max_list_expansion))
+    {
+        return false;
+    }
+    if (list != NULL)
+    {
+        for (uint64_t addr = start; addr <= end; addr += stride)
+        {
+            addr_and_mask_t addr_mask;
+            addr_mask.addr = addr;
+            addr_mask.mask = mask;
+            list->push_back(addr_mask);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   sort registers by address
+ */
+static bool addr_less(const addr_and_mask_t &a, const addr_and_mask_t &b)
+{
+    return a.addr < b.addr;
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ * @param[in] _default_step - distance between registers in a range
+ */
+AddrMaskOption::AddrMaskOption(const char *_name, const char *_usage_message, uint32_t _default_step)
+    : CmdLineOption(_name, _usage_message), default_step(_default_step)
+{
+    this->type = CMD_LINE_OPTION_ADDR_MASK;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void AddrMaskOption::Reset()
+{
+    CmdLineOption::Reset();
+    addr_mask_list_.clear();
+    batches_.clear();
+}
+
+/**
+ * @brief
+ *   sort the registers, merge registers with the same address, and find the batches of consecutive registers.
+ */
+void AddrMaskOption::Coalesce()
+{
+    std::stable_sort(addr_mask_list_.begin(), addr_mask_list_.end(), addr_less);
+    size_t n = 0;
+    for (size_t i = 0; i < addr_mask_list_.size(); i++)
+    {
+        if ((n > 0) && (addr_mask_list_[n - 1].addr == addr_mask_list_[i].addr))
+        {
+            addr_mask_list_[n - 1].mask |= addr_mask_list_[i].mask;
+        }
+        else
+        {
+            addr_mask_list_[n++] = addr_mask_list_[i];
+        }
+    }
+    addr_mask_list_.resize(n);
+
+    batches_.clear();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (batches_.empty() || (addr_mask_list_[i].addr != addr_mask_list_[i - 1].addr + default_step))
+        {
+            addr_mask_batch_t batch;
+            batch.first = i;
+            batch.count = 0;
+            batches_.push_back(batch);
+        }
+        batches_.back().count++;
+    }
+}
+
+/**
+ * @brief
+ *   end of list parsing
+ */
+void AddrMaskOption::EndOfList()
+{
+    Coalesce();
+}
+
+/**
+ * @brief
+ *   heap memory of the registers and batches
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t AddrMaskOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(addr_mask_list_, unused) + vector_bytes(batches_, unused);
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool AddrMaskOption::ParseValue(const char *s)
+{
+    if (!parse_addr_mask(s, default_step, NULL))
+    {
+        return false;
+    }
+    addr_mask_list_.clear();
+    parse_addr_mask(s, default_step, &addr_mask_list_);
+    Coalesce();
+    return true;
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool AddrMaskOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for AddrMask option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    error_message << "address formats are:\n";
+    error_message << "   addr                  e.g. 0xd00380\n";
+    error_message << "   addr:mask             e.g. 0xd00380:0xff\n";
+    error_message << "   start..end:mask       e.g. 0xd00380..0xd00388:0xff\n";
+    error_message << "   start+count/step:mask e.g. 0xd00380+2/0x20:0xff (that's 0xd00380 0xd003a0)\n";
+    return false;
+}
+
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool AddrMaskOption::CheckValue(const char *s)
+{
+    return parse_addr_mask(s, default_step, NULL);
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void AddrMaskOption::ShowValue(std::ostream &out)
+{
+    std::ios_base::fmtflags f(out.flags());
+    for (std::vector<addr_and_mask_t>::const_iterator it = addr_mask_list_.begin(); it != addr_mask_list_.end(); ++it)
+    {
+        if (it != addr_mask_list_.begin())
+        {
+            out << " ";
+        }
+        out << std::hex << "0x" << it->addr << ":0x" << it->mask;
+    }
+    out.flags(f);
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ * @param[in] _default_step - distance between registers in a range
+ */
+AddrMaskListOption::AddrMaskListOption(const char *_name, const char *_usage_message, uint32_t _default_step)
+    : AddrMaskOption(_name, _usage_message, _default_step)
+{
+    // the environment variable was already parsed (and coalesced) by the AddrMaskOption constructor
+    this->is_list = true;
+}
+
+/**
+ * @brief
+ *   parse the command line option,... registers are sorted and merged at the end of the list.
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool AddrMaskListOption::ParseValue(const char *s)
+{
+    return parse_addr_mask(s, default_step, &addr_mask_list_);
+}
+
+/**
+ * @brief
+ *   same as a StringList, but stop if you find another command line option.
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+OptionFreeStringListOption::OptionFreeStringListOption(const char *_name, const char *_usage_message)
+    : StringListOption(_name, _usage_message)
+{
+    this->is_option_free_list = true;
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+StringListOption::StringListOption(const char *_name, const char *_usage_message) : CmdLineOption(_name, _usage_message)
+{
+    this->type = CMD_LINE_OPTION_STRING_LIST;
+    this->is_list = true;
+    this->strings_count_ = SIZE_MAX;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief end of list parsing
+ */
+void StringListOption::EndOfList()
+{
+}
+
+/**
+ * @brief
+ *   heap memory of the string pointers (the strings belong to argv)
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t StringListOption::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(string_list_, unused) + vector_bytes(strings_, unused) + vector_bytes(lines_, unused);
+}
+
+/**
+ * @brief end of list parsing
+ */
+void StringListOption::Reset()
+{
+    CmdLineOption::Reset();
+    string_list_.clear();
+    file_.Unmap();
+    strings_.clear();
+    lines_.clear();
+    strings_count_ = SIZE_MAX;
+}
+
+/**
+ * @brief
+ *   take more strings from a file, one per line, for 'name:=@file'
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file was mapped
+ */
+bool StringListOption::MapFile(const char *path)
+{
+    strings_count_ = SIZE_MAX;
+    return file_.Map(path, 0);
+}
+
+/**
+ * @brief
+ *   check if MapFile() would work, without changing the option
+ *
+ * @param[in] path - file
+ *
+ * @return bool - true if the file can be used
+ */
+bool StringListOption::CheckFile(const char *path)
+{
+    return MappedList::Check(path, 0);
+}
+
+/**
+ * @brief
+ *   first string, of string_list_ and then the file,... the file's lines are found as they're reached.
+ *
+ * @return const_iterator - first string
+ */
+StringListOption::const_iterator StringListOption::begin() const
+{
+    return const_iterator(&string_list_, 0, &file_, file_.First());
+}
+
+/**
+ * @brief
+ *   end of the strings
+ *
+ * @return const_iterator - past the last string
+ */
+StringListOption::const_iterator StringListOption::end() const
+{
+    return const_iterator(&string_list_, string_list_.size(), &file_, file_.End());
+}
+
+/**
+ * @brief
+ *   all the strings in one array of 0 terminated strings, for code that can't use begin()/end() (e.g. the C API)
+ *
+ *   without a file that's string_list_.  with one, the file's lines are copied the first time (and again if
+ *   string_list_ has grown since).
+ *
+ * @return const std::vector<const char *> & - string_list_ and then the file's lines
+ */
+const std::vector<const char *> &StringListOption::Strings()
+{
+    if (file_.path == NULL)
+    {
+        return string_list_;
+    }
+    if (strings_count_ != string_list_.size())
+    {
+        std::vector<size_t> starts;
+        lines_.clear();
+        for (const char *pos = file_.First(); pos != file_.End(); pos = file_.Next(pos))
+        {
+            std::string_view line;
+            file_.Decode(pos, &line);
+            starts.push_back(lines_.size());
+            lines_.insert(lines_.end(), line.begin(), line.end());
+            lines_.push_back(0);
+        }
+        // lines_ won't move any more
+        strings_.assign(string_list_.begin(), string_list_.end());
+        for (std::vector<size_t>::const_iterator it = starts.begin(); it != starts.end(); ++it)
+        {
+            strings_.push_back(&lines_[*it]);
+        }
+        strings_count_ = string_list_.size();
+    }
+    return strings_;
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool StringListOption::ParseValue(const char *s)
+{
+    StringPool *pool = CmdLineOptions::GetInstance()->GetStringPool();
+    string_list_.push_back((pool != NULL) ? pool->Intern(s) : s);
+    return true;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void StringListOption::ShowValue(std::ostream &out)
+{
+    for (const_iterator it = begin(); it != end(); ++it)
+    {
+        if (it != begin())
+        {
+            out << " ";
+        }
+        out << *it;
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] default_value - default value if not specified on command line
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+DoubleOption::DoubleOption(double default_value, const char *_name, const char *_usage_message)
+    : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
+{
+    this->type = CMD_LINE_OPTION_DOUBLE;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void DoubleOption::Reset()
+{
+    is_set = false;
+    value = _default_value;
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool DoubleOption::ParseValue(const char *s)
+{
+    char *temp = NULL;
+    value = strtod(s, &temp);
+    if (*temp == '/')
+    {
+        temp++;
+        double denominator = strtod(temp, &temp);
+        double numerator = value;
+        value = numerator / denominator;
+        printf("setting %s to %g/%g = %g\n", name, numerator, denominator, value);
+    }
+
+    if (*temp != 0)
+    {
+        return false;
+    }
+    else
+    {
+        return true;
+    }
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool DoubleOption::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (ParseValue(s))
+        return true;
+    error_message << "error parsing '" << s << "'\n";
+    error_message << " for Double option '" << name << "'\n";
+    error_message << " option description: " << usage_message << "\n";
+    error_message << "double is parsed with strtod, or numerator/denominator\n";
+    error_message << "   " << name << "="
                   << "11/20\n";
     return false;
 }
 
 /**
  * @brief
- *   constructor
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool DoubleOption::CheckValue(const char *s)
+{
+    char *temp = NULL;
+    strtod(s, &temp);
+    if (*temp == '/')
+    {
+        temp++;
+        strtod(temp, &temp);
+    }
+    return *temp == 0;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void DoubleOption::ShowValue(std::ostream &out)
+{
+    out << value;
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] default_value - default value if not specified on command line
+ * @param[in] _name - option name
+ * @param[in] _usage_message - option usage message
+ */
+StringOption::StringOption(const char *default_value, const char *_name, const char *_usage_message)
+    : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
+{
+    this->type = CMD_LINE_OPTION_STRING;
+    SetFromEnvironmentVariable();
+}
+
+/**
+ * @brief
+ *   reset value to default
+ */
+void StringOption::Reset()
+{
+    is_set = false;
+    value = _default_value;
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - default value if not specified on command line
+ *
+ * @return bool - true if option was valid.
+ */
+bool StringOption::ParseValue(const char *s)
+{
+    StringPool *pool = CmdLineOptions::GetInstance()->GetStringPool();
+    value = (pool != NULL) ? pool->Intern(s) : s;
+    return true;
+}
+
+/**
+ * @brief
+ *   display the current value
+ *
+ * @param[out] out - output stream
+ */
+void StringOption::ShowValue(std::ostream &out)
+{
+    if (value != NULL)
+    {
+        out << value;
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - subcommand name, e.g. "run"
+ * @param[in] _usage_message - usage message for the subcommand
+ * @param[in] _options - options that can only be used with this subcommand
+ */
+Subcommand::Subcommand(const char *_name, const char *_usage_message,
+                       std::initializer_list<CmdLineOption *> _options)
+    : CmdLineOption(_name, _usage_message), options_(_options)
+{
+    this->type = CMD_LINE_OPTION_SUBCOMMAND;
+    this->is_bool = true;
+    CmdLineOptions::GetInstance()->DeferEnvironment(options_);
+}
+
+/**
+ * @brief
+ *   heap memory of the option list and lookup table
+ *
+ * @param[out] unused - bytes allocated but not in use
+ *
+ * @return size_t - bytes
+ */
+size_t Subcommand::MemoryBytes(size_t *unused)
+{
+    *unused = 0;
+    return vector_bytes(options_, unused) + vector_bytes(hash_table_, unused);
+}
+
+/**
+ * @brief
+ *   parse the command line option,... a subcommand doesn't take a value, and only one can be used.
+ *   like EnumOption, it explains what's wrong itself.
+ *
+ * @param[in] s - value string, must be empty
+ *
+ * @return bool - true if option was valid.
+ */
+bool Subcommand::ParseValue(const char *s)
+{
+    return ParseValueWithError(s, std::cout);
+}
+
+/**
+ * @brief
+ *   parse the command line option without printing anything
+ *
+ * @param[in] s - value string, must be empty
+ *
+ * @return bool - true if option was valid.
+ */
+bool Subcommand::TryParseValue(const char *s)
+{
+    return CheckValue(s);
+}
+
+/**
+ * @brief
+ *   Parse a command line option
+ *
+ * @param[in] s - command line argument string
+ * @param[in] error_message - error message
+ *
+ * @return bool - true if argument string is valid
+ */
+bool Subcommand::ParseValueWithError(const char *s, std::ostream &error_message)
+{
+    if (CheckValue(s))
+        return true;
+    Subcommand *selected = CmdLineOptions::GetInstance()->SelectedSubcommand();
+    if (*s != 0)
+    {
+        error_message << "subcommand '" << name << "' doesn't take a value\n";
+    }
+    else
+    {
+        error_message << "subcommand '" << name << "' can't be used with '" << selected->name << "'\n";
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   check if a string is a valid value without changing the option
+ *
+ * @param[in] s - command line argument string
+ *
+ * @return bool - true if ParseValue(s) would succeed
+ */
+bool Subcommand::CheckValue(const char *s)
+{
+    Subcommand *selected = CmdLineOptions::GetInstance()->SelectedSubcommand();
+    return (*s == 0) && ((selected == NULL) || (selected == this));
+}
+
+/**
+ * @brief
+ *   reset,... the options go back to just the global ones
+ */
+void Subcommand::Reset()
+{
+    is_set = false;
+    if (CmdLineOptions::GetInstance()->SelectedSubcommand() == this)
+    {
+        CmdLineOptions::GetInstance()->SelectSubcommand(NULL);
+    }
+}
+
+/**
+ * @brief
+ *   the subcommand was given,... its options can be used from now on.
+ */
+void Subcommand::OptionSet()
+{
+    CmdLineOptions::GetInstance()->SelectSubcommand(this);
+}
+
+/**
+ * @brief
+ *   constructor,... puts "<prefix>." in front of the name of each option (except OptionGroup's).
+ *
+ * @param[in] _prefix - namespace name, e.g. "dma" or "hw.dma"
+ * @param[in] _options - options in the namespace
+ */
+OptionNamespace::OptionNamespace(const char *_prefix, std::initializer_list<CmdLineOption *> _options)
+    : prefix(_prefix)
+{
+    // reserved up front, so the strings never move
+    names_.reserve(_options.size());
+    for (std::initializer_list<CmdLineOption *>::const_iterator it = _options.begin(); it != _options.end(); ++it)
+    {
+        if (*(*it)->name == 0)
+        {
+            continue;
+        }
+        names_.push_back(std::string(_prefix) + "." + (*it)->name);
+        CmdLineOptions::GetInstance()->RenameOption(*it, names_.back().c_str());
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _name - name of the option, usually "help"
+ * @param[in] _usage_message - usage message
+ */
+HelpOption::HelpOption(const char *_name, const char *_usage_message) : CmdLineOption(_name, _usage_message), value("")
+{
+    this->is_bool = true;
+}
+
+/**
+ * @brief
+ *   parse the command line option
+ *
+ * @param[in] s - namespace to show, e.g. "dma.*", or "" for every option
+ *
+ * @return bool - always true
+ */
+bool HelpOption::ParseValue(const char *s)
+{
+    value = s;
+    return true;
+}
+
+/**
+ * @brief
+ *   reset to default
+ */
+void HelpOption::Reset()
+{
+    CmdLineOption::Reset();
+    value = "";
+}
+
+/**
+ * @brief
+ *   show the usage message and exit
+ */
+void HelpOption::OptionSet()
+{
+    if (*value == 0)
+    {
+        CmdLineOptions::GetInstance()->ShowUsage(std::cout);
+    }
+    else
+    {
+        CmdLineOptions::GetInstance()->ShowNamespaceUsage(value, std::cout);
+    }
+    exit(0);
+}
+
+/**
+ * @brief
+ *   options in the order they go in the usage message
+ *
+ *   the global options come first (including the subcommands themselves), then a section for the selected
+ *   subcommand, or for every subcommand if none is selected.  each section starts with the Subcommand,
+ *   followed by its options.
+ *
+ * @param[out] lines - options
+ *
+ * @return size_t - number of global lines,... any Subcommand after that starts a section.
+ */
+size_t CmdLineOptions::UsageLines(std::vector<CmdLineOption *> &lines)
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    for (size_t i = 0; i < _option_list.size(); i++)
+    {
+        if (_option_subcommand[i] == 0)
+        {
+            lines.push_back(_option_list[i]);
+        }
+    }
+    size_t num_global = lines.size();
+    for (std::vector<Subcommand *>::const_iterator it = _subcommands.begin(); it != _subcommands.end(); ++it)
+    {
+        if ((_selected == NULL) || (_selected == *it))
+        {
+            lines.push_back(*it);
+            lines.insert(lines.end(), (*it)->options_.begin(), (*it)->options_.end());
+        }
+    }
+    return num_global;
+}
+
+/**
+ * @brief
+ *   display a usage message to stdout
+ */
+void CmdLineOptions::Usage()
+{
+    uint32_t max_len = 0;
+    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    {
+
+        CmdLineOption *option = *(it);
+        uint32_t len = strlen(option->name);
+        if (len > max_len)
+        {
+            max_len = len;
+        }
+    }
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            uint32_t len = strlen(table->options[i].name);
+            if (len > max_len)
+            {
+                max_len = len;
+            }
+        }
+    }
+    std::vector<CmdLineOption *> lines;
+    size_t num_global = UsageLines(lines);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        CmdLineOption *option = lines[i];
+        // the 'GroupOption' has no option name and just injects a left justified string into the usage message
+        if (*option->name == 0)
+        {
+            printf("%s\n", option->usage_message);
+        }
+        else if ((i >= num_global) && (option->type == CMD_LINE_OPTION_SUBCOMMAND))
+        {
+            // a subcommand starts its section
+            printf("\n%s options:\n", option->name);
+        }
+        else
+        {
+            // print option name left justified in the first column
+            printf("  %*s - %s\n", -max_len, option->name, option->usage_message);
+        }
+    }
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            printf("  %*s - %s\n", -max_len, table->options[i].name, table->options[i].usage_message);
+        }
+    }
+    exit(-1);
+}
+
+/**
+ * @brief
+ *   display a usage message to ostream
+ *
+ * @param[out] error_message - output stream to format error message.
+ */
+void CmdLineOptions::ShowUsage(std::ostream &error_message)
+{
+    std::ios_base::fmtflags f(error_message.flags());
+    uint32_t max_len = 0;
+    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    {
+
+        CmdLineOption *option = *(it);
+        uint32_t len = strlen(option->name);
+        if (len > max_len)
+        {
+            max_len = len;
+        }
+    }
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            uint32_t len = strlen(table->options[i].name);
+            if (len > max_len)
+            {
+                max_len = len;
+            }
+        }
+    }
+    std::vector<CmdLineOption *> lines;
+    size_t num_global = UsageLines(lines);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        CmdLineOption *option = lines[i];
+        if (*option->name == 0)
+        {
+            error_message << option->usage_message << "\n";
+        }
+        else if ((i >= num_global) && (option->type == CMD_LINE_OPTION_SUBCOMMAND))
+        {
+            error_message << "\n"
+                          << option->name << " options:\n";
+        }
+        else
+        {
+            // print option name left justified in the first column
+            error_message << "  " << std::left << std::setw(max_len) << option->name << " " << option->usage_message
+                          << "\n";
+        }
+    }
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            error_message << "  " << std::left << std::setw(max_len) << table->options[i].name << " "
+                          << table->options[i].usage_message << "\n";
+        }
+    }
+    error_message.flags(f);
+}
+
+/**
+ * @brief
+ *   reset the options that were touched since the last reset to default,... an opt in, faster Reset()
+ *
+ *   this costs time proportional to the number of options that were set, not the number of options, but it only
+ *   knows about the options the parsers (and SetOption()) changed.  code that changes option values directly must
+ *   call Touch() on them, or the next ResetTouched() leaves them as they are.  the observers of the options that
+ *   were reset are told.
+ */
+void CmdLineOptions::ResetTouched()
+{
+    for (std::vector<uint32_t>::const_iterator it = _touched.begin(); it != _touched.end(); ++it)
+    {
+        _option_list[*it]->Reset();
+        _is_set_bits[*it / 64] &= ~((uint64_t)1 << (*it % 64));
+        MarkChanged(*it);
+    }
+    _touched.clear();
+    for (std::vector<static_option_ref_t>::const_iterator it = _static_set.begin(); it != _static_set.end(); ++it)
+    {
+        it->table->Reset(it->index);
+    }
+    _static_set.clear();
+    if (++_epoch == 0)
+    {
+        // wrapped around,... forget all the old stamps
+        std::fill(_touched_epoch.begin(), _touched_epoch.end(), 0);
+        _epoch = 1;
+    }
+    // everything ParseString created goes in one operation
+    if (_arena != NULL)
+    {
+        _arena->release();
+    }
+    NotifyObservers();
+}
+
+/**
+ * @brief
+ *   reset every option to default, including options the program changed directly
+ *
+ *   this costs time proportional to the number of options,... a loop that parses line after line and only changes
+ *   the options through the parser can call ResetTouched() instead.  the observers of the options are told.
+ */
+void CmdLineOptions::Reset()
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    for (size_t i = 0; i < _option_list.size(); i++)
+    {
+        // options of a subcommand that was never selected still have their defaults
+        uint16_t subcommand = _option_subcommand[i];
+        if ((subcommand == 0) || !_subcommands[subcommand - 1]->hash_table_.empty())
+        {
+            _option_list[i]->Reset();
+            MarkChanged(i);
+        }
+    }
+    for (std::vector<uint64_t>::iterator it = _is_set_bits.begin(); it != _is_set_bits.end(); ++it)
+    {
+        *it = 0;
+    }
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            table->Reset(i);
+        }
+    }
+    _touched.clear();
+    _static_set.clear();
+    ResetTouched();
+}
+
+/**
+ * @brief
+ *   parse a space separated list of arguments as if they were specified as command line arguments
+ *
+ *   the copy of the string and the argv array come from the parse arena (see ParseMemory()),
+ *   string options point into it until the next Reset().
+ *
+ * @param[in] argv_string - space separated list of command line arguments
+ */
+void CmdLineOptions::ParseString(const char *argv_string)
+{
+    std::pmr::memory_resource *arena = ParseMemory();
+    size_t length = strlen(argv_string) + 1;
+    char *argv_str = (char *)arena->allocate(length, 1);
+    memcpy(argv_str, argv_string, length);
+    char *token;
+    std::pmr::vector<const char *> argv_vector(arena);
+    argv_vector.reserve(std::count(argv_str, argv_str + length, ' ') + 2);
+
+    /* get the first token */
+    token = strtok(argv_str, " ");
+
+    argv_vector.push_back("parse_string");
+
+    /* walk through other tokens */
+    while (token != NULL)
+    {
+        argv_vector.push_back(token);
+
+        token = strtok(NULL, " ");
+    }
+
+    /* parse options with created argc/argv */
+    CmdLineOptions::ParseOptions(argv_vector.size(), &(argv_vector[0]));
+}
+
+/**
+ * @brief
+ *   memory resource that passes everything to another one, and keeps count of the bytes it holds
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+  public:
+    CountingResource(std::pmr::memory_resource *upstream) : bytes(0), upstream_(upstream)
+    {
+    }
+    size_t bytes; ///< bytes allocated and not yet freed
+
+  private:
+    virtual void *do_allocate(size_t size, size_t alignment)
+    {
+        bytes += size;
+        return upstream_->allocate(size, alignment);
+    }
+    virtual void do_deallocate(void *p, size_t size, size_t alignment)
+    {
+        bytes -= size;
+        upstream_->deallocate(p, size, alignment);
+    }
+    virtual bool do_is_equal(const std::pmr::memory_resource &other) const noexcept
+    {
+        return this == &other;
+    }
+    std::pmr::memory_resource *upstream_; ///< where the memory comes from
+};
+
+/**
+ * @brief
+ *   set where the parse arena gets its memory from
+ *
+ *   e.g. a server parsing a request per connection can give each worker its own pool.
+ *   call this before parsing, or right after Reset(),... anything still in the arena is released.
+ *
+ * @param[in] resource - memory resource, NULL for std::pmr::get_default_resource()
+ */
+void CmdLineOptions::SetMemoryResource(std::pmr::memory_resource *resource)
+{
+    delete _arena;
+    _arena = NULL;
+    delete _arena_upstream;
+    _arena_upstream = NULL;
+    _upstream_resource = resource;
+}
+
+/**
+ * @brief
+ *   memory that lives until the next Reset()
+ *
+ *   ParseString() keeps its tokens here, and options that need to keep memory for a parse
+ *   (e.g. a custom option that copies its value) can allocate from it too,... nothing needs to be freed.
+ *
+ * @return std::pmr::memory_resource * - monotonic arena that Reset() releases in one operation
+ */
+std::pmr::memory_resource *CmdLineOptions::ParseMemory()
+{
+    if (_arena == NULL)
+    {
+        _arena_upstream =
+            new CountingResource(_upstream_resource != NULL ? _upstream_resource : std::pmr::get_default_resource());
+        _arena = new std::pmr::monotonic_buffer_resource(4096, _arena_upstream);
+    }
+    return _arena;
+}
+
+/**
+ * @brief
+ *   intern string option values from now on,... StringOption and StringListOption values point into the pool.
+ *
+ *   values parsed before aren't changed.  the pool must outlive its use, and NULL goes back to keeping the
+ *   pointers that were parsed.
+ *
+ * @param[in] pool - pool, or NULL
+ */
+void CmdLineOptions::SetStringPool(StringPool *pool)
+{
+    _string_pool = pool;
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] upstream - where the strings' memory comes from, NULL for std::pmr::get_default_resource()
+ */
+StringPool::StringPool(std::pmr::memory_resource *upstream)
+    : arena_(4096, (upstream != NULL) ? upstream : std::pmr::get_default_resource()), count_(0), bytes_(0)
+{
+}
+
+/**
+ * @brief
+ *   find a string in the table (the caller holds the lock)
+ *
+ * @param[in] s - string
+ * @param[in] length - length of the string
+ * @param[in] hash - hash of the string
+ *
+ * @return const char * - the pooled string, NULL if it isn't in the pool
+ */
+const char *StringPool::Lookup(const char *s, uint32_t length, uint32_t hash)
+{
+    if (table_.empty())
+    {
+        return NULL;
+    }
+    uint32_t mask = table_.size() - 1;
+    for (uint32_t slot = option_hash_slot(hash, 0) & mask; table_[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        if ((hashes_[slot] == hash) && (memcmp(table_[slot], s, length + 1) == 0))
+        {
+            return table_[slot];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief
+ *   double the size of the table (the caller holds the lock exclusively)
+ */
+void StringPool::Grow()
+{
+    std::vector<const char *> table(std::max<size_t>(table_.size() * 2, 64), NULL);
+    std::vector<uint32_t> hashes(table.size());
+    uint32_t mask = table.size() - 1;
+    for (size_t i = 0; i < table_.size(); i++)
+    {
+        if (table_[i] != NULL)
+        {
+            uint32_t slot = option_hash_slot(hashes_[i], 0) & mask;
+            while (table[slot] != NULL)
+            {
+                slot = (slot + 1) & mask;
+            }
+            table[slot] = table_[i];
+            hashes[slot] = hashes_[i];
+        }
+    }
+    table_.swap(table);
+    hashes_.swap(hashes);
+}
+
+/**
+ * @brief
+ *   get the pooled copy of a string, adding it if it isn't there yet
+ *
+ * @param[in] s - string
+ *
+ * @return const char * - the pooled string, the same pointer for every equal string until Release()
+ */
+const char *StringPool::Intern(const char *s)
+{
+    uint32_t length;
+    uint32_t hash = (uint32_t)option_name_hash(s, &length);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const char *pooled = Lookup(s, length, hash);
+        if (pooled != NULL)
+        {
+            return pooled;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // someone else may have added it while the lock was free
+    const char *pooled = Lookup(s, length, hash);
+    if (pooled != NULL)
+    {
+        return pooled;
+    }
+    if ((count_ + 1) * 2 > table_.size())
+    {
+        Grow();
+    }
+    char *copy = (char *)arena_.allocate(length + 1, 1);
+    memcpy(copy, s, length + 1);
+    uint32_t mask = table_.size() - 1;
+    uint32_t slot = option_hash_slot(hash, 0) & mask;
+    while (table_[slot] != NULL)
+    {
+        slot = (slot + 1) & mask;
+    }
+    table_[slot] = copy;
+    hashes_[slot] = hash;
+    count_++;
+    bytes_ += length + 1;
+    return copy;
+}
+
+/**
+ * @brief
+ *   get the pooled copy of a string without adding it
+ *
+ * @param[in] s - string
+ *
+ * @return const char * - the pooled string, NULL if it isn't in the pool
+ */
+const char *StringPool::Find(const char *s)
+{
+    uint32_t length;
+    uint32_t hash = (uint32_t)option_name_hash(s, &length);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return Lookup(s, length, hash);
+}
+
+/**
+ * @brief
+ *   free every string in one go,... pointers the pool returned are no good after this.
+ */
+void StringPool::Release()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    arena_.release();
+    std::fill(table_.begin(), table_.end(), (const char *)NULL);
+    count_ = 0;
+    bytes_ = 0;
+}
+
+/**
+ * @brief
+ *   number of strings in the pool
+ *
+ * @return size_t - number of distinct strings
+ */
+size_t StringPool::Count()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return count_;
+}
+
+/**
+ * @brief
+ *   memory used by the pool: its strings and its table
+ *
+ * @return size_t - bytes
+ */
+size_t StringPool::Bytes()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return bytes_ + table_.capacity() * sizeof(const char *) + hashes_.capacity() * sizeof(uint32_t);
+}
+
+/**
+ * @brief
+ *   look for the environment variable PROJECT_NAME_<option name>, or PROJECT_NAME_<OPTION NAME>,
+ *   with any '.' in the name changed to '_'
+ *
+ * @param[in] name - option name
+ * @param[out] env_name - name of the environment variable that was checked last
+ * @param[in] env_name_size - size of env_name
+ *
+ * @return const char * - value of the environment variable, NULL if neither is set
+ */
+static const char *getenv_option(const char *name, char *env_name, size_t env_name_size)
+{
+    snprintf(env_name, env_name_size, "PROJECT_NAME_%s", name);
+    // shells don't allow '.' in variable names, so "dma.queue_depth" is PROJECT_NAME_dma_queue_depth
+    for (char *s = env_name; *s != 0; s++)
+    {
+        if (*s == '.')
+        {
+            *s = '_';
+        }
+    }
+    char *env_value = getenv(env_name);
+    if (env_value == NULL)
+    {
+        // also look for the uppercase version of the option
+        for (char *s = env_name; *s != 0; s++)
+        {
+            if (islower(*s))
+            {
+                *s = toupper(*s);
+            }
+        }
+        env_value = getenv(env_name);
+    }
+    return env_value;
+}
+
+/**
+ * @brief
+ *   split a command line argument into the option name and value
+ *
+ * @param[in] s - command line argument, e.g. "--some_int=5"
+ * @param[out] token - option name with the leading '-' and '=value' removed
+ * @param[in] token_size - size of the token buffer
+ *
+ * @return const char * - value string after the '=', or the "" at the end of 's' if there is no '='
+ */
+const char *split_option_token(const char *s, char *token, size_t token_size)
+{
+    /* make the '-' optional */
+    if (s[0] == '-')
+    {
+        s++;
+        if (s[0] == '-')
+        {
+            s++;
+        }
+    }
+    strncpy(token, s, token_size - 1);
+    token[token_size - 1] = 0;
+    char *equals = strchr(token, '=');
+    if (equals == NULL)
+    {
+        // the empty string at the end of the argument, so the value is still inside it
+        return s + strlen(s);
+    }
+    *equals = 0;
+    equals++;
+    return &s[equals - token];
+}
+
+/**
+ * @brief
+ *   returns true if the string matches a valid command line option
+ *
+ * @param[in] s - string
+ * @return true if 's' matches a command line option, false otherwise.
+ */
+bool CmdLineOptions::MatchesAnOption(const char *s)
+{
+    char token[100];
+    split_option_token(s, token, sizeof(token));
+    uint32_t length;
+    uint64_t hash = option_name_hash(token, &length);
+    static_option_ref_t ref;
+    return FindStaticOption(token, length, hash, &ref) || (FindOption(token, length, hash) != NULL);
+}
+
+/**
+ * @brief
+ *   add an option to a lookup table (open addressing of index + 1, 0 is empty),... the first option with a name wins.
+ *
+ * @param[in,out] table - lookup table
+ * @param[in] i - index of the option
+ */
+void CmdLineOptions::InsertInTable(std::vector<uint32_t> &table, uint32_t i)
+{
+    size_t mask = table.size() - 1;
+    for (size_t slot = _name_hash[i] & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t entry = table[slot];
+        if (entry == 0)
+        {
+            table[slot] = i + 1;
+            return;
+        }
+        if ((_name_hash[entry - 1] == _name_hash[i]) && (_name_length[entry - 1] == _name_length[i]) &&
+            (strcmp(_option_list[entry - 1]->name, _option_list[i]->name) == 0))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief
+ *   size of a lookup table for some options,... at most half full
+ *
+ * @param[in] count - number of options
+ *
+ * @return size_t - number of slots, a power of 2
+ */
+static size_t lookup_table_size(size_t count)
+{
+    size_t table_size = 16;
+    while (table_size < 2 * count)
+    {
+        table_size *= 2;
+    }
+    return table_size;
+}
+
+/**
+ * @brief
+ *   note which newly registered options are subcommands, and rebuild the hash table.
+ *
+ *   derived classes set the type etc. after the CmdLineOption constructor has added the option,
+ *   so this is done the first time the registry is used rather than in AddOption().
+ *   that is also when the environment is checked for new global options that didn't check it when they were
+ *   constructed, so enumerations etc. are ready.
+ */
+void CmdLineOptions::SyncRegistry()
+{
+    size_t first_new = _synced_count;
+    for (size_t i = _synced_count; i < _option_list.size(); i++)
+    {
+        CmdLineOption *option = _option_list[i];
+        if (option->type == CMD_LINE_OPTION_SUBCOMMAND)
+        {
+            _subcommands.push_back((Subcommand *)option);
+        }
+    }
+    _synced_count = _option_list.size();
+
+    // an option can be constructed after the subcommand that lists it, so this is redone every time
+    _option_subcommand.assign(_option_list.size(), 0);
+    for (size_t s = 0; s < _subcommands.size(); s++)
+    {
+        const std::vector<CmdLineOption *> &options = _subcommands[s]->options_;
+        for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+        {
+            if (((*it)->index < _option_list.size()) && (_option_list[(*it)->index] == *it))
+            {
+                _option_subcommand[(*it)->index] = s + 1;
+            }
+        }
+    }
+
+    BuildLookupTables();
+
+    // options whose constructor didn't check the environment,... SetFromEnvironmentVariable() skips the others,
+    // and options of subcommands that aren't selected
+    for (size_t i = first_new; i < _option_list.size(); i++)
+    {
+        CmdLineOption *option = _option_list[i];
+        if (_env_checked[i] == 2)
+        {
+            // set while it was constructed, and not by a subcommand's option after all
+            char env_name[100];
+            const char *env_value = getenv_option(option->name, env_name, sizeof(env_name));
+            printf("setting %s to \"%s\" (from environment variable %s)\n", option->name,
+                   (env_value != NULL) ? env_value : "", env_name);
+            _env_checked[i] = 1;
+        }
+        option->SetFromEnvironmentVariable();
+    }
+}
+
+/**
+ * @brief
+ *   get the registry ready now, rather than the first time it's used
+ *
+ *   this is what the first lookup or parse does anyway (see SyncRegistry()).  after it, looking options up
+ *   doesn't change anything in the registry (until more options are registered), so other threads can do it.
+ */
+void CmdLineOptions::Prepare()
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+}
+
+/**
+ * @brief
+ *   rebuild the hash table of the global options, and the tables of the subcommands that have been selected
+ */
+void CmdLineOptions::BuildLookupTables()
+{
+    size_t num_global = std::count(_option_subcommand.begin(), _option_subcommand.end(), 0);
+    _hash_table.assign(lookup_table_size(num_global), 0);
+    for (uint32_t i = 0; i < _option_subcommand.size(); i++)
+    {
+        if (_option_subcommand[i] == 0)
+        {
+            InsertInTable(_hash_table, i);
+        }
+    }
+    // subcommands that have been selected keep their table, with any late options added
+    for (std::vector<Subcommand *>::const_iterator it = _subcommands.begin(); it != _subcommands.end(); ++it)
+    {
+        if (!(*it)->hash_table_.empty())
+        {
+            BuildSubcommandTable(*it);
+        }
+    }
+}
+
+/**
+ * @brief
+ *   change the name of an option that has already been registered (see OptionNamespace)
+ *
+ * @param[in] option - option
+ * @param[in] name - new name, must stay valid as long as the option
+ */
+void CmdLineOptions::RenameOption(CmdLineOption *option, const char *name)
+{
+    option->name = name;
+    if ((option->index >= _option_list.size()) || (_option_list[option->index] != option))
+    {
+        return;
+    }
+    uint32_t length;
+    _name_hash[option->index] = (uint32_t)option_name_hash(name, &length);
+    _name_length[option->index] = length;
+    // the sorted index and namespaces are rebuilt when they're next needed
+    _sorted_index.clear();
+    if (option->index < _synced_count)
+    {
+        BuildLookupTables();
+    }
+    // the environment variable of the new name is the one that counts
+    if (_env_checked[option->index] == 2)
+    {
+        ResetOption(option);
+    }
+    if (_env_checked[option->index] != 0)
+    {
+        _env_checked[option->index] = 0;
+        option->SetFromEnvironmentVariable();
+    }
+}
+
+/**
+ * @brief
+ *   build the lookup table of a subcommand's options
+ *
+ * @param[in] subcommand - subcommand
+ */
+void CmdLineOptions::BuildSubcommandTable(Subcommand *subcommand)
+{
+    const std::vector<CmdLineOption *> &options = subcommand->options_;
+    subcommand->hash_table_.assign(lookup_table_size(options.size()), 0);
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        if (((*it)->index < _synced_count) && (_option_list[(*it)->index] == *it))
+        {
+            InsertInTable(subcommand->hash_table_, (*it)->index);
+        }
+    }
+}
+
+/**
+ * @brief
+ *   select the subcommand whose options can be used,... its lookup table is built (and the environment checked
+ *   for its options) the first time.
+ *
+ * @param[in] subcommand - subcommand, or NULL for just the global options
+ */
+void CmdLineOptions::SelectSubcommand(Subcommand *subcommand)
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    _selected = subcommand;
+    if ((subcommand == NULL) || !subcommand->hash_table_.empty())
+    {
+        return;
+    }
+    BuildSubcommandTable(subcommand);
+    const std::vector<CmdLineOption *> &options = subcommand->options_;
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        (*it)->SetFromEnvironmentVariable();
+    }
+}
+
+/**
+ * @brief
+ *   should an option read its environment variable now,... once, unless it's an option of a subcommand that
+ *   isn't selected.
+ *
+ *   before the registry is first used, the subcommands aren't known yet, so an option only waits if a
+ *   Subcommand that was constructed before it lists it (see DeferEnvironment()).
+ *
+ * @param[in] option - option
+ *
+ * @return bool - true if the caller should check the environment (it won't be asked again)
+ */
+bool CmdLineOptions::EnvironmentDue(const CmdLineOption *option)
+{
+    uint32_t index = option->index;
+    if ((index >= _option_list.size()) || (_option_list[index] != option) || _env_checked[index])
+    {
+        return false;
+    }
+    if ((index < _synced_count) ? !IsActive(option)
+                                : (std::find(_env_waiting.begin(), _env_waiting.end(), option) != _env_waiting.end()))
+    {
+        return false;
+    }
+    _env_checked[index] = 1;
+    return true;
+}
+
+/**
+ * @brief
+ *   a subcommand was constructed,... its options wait for it to be selected before reading the environment.
+ *
+ *   options constructed before it that were set from the environment go back to their defaults.
+ *
+ * @param[in] options - options of the subcommand
+ */
+void CmdLineOptions::DeferEnvironment(const std::vector<CmdLineOption *> &options)
+{
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        uint32_t index = (*it)->index;
+        if ((index >= _option_list.size()) || (_option_list[index] != *it))
+        {
+            _env_waiting.push_back(*it);
+            continue;
+        }
+        if (_env_checked[index] == 2)
+        {
+            ResetOption(*it);
+        }
+        _env_checked[index] = 0;
+    }
+}
+
+/**
+ * @brief
+ *   an option was set from the environment,... until the registry is first used, it may still turn out to be
+ *   an option of a subcommand, so SyncRegistry() says so rather than the option.
+ *
+ * @param[in] option - option
+ *
+ * @return bool - true if the registry will show the message
+ */
+bool CmdLineOptions::HoldEnvironmentMessage(const CmdLineOption *option)
+{
+    if (option->index < _synced_count)
+    {
+        return false;
+    }
+    _env_checked[option->index] = 2;
+    return true;
+}
+
+/**
+ * @brief
+ *   check if an option can be used now,... it's registered and global or in the selected subcommand.
+ *
+ * @param[in] option - option
+ *
+ * @return true if the option is active
+ */
+bool CmdLineOptions::IsActive(const CmdLineOption *option)
+{
+    if ((option->index >= _synced_count) || (_option_list[option->index] != option))
+    {
+        return false;
+    }
+    uint16_t subcommand = _option_subcommand[option->index];
+    return (subcommand == 0) || (_subcommands[subcommand - 1] == _selected);
+}
+
+/**
+ * @brief
+ *   find an option by name
+ *
+ * @param[in] name - option name (without leading '-' or '=value')
+ * @return CmdLineOption * - the first option with that name, or NULL
+ */
+CmdLineOption *CmdLineOptions::FindOption(const char *name)
+{
+    uint32_t length;
+    uint64_t hash = option_name_hash(name, &length);
+    return FindOption(name, length, hash);
+}
+
+/**
+ * @brief
+ *   find an option among the global options and the options of a subcommand, whichever one is selected.
+ *
+ *   nothing in the registry changes (once it's synced, by Prepare() or the first call), so several threads can
+ *   look up options while another one parses.  the subcommand's options are searched one by one, its lookup table
+ *   may not be built yet.
+ *
+ * @param[in] name - option name (without leading '-' or '=value')
+ * @param[in] subcommand - subcommand whose options can be found too, or NULL
+ * @return CmdLineOption * - the first option with that name, or NULL
+ */
+CmdLineOption *CmdLineOptions::FindOption(const char *name, const Subcommand *subcommand)
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    uint32_t length;
+    uint64_t hash = option_name_hash(name, &length);
+    CmdLineOption *option = FindInTable(_hash_table, name, length, (uint32_t)hash);
+    if ((option != NULL) || (subcommand == NULL))
+    {
+        return option;
+    }
+    const std::vector<CmdLineOption *> &options = subcommand->options_;
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        if (((*it)->index < _synced_count) && (_name_hash[(*it)->index] == (uint32_t)hash) &&
+            (strcmp((*it)->name, name) == 0))
+        {
+            return *it;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief
+ *   find an option by name, when the name has already been hashed
+ *
+ *   the global options are searched first, then the options of the selected subcommand.
+ *
+ * @param[in] name - option name
+ * @param[in] length - length of the name
+ * @param[in] name_hash - option_name_hash() of the name
+ * @return CmdLineOption * - the first option with that name, or NULL
+ */
+CmdLineOption *CmdLineOptions::FindOption(const char *name, uint32_t length, uint64_t name_hash)
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    CmdLineOption *option = FindInTable(_hash_table, name, length, (uint32_t)name_hash);
+    if ((option == NULL) && (_selected != NULL))
+    {
+        option = FindInTable(_selected->hash_table_, name, length, (uint32_t)name_hash);
+    }
+    return option;
+}
+
+/**
+ * @brief
+ *   find an option in a lookup table
+ *
+ * @param[in] table - lookup table
+ * @param[in] name - option name
+ * @param[in] length - length of the name
+ * @param[in] hash - low 32 bits of option_name_hash() of the name
+ * @return CmdLineOption * - the option, or NULL
+ */
+CmdLineOption *CmdLineOptions::FindInTable(const std::vector<uint32_t> &table, const char *name, uint32_t length,
+                                           uint32_t hash)
+{
+    size_t mask = table.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        uint32_t entry = table[slot];
+        if (entry == 0)
+        {
+            return NULL;
+        }
+        uint32_t i = entry - 1;
+        // only touch the option object once the hash and length match
+        if ((_name_hash[i] == hash) && (_name_length[i] == length) && (memcmp(_option_list[i]->name, name, length) == 0))
+        {
+            return _option_list[i];
+        }
+    }
+}
+
+/**
+ * @brief
+ *   call the option's OptionSet() method and mark it as set
+ *
+ * @param[in] option - option that was set
+ */
+void CmdLineOptions::SetOption(CmdLineOption *option)
+{
+    option->OptionSet();
+    option->is_set = true;
+    _is_set_bits[option->index / 64] |= (uint64_t)1 << (option->index % 64);
+    Touch(option);
+    MarkChanged(option->index);
+}
+
+/**
+ * @brief
+ *   add an option to the batch NotifyObservers() hands out (once per batch),... nothing to do without observers.
+ *
+ * @param[in] index - index of the option
+ */
+void CmdLineOptions::MarkChanged(uint32_t index)
+{
+    if (!_observers.empty() && (_changed_batch[index] != _batch))
+    {
+        _changed_batch[index] = _batch;
+        _changed.push_back(index);
+    }
+}
+
+/**
+ * @brief
+ *   note that an option may have changed, so the next ResetTouched() resets it
+ *
+ *   the parsers call this before they start changing an option,... a list may be half parsed when an error is found.
+ *
+ * @param[in] option - option
+ */
+void CmdLineOptions::Touch(CmdLineOption *option)
+{
+    if (_touched_epoch[option->index] != _epoch)
+    {
+        _touched_epoch[option->index] = _epoch;
+        _touched.push_back(option->index);
+    }
+}
+
+/**
+ * @brief
+ *   put an option back to its default and mark it as not set,... for parsers that undo one option at a time.
+ *
+ * @param[in] option - option
+ */
+void CmdLineOptions::ResetOption(CmdLineOption *option)
+{
+    option->Reset();
+    _is_set_bits[option->index / 64] &= ~((uint64_t)1 << (option->index % 64));
+    MarkChanged(option->index);
+}
+
+/**
+ * @brief
+ *   memory used by the registry itself (not the options),... every table it keeps, in the order they're declared
+ *
+ * @return size_t - bytes
+ */
+size_t CmdLineOptions::RegistryBytes()
+{
+    size_t unused = 0;
+    return vector_bytes(_option_list, &unused) + vector_bytes(_sorted_index, &unused) +
+           vector_bytes(_namespace_nodes, &unused) + vector_bytes(_static_set, &unused) +
+           vector_bytes(_name_hash, &unused) + vector_bytes(_name_length, &unused) +
+           vector_bytes(_is_set_bits, &unused) + vector_bytes(_hash_table, &unused) +
+           vector_bytes(_subcommands, &unused) + vector_bytes(_option_subcommand, &unused) +
+           vector_bytes(_env_checked, &unused) + vector_bytes(_env_waiting, &unused) +
+           vector_bytes(_touched_epoch, &unused) + vector_bytes(_touched, &unused) +
+           vector_bytes(_constraints, &unused) + vector_bytes(_constraint_first_term, &unused) +
+           vector_bytes(_constraint_trigger, &unused) + vector_bytes(_constraint_size, &unused) +
+           vector_bytes(_term_word, &unused) + vector_bytes(_term_bits, &unused) + vector_bytes(_observers, &unused) +
+           vector_bytes(_observer_first, &unused) + vector_bytes(_observer_list, &unused) +
+           vector_bytes(_changed_batch, &unused) + vector_bytes(_changed, &unused);
+}
+
+/**
+ * @brief
+ *   add up the memory used by the options and the registry,... each option reports its own, nothing walks the heap.
+ *
+ * @param[out] usage - memory used
+ */
+void CmdLineOptions::MemoryUsage(memory_usage_t *usage)
+{
+    usage->registry = RegistryBytes();
+    usage->options = 0;
+    usage->unused = 0;
+    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    {
+        size_t unused;
+        usage->options += (*it)->MemoryBytes(&unused);
+        usage->unused += unused;
+    }
+    usage->parse_memory = (_arena_upstream != NULL) ? _arena_upstream->bytes : 0;
+    usage->string_pool = (_string_pool != NULL) ? _string_pool->Bytes() : 0;
+    usage->total = usage->registry + usage->options + usage->parse_memory + usage->string_pool;
+}
+
+/**
+ * @brief
+ *   write the memory used, one record per line: the totals, then each option that holds memory
+ *
+ *     memory registry=... options=... unused=... parse_memory=... string_pool=... total=...
+ *     option name=channels: bytes=4096 unused=3968 mostly_unused
+ *
+ *   options with at least unused_threshold bytes allocated but not in use, and more unused than used,
+ *   are marked mostly_unused (e.g. a list that was long once, and is short now).
+ *
+ * @param[out] out - where to write the report
+ * @param[in] unused_threshold - bytes of unused capacity that get an option marked
+ */
+void CmdLineOptions::MemoryReport(std::ostream &out, size_t unused_threshold)
+{
+    memory_usage_t usage;
+    MemoryUsage(&usage);
+    out << "memory registry=" << usage.registry << " options=" << usage.options << " unused=" << usage.unused
+        << " parse_memory=" << usage.parse_memory << " string_pool=" << usage.string_pool << " total=" << usage.total
+        << "\n";
+    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    {
+        size_t unused;
+        size_t bytes = (*it)->MemoryBytes(&unused);
+        if (bytes == 0)
+        {
+            continue;
+        }
+        out << "option name=" << (*it)->name << " bytes=" << bytes << " unused=" << unused;
+        if ((unused >= unused_threshold) && (unused * 2 > bytes))
+        {
+            out << " mostly_unused";
+        }
+        out << "\n";
+    }
+}
+
+/**
+ * @brief
+ *   find an option in a static table
+ *
+ * @param[in] name - option name
+ * @param[in] length - length of the name
+ * @param[in] hash - option_name_hash() of the name
+ *
+ * @return int32_t - index of the option, -1 if it isn't in this table
+ */
+int32_t StaticOptionTable::Find(const char *name, uint32_t length, uint64_t hash) const
+{
+    int32_t d = displacement[option_hash_slot(hash, 0) & mask];
+    if (d == 0)
+    {
+        return -1;
+    }
+    uint32_t slot = (d < 0) ? (uint32_t)(-d - 1) : option_hash_slot(hash, d) & mask;
+    // a perfect hash only has one place to look, but a name that isn't in the table can land there too
+    if ((slots[slot].hash != (uint32_t)hash) || (slots[slot].option == UINT32_MAX))
+    {
+        return -1;
+    }
+    const char *option_name = options[slots[slot].option].name;
+    if ((memcmp(option_name, name, length) != 0) || (option_name[length] != 0))
+    {
+        return -1;
+    }
+    return slots[slot].option;
+}
+
+/**
+ * @brief
+ *   parse the value of a static option
+ *
+ * @param[in] type - type of the option
+ * @param[in] s - value string
+ * @param[out] value - value, only changed if the string is valid
+ *
+ * @return bool - true if the string is valid
+ */
+static bool parse_static_value(cmd_line_option_type_t type, const char *s, void *value)
+{
+    char *temp = NULL;
+    switch (type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        return parse_bool(s, (bool *)value);
+    case CMD_LINE_OPTION_INT: {
+        int32_t x = parse_int(s, &temp);
+        if (*temp != 0)
+            return false;
+        *(int32_t *)value = x;
+        return true;
+    }
+    case CMD_LINE_OPTION_UINT: {
+        uint32_t x = parse_uint(s, &temp);
+        if (*temp != 0)
+            return false;
+        *(uint32_t *)value = x;
+        return true;
+    }
+    case CMD_LINE_OPTION_INT64: {
+        int64_t x = parse_int64(s, &temp);
+        if (*temp != 0)
+            return false;
+        *(int64_t *)value = x;
+        return true;
+    }
+    case CMD_LINE_OPTION_UINT64: {
+        uint64_t x = parse_uint64(s, &temp);
+        if (*temp != 0)
+            return false;
+        *(uint64_t *)value = x;
+        return true;
+    }
+    case CMD_LINE_OPTION_DOUBLE: {
+        // same as DoubleOption, numerator/denominator is allowed
+        double x = strtod(s, &temp);
+        if (*temp == '/')
+        {
+            temp++;
+            x /= strtod(temp, &temp);
+        }
+        if (*temp != 0)
+            return false;
+        *(double *)value = x;
+        return true;
+    }
+    case CMD_LINE_OPTION_STRING:
+        *(const char **)value = s;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief
+ *   parse the value of an option,... the value is only changed if the string is valid.
+ *
+ * @param[in] i - index of the option
+ * @param[in] s - value string
+ *
+ * @return bool - true if the string is valid
+ */
+bool StaticOptionTable::Parse(uint32_t i, const char *s)
+{
+    return parse_static_value(options[i].type, s, (uint8_t *)values + options[i].offset);
+}
+
+/**
+ * @brief
+ *   check if a value is valid without changing the option
+ *
+ * @param[in] i - index of the option
+ * @param[in] s - value string
+ *
+ * @return bool - true if Parse(i, s) would succeed
+ */
+bool StaticOptionTable::Check(uint32_t i, const char *s) const
+{
+    // big enough for any static option type
+    uint64_t scratch;
+    return parse_static_value(options[i].type, s, &scratch);
+}
+
+/**
+ * @brief
+ *   size of the value of a static option
+ *
+ * @param[in] type - option type
+ *
+ * @return size_t - size in bytes
+ */
+static size_t static_option_size(cmd_line_option_type_t type)
+{
+    switch (type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        return sizeof(bool);
+    case CMD_LINE_OPTION_INT:
+    case CMD_LINE_OPTION_UINT:
+        return sizeof(uint32_t);
+    case CMD_LINE_OPTION_INT64:
+    case CMD_LINE_OPTION_UINT64:
+        return sizeof(uint64_t);
+    case CMD_LINE_OPTION_DOUBLE:
+        return sizeof(double);
+    case CMD_LINE_OPTION_STRING:
+        return sizeof(const char *);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief
+ *   name of the type of a static option, for error messages
+ *
+ * @param[in] type - option type
+ *
+ * @return const char * - type name
+ */
+static const char *static_option_type_name(cmd_line_option_type_t type)
+{
+    switch (type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        return "bool";
+    case CMD_LINE_OPTION_INT:
+        return "int";
+    case CMD_LINE_OPTION_UINT:
+        return "uint";
+    case CMD_LINE_OPTION_INT64:
+        return "int64";
+    case CMD_LINE_OPTION_UINT64:
+        return "uint64";
+    case CMD_LINE_OPTION_DOUBLE:
+        return "Double";
+    case CMD_LINE_OPTION_STRING:
+        return "string";
+    default:
+        return "";
+    }
+}
+
+/**
+ * @brief
+ *   reset an option to its default value
+ *
+ * @param[in] i - index of the option
+ */
+void StaticOptionTable::Reset(uint32_t i)
+{
+    uint32_t offset = options[i].offset;
+    memcpy((uint8_t *)values + offset, (const uint8_t *)defaults + offset, static_option_size(options[i].type));
+    is_set[i] = 0;
+}
+
+/**
+ * @brief
+ *   add a table of options that was built at compile time
+ *
+ *   static options are looked up before the options that registered themselves,
+ *   and like them can be set from an environment variable.
+ *
+ * @param[in] table - table, e.g. my_options_table from CMD_LINE_STATIC_OPTIONS(my_options, ...)
+ */
+void CmdLineOptions::AddStaticOptions(StaticOptionTable *table)
+{
+    StaticOptionTable **last = &_static_tables;
+    while (*last != NULL)
+    {
+        if (*last == table)
+        {
+            return;
+        }
+        last = &(*last)->next;
+    }
+    table->next = NULL;
+    *last = table;
+    for (uint32_t i = 0; i < table->count; i++)
+    {
+        char env_name[100];
+        const char *env_value = getenv_option(table->options[i].name, env_name, sizeof(env_name));
+        if (env_value != NULL)
+        {
+            printf("setting %s to \"%s\" (from environment variable %s)\n", table->options[i].name, env_value,
+                   env_name);
+            static_option_ref_t ref = {table, i};
+            if (!SetStaticOption(ref, env_value))
+            {
+                printf("error parsing '%s'\n", env_value);
+                Usage();
+            }
+        }
+    }
+}
+
+#if defined(__ELF__)
+// bounds of the "cmd_line_options" section, defined by the linker if any table was registered (NULL if not)
+extern StaticOptionTable *const __start_cmd_line_options[] __attribute__((weak));
+extern StaticOptionTable *const __stop_cmd_line_options[] __attribute__((weak));
+#endif
+
+/**
+ * @brief
+ *   compare static option tables by name
+ *
+ * @param[in] a - table
+ * @param[in] b - table
+ *
+ * @return true if a comes before b
+ */
+static bool table_name_less(const StaticOptionTable *a, const StaticOptionTable *b)
+{
+    return strcmp(a->name, b->name) < 0;
+}
+
+/**
+ * @brief
+ *   add the tables registered with CMD_LINE_STATIC_OPTIONS_REGISTER(),... called once, when the registry is created.
+ *
+ *   the linker puts the section entries in link order, so they are sorted by name to make the usage message
+ *   and which table wins a duplicate name the same for every link.
+ */
+void CmdLineOptions::AddSectionTables()
+{
+#if defined(__ELF__)
+    if (__start_cmd_line_options == NULL)
+    {
+        return;
+    }
+    std::vector<StaticOptionTable *> tables(__start_cmd_line_options, __stop_cmd_line_options);
+    std::sort(tables.begin(), tables.end(), table_name_less);
+    for (std::vector<StaticOptionTable *>::const_iterator it = tables.begin(); it != tables.end(); ++it)
+    {
+        AddStaticOptions(*it);
+    }
+#endif
+}
+
+/**
+ * @brief
+ *   find an option in the static tables
+ *
+ * @param[in] name - option name (without leading '-' or '=value')
+ * @param[out] ref - the option
+ *
+ * @return true if the option was found
+ */
+bool CmdLineOptions::FindStaticOption(const char *name, static_option_ref_t *ref)
+{
+    uint32_t length;
+    uint64_t hash = option_name_hash(name, &length);
+    return FindStaticOption(name, length, hash, ref);
+}
+
+/**
+ * @brief
+ *   find an option in the static tables, when the name has already been hashed
+ *
+ * @param[in] name - option name
+ * @param[in] length - length of the name
+ * @param[in] hash - option_name_hash() of the name
+ * @param[out] ref - the option
+ *
+ * @return true if the option was found
+ */
+bool CmdLineOptions::FindStaticOption(const char *name, uint32_t length, uint64_t hash, static_option_ref_t *ref)
+{
+    for (StaticOptionTable *table = _static_tables; table != NULL; table = table->next)
+    {
+        int32_t i = table->Find(name, length, hash);
+        if (i >= 0)
+        {
+            ref->table = table;
+            ref->index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   parse the value of a static option and mark it as set
+ *
+ * @param[in] ref - option
+ * @param[in] s - value string
+ *
+ * @return true if the value was valid
+ */
+bool CmdLineOptions::SetStaticOption(const static_option_ref_t &ref, const char *s)
+{
+    if (!ref.table->Parse(ref.index, s))
+    {
+        return false;
+    }
+    if (!ref.table->is_set[ref.index])
+    {
+        ref.table->is_set[ref.index] = 1;
+        _static_set.push_back(ref);
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   put a static option back to its default and mark it as not set
+ *
+ * @param[in] ref - option
+ */
+void CmdLineOptions::ResetStaticOption(const static_option_ref_t &ref)
+{
+    ref.table->Reset(ref.index);
+    for (std::vector<static_option_ref_t>::iterator it = _static_set.begin(); it != _static_set.end(); ++it)
+    {
+        if ((it->table == ref.table) && (it->index == ref.index))
+        {
+            *it = _static_set.back();
+            _static_set.pop_back();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief
+ *   write the error message for a bad static option value
+ *
+ * @param[in] arg - the argument
+ * @param[in] offset - offset of the value in the argument
+ * @param[out] error_message - error message
+ */
+void CmdLineOptions::ShowStaticError(const char *arg, uint32_t offset, std::ostream &error_message)
+{
+    char token[100];
+    split_option_token(arg, token, sizeof(token));
+    static_option_ref_t ref;
+    if (FindStaticOption(token, &ref))
+    {
+        const static_option_t &option = ref.table->options[ref.index];
+        error_message << "error parsing '" << arg + offset << "'\n";
+        error_message << " for " << static_option_type_name(option.type) << " option '" << option.name << "'\n";
+        error_message << " option description: " << option.usage_message << "\n";
+    }
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _kind - kind of relation
+ * @param[in] _options - options in the relation (for OPTION_REQUIRES, the first option requires the others)
+ * @param[in] _count - limit for OPTION_AT_MOST
+ */
+OptionConstraint::OptionConstraint(option_constraint_t _kind, std::initializer_list<CmdLineOption *> _options,
+                                   uint32_t _count)
+    : kind(_kind), options_(_options), count(_count)
+{
+    // add this constraint to the global list of constraints.
+    CmdLineOptions::GetInstance()->AddConstraint(this);
+}
+
+/**
+ * @brief
+ *   add a constraint to the global list of constraints
+ *
+ * @param[in] constraint - constraint to add
+ */
+void CmdLineOptions::AddConstraint(OptionConstraint *constraint)
+{
+    _constraints.push_back(constraint);
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _options - options to watch
+ */
+OptionObserver::OptionObserver(std::initializer_list<CmdLineOption *> _options)
+    : options_(_options), generation_(0), waiters_(0)
+{
+    // add this observer to the global list of observers.
+    CmdLineOptions::GetInstance()->AddObserver(this);
+}
+
+OptionObserver::~OptionObserver()
+{
+    CmdLineOptions::GetInstance()->RemoveObserver(this);
+}
+
+/**
+ * @brief
+ *   default changed method,... derived classes override it to react to a parse.
+ *
+ * @param[in] changed - watched options that were set, in the order they were set
+ */
+void OptionObserver::OptionsChanged(const std::vector<CmdLineOption *> &changed)
+{
+    (void)changed;
+}
+
+/**
+ * @brief
+ *   call OptionsChanged(), then bump the generation and wake the threads in Wait()
+ */
+void OptionObserver::Notify()
+{
+    // OptionsChanged() may parse again, which can notify this observer again
+    std::vector<CmdLineOption *> changed;
+    changed.swap(changed_);
+    OptionsChanged(changed);
+    // after OptionsChanged(), so what it works out is ready when the waiting threads wake
+    generation_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, (uint32_t *)&generation_, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+    }
+}
+
+/**
+ * @brief
+ *   sleep until the generation isn't 'generation' any more, i.e. until a watched option is set
+ *
+ * @param[in] generation - generation the caller has seen, from Generation() or the last Wait()
+ * @param[in] timeout_ms - give up after this many milliseconds, -1 to wait for ever
+ *
+ * @return uint32_t - the current generation, 'generation' if the wait timed out.
+ */
+uint32_t OptionObserver::Wait(uint32_t generation, int32_t timeout_ms)
+{
+    uint32_t current = Generation();
+    if (current != generation)
+    {
+        return current;
+    }
+    // Notify() bumps the generation then checks for waiters,... this counts the waiter then checks the
+    // generation, so at least one of them sees the other.
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+    // FUTEX_WAIT_BITSET takes an absolute time, so a spurious wake up doesn't restart the timeout
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout_ms > 0)
+    {
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+    while (((current = Generation()) == generation) && (timeout_ms != 0))
+    {
+        if ((syscall(SYS_futex, (uint32_t *)&generation_, FUTEX_WAIT_BITSET_PRIVATE, generation,
+                     (timeout_ms < 0) ? NULL : &deadline, NULL, FUTEX_BITSET_MATCH_ANY) != 0) &&
+            (errno == ETIMEDOUT))
+        {
+            current = Generation();
+            break;
+        }
+    }
+#else
+    // no futex,... check every millisecond
+    for (int32_t waited = 0; ((current = Generation()) == generation) && (timeout_ms < 0 || waited < timeout_ms);
+         waited++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#endif
+    waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    return current;
+}
+
+/**
+ * @brief
+ *   add an observer to the global list of observers
+ *
+ * @param[in] observer - observer to add
+ */
+void CmdLineOptions::AddObserver(OptionObserver *observer)
+{
+    _observers.push_back(observer);
+    _observer_first.clear();
+}
+
+/**
+ * @brief
+ *   remove an observer from the global list of observers
+ *
+ * @param[in] observer - observer to remove
+ */
+void CmdLineOptions::RemoveObserver(OptionObserver *observer)
+{
+    _observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+    _observer_first.clear();
+}
+
+/**
+ * @brief
+ *   build the list of observers of each option
+ *
+ *   this is redone when observers or options are added,... an option can be constructed after its observer.
+ */
+void CmdLineOptions::LinkObservers()
+{
+    _observer_first.assign(_option_list.size() + 1, 0);
+    for (std::vector<OptionObserver *>::const_iterator it = _observers.begin(); it != _observers.end(); ++it)
+    {
+        const std::vector<CmdLineOption *> &options = (*it)->options_;
+        for (std::vector<CmdLineOption *>::const_iterator o = options.begin(); o != options.end(); ++o)
+        {
+            if (((*o)->index < _option_list.size()) && (_option_list[(*o)->index] == *o))
+            {
+                _observer_first[(*o)->index + 1]++;
+            }
+        }
+    }
+    for (size_t i = 0; i < _option_list.size(); i++)
+    {
+        _observer_first[i + 1] += _observer_first[i];
+    }
+    _observer_list.resize(_observer_first[_option_list.size()]);
+    std::vector<uint32_t> fill(_observer_first.begin(), _observer_first.end() - 1);
+    for (std::vector<OptionObserver *>::const_iterator it = _observers.begin(); it != _observers.end(); ++it)
+    {
+        const std::vector<CmdLineOption *> &options = (*it)->options_;
+        for (std::vector<CmdLineOption *>::const_iterator o = options.begin(); o != options.end(); ++o)
+        {
+            if (((*o)->index < _option_list.size()) && (_option_list[(*o)->index] == *o))
+            {
+                _observer_list[fill[(*o)->index]++] = *it;
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ *   end a batch of changes,... tell each observer which of its options were set since the last call.
+ *
+ *   the parsers call this when they're done,... code that calls SetOption() itself should call it too.
+ *   the OptionsChanged() calls are made on the calling thread, which must be the one that changes the registry.
+ */
+void CmdLineOptions::NotifyObservers()
+{
+    if (_changed.empty())
+    {
+        return;
+    }
+    if (_observer_first.size() != _option_list.size() + 1)
+    {
+        LinkObservers();
+    }
+    std::vector<OptionObserver *> notify;
+    for (std::vector<uint32_t>::const_iterator it = _changed.begin(); it != _changed.end(); ++it)
+    {
+        for (uint32_t j = _observer_first[*it]; j < _observer_first[*it + 1]; j++)
+        {
+            OptionObserver *observer = _observer_list[j];
+            if (observer->changed_.empty())
+            {
+                notify.push_back(observer);
+            }
+            observer->changed_.push_back(_option_list[*it]);
+        }
+    }
+    _changed.clear();
+    _batch++;
+    for (std::vector<OptionObserver *>::const_iterator it = notify.begin(); it != notify.end(); ++it)
+    {
+        (*it)->Notify();
+    }
+}
+
+/**
+ * @brief
+ *   compile new constraints into masks over _is_set_bits
+ *
+ *   this is done the first time the constraints are checked,
+ *   since the options may not have been constructed when the constraint was.
+ */
+void CmdLineOptions::CompileConstraints()
+{
+    if (_constraint_first_term.empty())
+    {
+        _constraint_first_term.push_back(0);
+    }
+    for (size_t c = _compiled_constraints; c < _constraints.size(); c++)
+    {
+        OptionConstraint *constraint = _constraints[c];
+        std::vector<CmdLineOption *>::const_iterator it = constraint->options_.begin();
+        uint32_t trigger = UINT32_MAX;
+        if ((constraint->kind == OPTION_REQUIRES) && (it != constraint->options_.end()))
+        {
+            trigger = (*it)->index;
+            ++it;
+        }
+        std::vector<uint32_t> indexes;
+        for (; it != constraint->options_.end(); ++it)
+        {
+            indexes.push_back((*it)->index);
+        }
+        std::sort(indexes.begin(), indexes.end());
+        indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+        for (std::vector<uint32_t>::const_iterator index = indexes.begin(); index != indexes.end(); ++index)
+        {
+            uint32_t word = *index / 64;
+            if ((_term_word.size() == _constraint_first_term.back()) || (_term_word.back() != word))
+            {
+                _term_word.push_back(word);
+                _term_bits.push_back(0);
+            }
+            _term_bits.back() |= (uint64_t)1 << (*index % 64);
+        }
+        _constraint_first_term.push_back(_term_word.size());
+        _constraint_trigger.push_back(trigger);
+        _constraint_size.push_back(indexes.size());
+    }
+    _compiled_constraints = _constraints.size();
+}
+
+/**
+ * @brief
+ *   display a list of option names
+ *
+ * @param[out] out - output stream
+ * @param[in] options - options to display
+ * @param[in] only_set - only display options that are set
+ */
+static void show_option_names(std::ostream &out, const std::vector<CmdLineOption *> &options, bool only_set)
+{
+    const char *separator = "";
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        if (!only_set || (*it)->is_set)
+        {
+            out << separator << "'" << (*it)->name << "'";
+            separator = ", ";
+        }
+    }
+}
+
+/**
+ * @brief
+ *   check all the constraints against the options that are set
+ *
+ * @param[out] error_message - one line per constraint that is not met
+ *
+ * @return true if all the constraints are met
+ */
+bool CmdLineOptions::CheckConstraints(std::ostream &error_message)
+{
+    bool ok = true;
+    uint32_t num_set;
+    for (size_t c = 0; c < _constraints.size(); c++)
+    {
+        if (!ConstraintBroken(c, &num_set))
+        {
+            continue;
+        }
+        OptionConstraint *constraint = _constraints[c];
+        switch (constraint->kind)
+        {
+        case OPTION_REQUIRES:
+            error_message << "option '" << _option_list[_constraint_trigger[c]]->name << "' requires ";
+            {
+                std::vector<CmdLineOption *> missing;
+                for (size_t i = 1; i < constraint->options_.size(); i++)
+                {
+                    if (!constraint->options_[i]->is_set)
+                    {
+                        missing.push_back(constraint->options_[i]);
+                    }
+                }
+                show_option_names(error_message, missing, false);
+            }
+            break;
+        case OPTION_CONFLICTS:
+            error_message << "options ";
+            show_option_names(error_message, constraint->options_, true);
+            error_message << " can't be used together";
+            break;
+        case OPTION_ONE_OF:
+            error_message << "exactly one of ";
+            show_option_names(error_message, constraint->options_, false);
+            error_message << " is needed";
+            if (num_set > 1)
+            {
+                error_message << " (";
+                show_option_names(error_message, constraint->options_, true);
+                error_message << " are set)";
+            }
+            break;
+        case OPTION_AT_MOST:
+            error_message << "at most " << constraint->count << " of ";
+            show_option_names(error_message, constraint->options_, false);
+            error_message << " can be used (";
+            show_option_names(error_message, constraint->options_, true);
+            error_message << " are set)";
+            break;
+        }
+        error_message << "\n";
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief
+ *   check one constraint against the is_set bits
+ *
+ * @param[in] c - constraint index
+ * @param[out] num_set - number of options in the constraint's mask that are set
+ *
+ * @return true if the constraint is broken
+ */
+bool CmdLineOptions::ConstraintBroken(size_t c, uint32_t *num_set)
+{
+    if (_compiled_constraints != _constraints.size())
+    {
+        CompileConstraints();
+    }
+    *num_set = 0;
+    for (uint32_t t = _constraint_first_term[c]; t < _constraint_first_term[c + 1]; t++)
+    {
+        *num_set += __builtin_popcountll(_is_set_bits[_term_word[t]] & _term_bits[t]);
+    }
+    OptionConstraint *constraint = _constraints[c];
+    uint32_t trigger = _constraint_trigger[c];
+    switch (constraint->kind)
+    {
+    case OPTION_REQUIRES:
+        return (trigger != UINT32_MAX) && (_is_set_bits[trigger / 64] & ((uint64_t)1 << (trigger % 64))) &&
+               (*num_set != _constraint_size[c]);
+    case OPTION_CONFLICTS:
+        return *num_set > 1;
+    case OPTION_ONE_OF:
+        return *num_set != 1;
+    case OPTION_AT_MOST:
+        return *num_set > constraint->count;
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   find the first broken constraint,... like CheckConstraints(), but without making an error message.
+ *
+ * @return int32_t - index of the first broken constraint, -1 if they're all ok.
+ */
+int32_t CmdLineOptions::FirstBrokenConstraint()
+{
+    uint32_t num_set;
+    for (size_t c = 0; c < _constraints.size(); c++)
+    {
+        if (ConstraintBroken(c, &num_set))
+        {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief
+ *   sort _option_list indexes by option name
+ */
+class CompareOptionNames
+{
+  public:
+    /// constructor
+    CompareOptionNames(const std::vector<CmdLineOption *> &option_list) : option_list_(option_list)
+    {
+    }
+    /// compare two options by index
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return strcmp(option_list_[a]->name, option_list_[b]->name) < 0;
+    }
+    /// compare an option by index with a string
+    bool operator()(uint32_t a, const char *b) const
+    {
+        return strcmp(option_list_[a]->name, b) < 0;
+    }
+    const std::vector<CmdLineOption *> &option_list_; ///< options being sorted
+};
+
+/**
+ * @brief
+ *   shell completion,... display the possible completions of a partially typed argument, one per line.
+ *
+ *   'some_i' completes to option names, 'some_enum=t' completes to enumerations.
+ *   options that need a value complete with a trailing '=' so the shell can leave the cursor after it.
+ *
+ * @param[in] partial - argument typed so far
+ * @param[out] out - possible completions
+ */
+void CmdLineOptions::Complete(const char *partial, std::ostream &out)
+{
+    const char *dashes = partial;
+    while (*partial == '-')
+    {
+        partial++;
+    }
+    int num_dashes = partial - dashes;
+
+    const char *equals = strchr(partial, '=');
+    if (equals != NULL)
+    {
+        char token[100];
+        const char *prefix = split_option_token(partial, token, sizeof(token));
+        CmdLineOption *option = FindOption(token);
+        if (option != NULL)
+        {
+            std::vector<const char *> matches;
+            option->CompleteValue(prefix, matches);
+            for (std::vector<const char *>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+            {
+                out.write(dashes, num_dashes);
+                out << option->name << "=" << *it << "\n";
+            }
+        }
+        return;
+    }
+
+    SortOptions();
+    size_t len = strlen(partial);
+    std::vector<uint32_t>::const_iterator it =
+        std::lower_bound(_sorted_index.begin(), _sorted_index.end(), partial, CompareOptionNames(_option_list));
+    for (; it != _sorted_index.end(); ++it)
+    {
+        CmdLineOption *option = _option_list[*it];
+        if (strncmp(option->name, partial, len) != 0)
+        {
+            break;
+        }
+        // skip OptionGroup's
+        if (*option->name == 0)
+        {
+            continue;
+        }
+        out.write(dashes, num_dashes);
+        out << option->name;
+        if (!option->is_list && !option->is_bool)
+        {
+            out << "=";
+        }
+        out << "\n";
+    }
+}
+
+/**
+ * @brief
+ *   sort the options by name and build the namespace trie, if options were added or renamed since the last time.
+ */
+void CmdLineOptions::SortOptions()
+{
+    if (_sorted_index.size() == _option_list.size())
+    {
+        return;
+    }
+    _sorted_index.clear();
+    for (uint32_t i = 0; i < _option_list.size(); i++)
+    {
+        _sorted_index.push_back(i);
+    }
+    std::sort(_sorted_index.begin(), _sorted_index.end(), CompareOptionNames(_option_list));
+
+    _namespace_nodes.clear();
+    namespace_node_t root = {0, 0, 0, (uint32_t)_sorted_index.size(), 0, 0};
+    _namespace_nodes.push_back(root);
+    BuildNamespaceNode(0);
+}
+
+/**
+ * @brief
+ *   add the namespaces directly in a namespace to the trie, then the ones in those, and so on.
+ *
+ * @param[in] node - index in _namespace_nodes of the namespace
+ */
+void CmdLineOptions::BuildNamespaceNode(uint32_t node)
+{
+    // _namespace_nodes grows below, so no references into it
+    uint32_t first = _namespace_nodes[node].first;
+    uint32_t end = _namespace_nodes[node].end;
+    uint32_t start = (node == 0) ? 0 : _namespace_nodes[node].prefix_length + 1;
+    uint32_t first_child = _namespace_nodes.size();
+    for (uint32_t i = first; i < end;)
+    {
+        const char *name = _option_list[_sorted_index[i]]->name;
+        const char *dot = strchr(name + start, '.');
+        if (dot == NULL)
+        {
+            // an option of this namespace
+            i++;
+            continue;
+        }
+        // the names that start with the same "<segment>." are next to each other
+        uint32_t segment_length = dot - name + 1;
+        uint32_t j = i + 1;
+        while ((j < end) && (strncmp(_option_list[_sorted_index[j]]->name, name, segment_length) == 0))
+        {
+            j++;
+        }
+        // the whole range shares the prefix of its first and last names,... a '.' in there is a namespace with
+        // nothing but one more namespace in it, so it's merged into this node
+        const char *last = _option_list[_sorted_index[j - 1]]->name;
+        uint32_t prefix_length = segment_length - 1;
+        for (uint32_t k = segment_length; (name[k] != 0) && (name[k] == last[k]); k++)
+        {
+            if (name[k] == '.')
+            {
+                prefix_length = k;
+            }
+        }
+        namespace_node_t child = {_sorted_index[i], prefix_length, i, j, 0, 0};
+        _namespace_nodes.push_back(child);
+        i = j;
+    }
+    uint32_t num_children = _namespace_nodes.size() - first_child;
+    _namespace_nodes[node].first_child = first_child;
+    _namespace_nodes[node].num_children = num_children;
+    for (uint32_t c = first_child; c < first_child + num_children; c++)
+    {
+        BuildNamespaceNode(c);
+    }
+}
+
+/**
+ * @brief
+ *   find the options in a namespace by walking down the trie,... the cost depends on how deep the namespace is,
+ *   not on the number of options.
+ *
+ * @param[in] pattern - namespace, e.g. "dma.*", "dma." or "dma", "*" or "" for every option
+ * @param[out] first - first _sorted_index entry in the namespace
+ * @param[out] end - end of the namespace in _sorted_index
+ *
+ * @return true if there are options in the namespace
+ */
+bool CmdLineOptions::FindNamespace(const char *pattern, uint32_t *first, uint32_t *end)
+{
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    SortOptions();
+    uint32_t length = strlen(pattern);
+    if ((length > 0) && (pattern[length - 1] == '*'))
+    {
+        length--;
+    }
+    if ((length > 0) && (pattern[length - 1] == '.'))
+    {
+        length--;
+    }
+    uint32_t node = 0;
+    while (length > _namespace_nodes[node].prefix_length)
+    {
+        uint32_t start = (node == 0) ? 0 : _namespace_nodes[node].prefix_length + 1;
+        const namespace_node_t &parent = _namespace_nodes[node];
+        uint32_t c = parent.first_child;
+        for (; c < parent.first_child + parent.num_children; c++)
+        {
+            const namespace_node_t &child = _namespace_nodes[c];
+            const char *name = _option_list[child.option]->name;
+            uint32_t n = std::min(length, child.prefix_length);
+            if (strncmp(name + start, pattern + start, n - start) != 0)
+            {
+                continue;
+            }
+            // the pattern must end, or go on to the next namespace, where the child's name does
+            if ((length < child.prefix_length) ? (name[length] == '.') : ((n == length) || (pattern[n] == '.')))
+            {
+                break;
+            }
+        }
+        if (c == parent.first_child + parent.num_children)
+        {
+            return false;
+        }
+        node = c;
+    }
+    *first = _namespace_nodes[node].first;
+    *end = _namespace_nodes[node].end;
+    return *first != *end;
+}
+
+/**
+ * @brief
+ *   get the options in a namespace, sorted by name
+ *
+ * @param[in] pattern - namespace, e.g. "dma.*"
+ * @param[out] options - options in the namespace, including the ones in namespaces inside it
+ *
+ * @return size_t - number of options
+ */
+size_t CmdLineOptions::NamespaceOptions(const char *pattern, std::vector<CmdLineOption *> &options)
+{
+    uint32_t first;
+    uint32_t end;
+    if (!FindNamespace(pattern, &first, &end))
+    {
+        return 0;
+    }
+    for (uint32_t i = first; i < end; i++)
+    {
+        CmdLineOption *option = _option_list[_sorted_index[i]];
+        // skip OptionGroup's
+        if (*option->name != 0)
+        {
+            options.push_back(option);
+        }
+    }
+    return options.size();
+}
+
+/**
+ * @brief
+ *   display the usage message for the options in a namespace
+ *
+ * @param[in] pattern - namespace, e.g. "dma.*"
+ * @param[out] out - output stream
+ */
+void CmdLineOptions::ShowNamespaceUsage(const char *pattern, std::ostream &out)
+{
+    std::vector<CmdLineOption *> options;
+    if (NamespaceOptions(pattern, options) == 0)
+    {
+        out << "no options in namespace '" << pattern << "'\n";
+        return;
+    }
+    std::ios_base::fmtflags f(out.flags());
+    size_t max_len = 0;
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        max_len = std::max(max_len, strlen((*it)->name));
+    }
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        out << "  " << std::left << std::setw(max_len) << (*it)->name << " " << (*it)->usage_message << "\n";
+    }
+    out.flags(f);
+}
+
+/**
+ * @brief
+ *   reset the options in a namespace to default,... only that part of the registry is touched.
+ *
+ * @param[in] pattern - namespace, e.g. "dma.*"
+ */
+void CmdLineOptions::ResetNamespace(const char *pattern)
+{
+    uint32_t first;
+    uint32_t end;
+    if (!FindNamespace(pattern, &first, &end))
+    {
+        return;
+    }
+    for (uint32_t i = first; i < end; i++)
+    {
+        uint32_t index = _sorted_index[i];
+        // options of a subcommand that was never selected still have their defaults
+        uint16_t subcommand = _option_subcommand[index];
+        if ((subcommand == 0) || !_subcommands[subcommand - 1]->hash_table_.empty())
+        {
+            _option_list[index]->Reset();
+            MarkChanged(index);
+        }
+        _is_set_bits[index / 64] &= ~((uint64_t)1 << (index % 64));
+    }
+    NotifyObservers();
+}
+
+/// the program's real stdout while it answers a shell completion request, -1 if it wasn't started for one
+static int completion_fd = -1;
+
+/**
+ * @brief
+ *   runs before the static constructors,... if the program was started to answer shell completion, stdout goes
+ *   to /dev/null until ParseOptions() answers on the real one, so nothing printed before that (by a constructor,
+ *   or by main() before it parses) ends up in the list of completions.
+ *
+ *   the answer can't be given here, the options register themselves in their constructors, which haven't run yet.
+ */
+__attribute__((constructor(101))) static void completion_request()
+{
+    FILE *file = fopen("/proc/self/cmdline", "r");
+    if (file == NULL)
+    {
+        return;
+    }
+    // skip argv[0], then read argv[1]
+    int c;
+    while (((c = getc(file)) != EOF) && (c != 0))
+    {
+    }
+    char arg[24];
+    size_t len = 0;
+    while (((c = getc(file)) != EOF) && (c != 0) && (len < sizeof(arg) - 1))
+    {
+        arg[len++] = c;
+    }
+    arg[len] = 0;
+    fclose(file);
+    if (((c != 0) && (c != EOF)) || ((strcmp(arg, "__complete") != 0) && (strcmp(arg, "__completion_script") != 0)))
+    {
+        return;
+    }
+    fflush(stdout);
+    completion_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if ((completion_fd >= 0) && (null_fd >= 0))
+    {
+        dup2(null_fd, STDOUT_FILENO);
+    }
+    if (null_fd >= 0)
+    {
+        close(null_fd);
+    }
+}
+
+/**
+ * @brief
+ *   write the answer to a shell completion request and exit,... without running atexit() handlers or static
+ *   destructors, which could print more.
  *
- * @param[in] default_value - default value if not specified on command line
- * @param[in] _name - option name
- * @param[in] _usage_message - option usage message
+ * @param[in] answer - completions or completion script
  */
-StringOption::StringOption(const char *default_value, const char *_name, const char *_usage_message)
-    : CmdLineOption(_name, _usage_message), value(default_value), _default_value(default_value)
+static void answer_completion(const std::string &answer)
 {
-    SetFromEnvironmentVariable();
+    int fd = (completion_fd >= 0) ? completion_fd : STDOUT_FILENO;
+    for (size_t done = 0; done < answer.size();)
+    {
+        ssize_t n = write(fd, answer.data() + done, answer.size() - done);
+        if (n <= 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    _exit(0);
 }
 
 /**
  * @brief
- *   reset value to default
+ *   display a script that hooks up shell completion for a program
+ *
+ *   e.g. add this to your .bashrc
+ *     source <(my_program __completion_script bash)
+ *
+ * @param[in] program - program name
+ * @param[in] shell - "bash" or "zsh"
+ * @param[out] out - completion script
  */
-void StringOption::Reset()
+void CmdLineOptions::CompletionScript(const char *program, const char *shell, std::ostream &out)
 {
-    is_set = false;
-    value = _default_value;
+    const char *base_name = strrchr(program, '/');
+    base_name = (base_name == NULL) ? program : base_name + 1;
+    std::string function_name = "_";
+    for (const char *s = base_name; *s != 0; s++)
+    {
+        function_name += isalnum(*s) ? *s : '_';
+    }
+    function_name += "_complete";
+
+    if (strcmp(shell, "zsh") == 0)
+    {
+        out << function_name << "() {\n"
+            << "    local -a matches\n"
+            << "    matches=(${(f)\"$(" << program << " __complete \"${words[CURRENT]}\")\"})\n"
+            << "    compadd -S '' -- ${(M)matches:#*=}\n"
+            << "    compadd -- ${matches:#*=}\n"
+            << "}\n"
+            << "compdef " << function_name << " " << base_name << "\n";
+    }
+    else
+    {
+        // bash splits words at '=' and ':', so complete the whole space separated word,
+        // then remove the part bash considers to be an earlier word.
+        out << function_name << "() {\n"
+            << "    local cur=\"${COMP_LINE:0:COMP_POINT}\"\n"
+            << "    cur=\"${cur##* }\"\n"
+            << "    local IFS=$'\\n'\n"
+            << "    COMPREPLY=($(" << program << " __complete \"$cur\"))\n"
+            << "    if [[ ${#COMPREPLY[@]} -eq 1 && ${COMPREPLY[0]} == *= ]]; then\n"
+            << "        compopt -o nospace\n"
+            << "    fi\n"
+            << "    local prefix=\"${cur%\"${cur##*[=:]}\"}\"\n"
+            << "    COMPREPLY=(\"${COMPREPLY[@]#\"$prefix\"}\")\n"
+            << "}\n"
+            << "complete -F " << function_name << " " << base_name << "\n";
+    }
 }
 
 /**
  * @brief
- *   parse the command line option
+ *   an extern "C" callable version of CmdLineOptions::ParseOptions(argc,argv)
  *
- * @param[in] s - default value if not specified on command line
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings
+ */
+extern "C" void cmd_line_options_parse_options(int argc, const char **argv)
+{
+    CmdLineOptions::ParseOptions(argc, argv);
+}
+
+/**
+ * @brief
+ *   Static class menthod to wrap calls to singleton to parse options
  *
- * @return bool - true if option was valid.
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings
  */
-bool StringOption::ParseValue(const char *s)
+void CmdLineOptions::ParseOptions(int argc, const char **argv)
 {
-    value = s;
-    return true;
+    CmdLineOptions::GetInstance()->ParseOptionsInternal(argc, argv);
 }
 
 /**
  * @brief
- *   display a usage message to stdout
+ *   parse command line options
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings
  */
-void CmdLineOptions::Usage()
+void CmdLineOptions::ParseOptionsInternal(int argc, const char **argv)
 {
-    uint32_t max_len = 0;
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    if (strcmp(argv[0], "parse_string") != 0)
+    {
+        // shell completion,... answer and exit, anything the program printed so far went to /dev/null
+        std::stringstream answer;
+        if ((argc >= 2) && (strcmp(argv[1], "__complete") == 0))
+        {
+            Complete(argc >= 3 ? argv[2] : "", answer);
+            answer_completion(answer.str());
+        }
+        if ((argc >= 2) && (strcmp(argv[1], "__completion_script") == 0))
+        {
+            CompletionScript(argv[0], argc >= 3 ? argv[2] : "bash", answer);
+            answer_completion(answer.str());
+        }
+    }
+    parse_error_t error;
+    if (TryParseOptions(argc - 1, &argv[1], &error))
+    {
+        return;
+    }
+    const char *arg = (error.arg_index >= 0) ? argv[error.arg_index + 1] : "";
+    CmdLineOption *option = (error.code != PARSE_ERROR_CONSTRAINT) && (error.option_index >= 0)
+                                ? _option_list[error.option_index]
+                                : NULL;
+    switch (error.code)
     {
+    case PARSE_ERROR_NO_MATCH: {
+        char token[100];
+        split_option_token(arg, token, sizeof(token));
+        printf("no match for '%s'\n", token);
+        break;
+    }
+    case PARSE_ERROR_BAD_VALUE:
+        // some options (EnumOption) explain what's wrong themselves, static options don't
+        if (option != NULL)
+        {
+            option->ParseValue(arg + error.offset);
+        }
+        printf("error parsing '%s'\n", arg);
+        break;
+    case PARSE_ERROR_BAD_LIST_ITEM:
+        printf("error parsing list item '%s'\n", arg);
+        option->ParseValueWithError(arg, std::cout);
+        break;
+    case PARSE_ERROR_BAD_FILE:
+        printf("can't use the file in '%s'\n", arg);
+        break;
+    case PARSE_ERROR_CONSTRAINT:
+        CheckConstraints(std::cout);
+        break;
+    default:
+        break;
+    }
+    Usage();
+}
 
-        CmdLineOption *option = *(it);
-        uint32_t len = strlen(option->name);
-        if (len > max_len)
+/**
+ * @brief
+ *   check the environment variable project_name
+ *
+ * Unfortunately, this cannot be called from the base class constructor,
+ * because the virtual function ParseValue() is not initialized until the derived class is constructed.
+ * the options of a subcommand wait until it is selected, and the registry calls this for options whose
+ * constructor didn't (e.g. EnumOption's, whose enumerations are added after it) the first time it's used.
+ */
+void CmdLineOption::SetFromEnvironmentVariable()
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    if (!registry->EnvironmentDue(this))
+    {
+        return;
+    }
+    char env_name[100];
+    const char *env_value = getenv_option(name, env_name, sizeof(env_name));
+    if (env_value != NULL)
+    {
+        if (!registry->HoldEnvironmentMessage(this))
         {
-            max_len = len;
+            printf("setting %s to \"%s\" (from environment variable %s)\n", name, env_value, env_name);
+        }
+        if (!ParseValue(env_value))
+        {
+            printf("error parsing '%s'\n", env_value);
+            CmdLineOptions::GetInstance()->Usage();
+        }
+        if (is_list)
+        {
+            EndOfList();
         }
+        CmdLineOptions::GetInstance()->SetOption(this);
     }
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+}
+
+/**
+ * @brief
+ *   add an option to the global list of options
+ *
+ * @param[in] option - option to add
+ */
+void CmdLineOptions::AddOption(CmdLineOption *option)
+{
+    uint32_t length;
+    option->index = _option_list.size();
+    _option_list.push_back(option);
+    _name_hash.push_back((uint32_t)option_name_hash(option->name, &length));
+    _name_length.push_back(length);
+    _touched_epoch.push_back(0);
+    _changed_batch.push_back(0);
+    _env_checked.push_back(0);
+    if (option->index % 64 == 0)
     {
-        CmdLineOption *option = *(it);
-        // the 'GroupOption' has no option name and just injects a left justified string into the usage message
-        if (*option->name == 0)
+        _is_set_bits.push_back(0);
+    }
+}
+
+/**
+ * @brief
+ *   parse command line options or generate error message
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings
+ * @param[in] error_message - error message
+ *
+ * @return true if successful, false otherwise.
+ */
+bool CmdLineOptions::ParseOptionsOrError(int argc, const char **argv, std::ostream &error_message)
+{
+    parse_error_t error;
+    if (TryParseOptions(argc, argv, &error))
+    {
+        return true;
+    }
+    RenderError(error, argv, error_message);
+    return false;
+}
+
+/**
+ * @brief
+ *   parse command line options,... the parse core used by ParseOptions() and ParseOptionsOrError().
+ *
+ *   nothing is printed and nothing is allocated (apart from what options store, e.g. list values),
+ *   the first error stops the parse and is described by 'error'.  RenderError() makes a message out of it.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings (without the program name)
+ * @param[out] error - what went wrong, if anything
+ *
+ * @return true if successful, false otherwise.
+ */
+bool CmdLineOptions::TryParseOptions(int argc, const char **argv, parse_error_t *error)
+{
+    // observers hear about what was set even if the parse stopped at an error
+    bool ok = ParseArguments(argc, argv, error);
+    NotifyObservers();
+    return ok;
+}
+
+/**
+ * @brief
+ *   parse command line options into the options,... TryParseOptions() without notifying the observers.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings (without the program name)
+ * @param[out] error - what went wrong, if anything
+ *
+ * @return true if successful, false otherwise.
+ */
+bool CmdLineOptions::ParseArguments(int argc, const char **argv, parse_error_t *error)
+{
+    // the environment is checked when options are first synced, before the command line overrides it
+    if (_synced_count != _option_list.size())
+    {
+        SyncRegistry();
+    }
+    error->code = PARSE_ERROR_NONE;
+    error->arg_index = -1;
+    error->option_index = -1;
+    error->offset = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        char token[100];
+        const char *val_str = split_option_token(argv[i], token, sizeof(token));
+        uint32_t length;
+        uint64_t hash = option_name_hash(token, &length);
+        error->arg_index = i;
+        // static tables first, they don't need any setting up
+        static_option_ref_t ref;
+        if (FindStaticOption(token, length, hash, &ref))
         {
-            printf("%s\n", option->usage_message);
+            if (!SetStaticOption(ref, val_str))
+            {
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->option_index = -1;
+                error->offset = val_str - argv[i];
+                return false;
+            }
+            continue;
+        }
+        CmdLineOption *option = FindOption(token, length, hash);
+        if (option == NULL)
+        {
+            error->code = PARSE_ERROR_NO_MATCH;
+            return false;
+        }
+        error->option_index = option->index;
+        Touch(option);
+        if (option->is_list)
+        {
+            // 'name:=@file' takes values from a file too
+            if ((*val_str == '@') && !option->MapFile(val_str + 1))
+            {
+                error->code = PARSE_ERROR_BAD_FILE;
+                error->offset = val_str - argv[i];
+                return false;
+            }
+            for (i = i + 1; i < argc; i++)
+            {
+                // for OptionFreeStringList, terminate the list
+                // if you find something that looks like another command line option
+                if (option->is_option_free_list && MatchesAnOption(argv[i]))
+                {
+                    break;
+                }
+                if (!option->TryParseValue(argv[i]))
+                {
+                    // if the next option doesn't match an option, it's an error
+                    if (!MatchesAnOption(argv[i]))
+                    {
+                        error->code = PARSE_ERROR_BAD_LIST_ITEM;
+                        error->arg_index = i;
+                        return false;
+                    }
+                    break;
+                }
+            }
+            /* start parsing arguments again at 'i',... so back i up one... */
+            i--;
+            option->EndOfList();
+        }
+        else if (!option->TryParseValue(val_str))
+        {
+            error->code = PARSE_ERROR_BAD_VALUE;
+            error->offset = val_str - argv[i];
+            return false;
+        }
+        SetOption(option);
+    }
+    error->arg_index = -1;
+    error->option_index = FirstBrokenConstraint();
+    if (error->option_index >= 0)
+    {
+        error->code = PARSE_ERROR_CONSTRAINT;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   write the error message for a parse error
+ *
+ * @param[in] error - error from TryParseOptions()
+ * @param[in] argv - the argument strings that were parsed
+ * @param[out] error_message - error message
+ */
+void CmdLineOptions::RenderError(const parse_error_t &error, const char **argv, std::ostream &error_message)
+{
+    const char *arg = (error.arg_index >= 0) ? argv[error.arg_index] : "";
+    CmdLineOption *option = (error.code != PARSE_ERROR_CONSTRAINT) && (error.option_index >= 0)
+                                ? _option_list[error.option_index]
+                                : NULL;
+    switch (error.code)
+    {
+    case PARSE_ERROR_NO_MATCH: {
+        char token[100];
+        split_option_token(arg, token, sizeof(token));
+        error_message << "no match for option \"" << token << "\""
+                      << "\n";
+        ShowUsage(error_message);
+        break;
+    }
+    case PARSE_ERROR_BAD_VALUE:
+    case PARSE_ERROR_BAD_LIST_ITEM:
+        if (option == NULL)
+        {
+            // static options aren't in the registry
+            ShowStaticError(arg, error.offset, error_message);
         }
         else
         {
-            // print option name left justified in the first column
-            printf("  %*s - %s\n", -max_len, option->name, option->usage_message);
+            option->ParseValueWithError(arg + error.offset, error_message);
         }
+        error_message << "error parsing \"" << arg << "\""
+                      << "\n";
+        break;
+    case PARSE_ERROR_BAD_FILE:
+        error_message << "can't use the file in \"" << arg << "\" for option '" << option->name << "'"
+                      << "\n";
+        break;
+    case PARSE_ERROR_CONSTRAINT:
+        CheckConstraints(error_message);
+        break;
+    default:
+        break;
     }
-    exit(-1);
 }
 
 /**
  * @brief
- *   display a usage message to ostream
+ *   constructor
  *
- * @param[out] error_message - output stream to format error message.
+ * @param[in] error_message - error messages are written here
  */
-void CmdLineOptions::ShowUsage(std::ostream &error_message)
+CmdLineOptionParser::CmdLineOptionParser(std::ostream &error_message)
+    : pending_list(NULL), error(false), error_message_(error_message)
 {
-    std::ios_base::fmtflags f(error_message.flags());
-    uint32_t max_len = 0;
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+}
+
+/**
+ * @brief
+ *   called after an option has been completely parsed
+ *   you can override this method to see options as they are resolved.
+ *
+ * @param[in] option - option that was set
+ */
+void CmdLineOptionParser::OptionParsed(CmdLineOption *)
+{
+}
+
+/**
+ * @brief
+ *   mark an option as set
+ *
+ * @param[in] option - option that was set
+ */
+void CmdLineOptionParser::OptionDone(CmdLineOption *option)
+{
+    CmdLineOptions::GetInstance()->SetOption(option);
+    OptionParsed(option);
+}
+
+/**
+ * @brief
+ *   parse the next command line argument
+ *
+ *   if a list option is pending, the argument is added to the list,
+ *   unless it looks like another option, in which case the list is ended.
+ *
+ * @param[in] s - command line argument
+ *
+ * @return true if successful, false if this or an earlier argument had an error.
+ */
+bool CmdLineOptionParser::Feed(const char *s)
+{
+    if (error)
+    {
+        return false;
+    }
+    if (pending_list != NULL)
+    {
+        CmdLineOptions *options = CmdLineOptions::GetInstance();
+        // for OptionFreeStringList, terminate the list
+        // if you find something that looks like another command line option
+        if (!pending_list->is_option_free_list || !options->MatchesAnOption(s))
+        {
+            if (pending_list->TryParseValue(s))
+            {
+                return true;
+            }
+            if (!options->MatchesAnOption(s))
+            {
+                parse_error_t record = {PARSE_ERROR_BAD_LIST_ITEM, 0, (int32_t)pending_list->index, 0};
+                options->RenderError(record, &s, error_message_);
+                pending_list = NULL;
+                error = true;
+                return false;
+            }
+        }
+        Flush();
+    }
+    return StartOption(s);
+}
+
+/**
+ * @brief
+ *   parse a command line argument that should be an option
+ *
+ * @param[in] s - command line argument
+ *
+ * @return true if successful, false otherwise.
+ */
+bool CmdLineOptionParser::StartOption(const char *s)
+{
+    char token[100];
+    const char *val_str = split_option_token(s, token, sizeof(token));
+    CmdLineOptions *options = CmdLineOptions::GetInstance();
+    parse_error_t record = {PARSE_ERROR_NO_MATCH, 0, -1, 0};
+    static_option_ref_t ref;
+    if (options->FindStaticOption(token, &ref))
     {
-
-        CmdLineOption *option = *(it);
-        uint32_t len = strlen(option->name);
-        if (len > max_len)
+        if (options->SetStaticOption(ref, val_str))
         {
-            max_len = len;
+            return true;
         }
+        record.code = PARSE_ERROR_BAD_VALUE;
+        record.offset = val_str - s;
+        options->RenderError(record, &s, error_message_);
+        error = true;
+        return false;
     }
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    CmdLineOption *option = options->FindOption(token);
+    if (option != NULL)
     {
-        CmdLineOption *option = *(it);
-        if (*option->name == 0)
+        options->Touch(option);
+        if (option->is_list && ((*val_str != '@') || option->MapFile(val_str + 1)))
         {
-            error_message << option->usage_message << "\n";
+            pending_list = option;
+            return true;
         }
-        else
+        if (option->is_list)
         {
-            // print option name left justified in the first column
-            error_message << "  " << std::left << std::setw(max_len) << option->name << " " << option->usage_message
-                          << "\n";
+            record.code = PARSE_ERROR_BAD_FILE;
+            record.option_index = option->index;
+            record.offset = val_str - s;
+            options->RenderError(record, &s, error_message_);
+            error = true;
+            return false;
+        }
+        if (option->TryParseValue(val_str))
+        {
+            OptionDone(option);
+            return true;
         }
+        record.code = PARSE_ERROR_BAD_VALUE;
+        record.option_index = option->index;
+        record.offset = val_str - s;
     }
-    error_message.flags(f);
+    options->RenderError(record, &s, error_message_);
+    error = true;
+    return false;
 }
 
 /**
  * @brief
- *   reset options to default
+ *   end the pending list option (if any)
+ *
+ *   call this when there are no more tokens for now, e.g. at the end of a line.
+ *
+ * @return true if no errors have been found since the last Finish()
  */
-void CmdLineOptions::Reset()
+bool CmdLineOptionParser::Flush()
 {
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
-    {
-        CmdLineOption *option = *(it);
-        option->Reset();
-    }
-    std::vector<const char *>::const_iterator it;
-    for (it = _tokens_allocated_by_ParseString.begin(); it != _tokens_allocated_by_ParseString.end(); ++it)
+    if (pending_list != NULL)
     {
-        const char *arg = *it;
-        free((void *)arg);
+        CmdLineOption *option = pending_list;
+        pending_list = NULL;
+        option->EndOfList();
+        OptionDone(option);
     }
-    _tokens_allocated_by_ParseString.clear();
+    return !error;
 }
 
 /**
  * @brief
- *   parse a space separated list of arguments as if they were specified as command line arguments
+ *   end the pending list option and clear the error state so the parser can be reused
  *
- * @param[in] argv_string - space separated list of command line arguments
+ * @return true if no errors have been found since the last Finish()
  */
-void CmdLineOptions::ParseString(const char *argv_string)
+bool CmdLineOptionParser::Finish()
 {
-    char *argv_str = strdup(argv_string);
-    char *token;
-    std::vector<const char *> argv_vector;
-
-    /* get the first token */
-    token = strtok(argv_str, " ");
-
-    argv_vector.push_back("parse_string");
-
-    /* walk through other tokens */
-    while (token != NULL)
-    {
-        char *arg = strdup(token);
-        _tokens_allocated_by_ParseString.push_back(
-            arg); /* note: this is not used,... just saved to avoid valgrind from detecting a memory leak */
-        argv_vector.push_back((char *)arg);
-
-        token = strtok(NULL, " ");
-    }
-    free(argv_str);
+    bool ok = Flush() && CmdLineOptions::GetInstance()->CheckConstraints(error_message_);
+    error = false;
+    CmdLineOptions::GetInstance()->NotifyObservers();
+    return ok;
+}
 
-    /* parse options with created argc/argv */
-    CmdLineOptions::ParseOptions(argv_vector.size(), &(argv_vector[0]));
+/**
+ * @brief
+ *   constructor
+ */
+CmdLineDiffParser::CmdLineDiffParser() : changed(0), num_previous_(0), num_current_(0), reset_needed_(true)
+{
 }
 
 /**
  * @brief
- *   returns true if the string matches a valid command line option
+ *   parse a command line, changing only the options that differ from the previous line
  *
- * @param[in] s - string
- * @return true if 's' matches a command line option, false otherwise.
+ *   an error found in the arguments (no match, bad value) changes nothing, the options stay as the previous line
+ *   left them.  a line with a subcommand is parsed in full, like TryParseOptions() after Reset(), since which
+ *   options can be found depends on the subcommand.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings (without the program name)
+ * @param[out] error - what went wrong, if anything
+ *
+ * @return true if successful, false otherwise.
  */
-bool CmdLineOptions::MatchesAnOption(const char *s)
+bool CmdLineDiffParser::Parse(int argc, const char **argv, parse_error_t *error)
 {
-    char token[100];
-    char *equals;
-
-    /* make the '-' optional */
-    if (s[0] == '-')
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    changed = 0;
+    previous_slot_.resize(registry->OptionCount(), 0);
+    current_slot_.resize(registry->OptionCount(), 0);
+    bool subcommand = false;
+    if (!GroupLine(argc, argv, error, &subcommand))
     {
-        s++;
-        if (s[0] == '-')
+        ClearCurrent();
+        if (subcommand)
         {
-            s++;
+            ParseInFull(argc, argv, error);
+            return error->code == PARSE_ERROR_NONE;
         }
+        return false;
     }
-    strncpy(token, s, 99);
-    equals = strchr(token, '=');
-    if (equals != NULL)
+    if (reset_needed_)
     {
-        *equals = 0;
+        registry->Reset();
+        Forget();
+        reset_needed_ = false;
     }
-    for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    // options that were on the previous line but not this one go back to their defaults
+    for (size_t i = 0; i < num_previous_; i++)
     {
-        CmdLineOption *option = *(it);
-        if (strcmp(token, option->name) == 0)
+        const line_option_t &entry = previous_[i];
+        bool gone = (entry.option != NULL) ? (current_slot_[entry.option->index] == 0)
+                                           : (FindStatic(current_, num_current_, entry.ref) == NULL);
+        if (gone)
         {
-            return true;
+            Restore(entry);
+            changed++;
         }
     }
-    return false;
+    for (size_t i = 0; i < num_current_; i++)
+    {
+        line_option_t &entry = current_[i];
+        line_option_t *previous = NULL;
+        if (entry.option == NULL)
+        {
+            previous = FindStatic(previous_, num_previous_, entry.ref);
+        }
+        else if (previous_slot_[entry.option->index] != 0)
+        {
+            previous = &previous_[previous_slot_[entry.option->index] - 1];
+        }
+        if ((previous != NULL) && (previous->args == entry.args))
+        {
+            // the option may point into the old arguments (string values), so they move to this line
+            entry.args.swap(previous->args);
+            continue;
+        }
+        if (previous != NULL)
+        {
+            // a list starts again from empty
+            Restore(*previous);
+        }
+        if (!Apply(entry))
+        {
+            // CheckValue() passed but the parse didn't, start over so the error is found where it is
+            ClearCurrent();
+            ParseInFull(argc, argv, error);
+            return false;
+        }
+        changed++;
+    }
+    // this line is the previous line for the next one
+    for (size_t i = 0; i < num_previous_; i++)
+    {
+        if (previous_[i].option != NULL)
+        {
+            previous_slot_[previous_[i].option->index] = 0;
+        }
+    }
+    previous_.swap(current_);
+    previous_slot_.swap(current_slot_);
+    num_previous_ = num_current_;
+    num_current_ = 0;
+    error->arg_index = -1;
+    error->option_index = registry->FirstBrokenConstraint();
+    if (error->option_index >= 0)
+    {
+        error->code = PARSE_ERROR_CONSTRAINT;
+    }
+    registry->NotifyObservers();
+    return error->code == PARSE_ERROR_NONE;
 }
 
 /**
  * @brief
- *   an extern "C" callable version of CmdLineOptions::ParseOptions(argc,argv)
+ *   forget the previous line, so the next line is applied in full (after a Reset())
  *
- * @param[in] argc - number of arguments
- * @param[in] argv - argument strings
+ *   call this if the options were changed some other way since the last Parse().
  */
-extern "C" void cmd_line_options_parse_options(int argc, const char **argv)
+void CmdLineDiffParser::Forget()
 {
-    CmdLineOptions::ParseOptions(argc, argv);
+    for (size_t i = 0; i < num_previous_; i++)
+    {
+        if (previous_[i].option != NULL)
+        {
+            previous_slot_[previous_[i].option->index] = 0;
+        }
+    }
+    num_previous_ = 0;
+    reset_needed_ = true;
 }
 
 /**
  * @brief
- *   Static class menthod to wrap calls to singleton to parse options
+ *   sort the arguments of a line by option into current_, checking them but not changing any option
  *
  * @param[in] argc - number of arguments
  * @param[in] argv - argument strings
- */
-void CmdLineOptions::ParseOptions(int argc, const char **argv)
-{
-    CmdLineOptions::GetInstance()->ParseOptionsInternal(argc, argv);
-}
-
-/**
- * @brief
- *   parse command line options
+ * @param[out] error - what went wrong, if anything
+ * @param[out] subcommand - set if the line has a subcommand (the rest of the line isn't looked at)
  *
- * @param[in] argc - number of arguments
- * @param[in] argv - argument strings
+ * @return true if every argument was valid
  */
-void CmdLineOptions::ParseOptionsInternal(int argc, const char **argv)
+bool CmdLineDiffParser::GroupLine(int argc, const char **argv, parse_error_t *error, bool *subcommand)
 {
-    int i;
-    if (strcmp(argv[0], "parse_string") != 0)
-    {
-        std::string window_title;
-        if (strrchr(argv[0], '/') != NULL)
-            window_title = strrchr(argv[0], '/') + 1;
-        else
-            window_title = argv[0];
-        for (i = 1; i < argc; i++)
-        {
-            const char *s = argv[i];
-            window_title += " ";
-            window_title += s;
-        }
-        // modify the xterm window title to match the program name
-        // printf("\033]0;%s\007",window_title.c_str());
-    }
-    for (i = 1; i < argc; i++)
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    error->code = PARSE_ERROR_NONE;
+    error->arg_index = -1;
+    error->option_index = -1;
+    error->offset = 0;
+    num_current_ = 0;
+    for (int i = 0; i < argc; i++)
     {
-        const char *s = argv[i];
         char token[100];
-        const char *val_str;
-        char *equals;
-
-        /* make the '-' optional */
-        if (s[0] == '-')
+        const char *val_str = split_option_token(argv[i], token, sizeof(token));
+        error->arg_index = i;
+        line_option_t *entry;
+        static_option_ref_t ref = {NULL, 0};
+        if (registry->FindStaticOption(token, &ref))
         {
-            s++;
-            if (s[0] == '-')
+            if (!ref.table->Check(ref.index, val_str))
             {
-                s++;
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->offset = val_str - argv[i];
+                return false;
             }
+            entry = FindStatic(current_, num_current_, ref);
+            entry = (entry != NULL) ? entry : AddEntry(NULL, ref);
+            entry->args.push_back('\1');
+            entry->args.insert(entry->args.end(), argv[i], argv[i] + strlen(argv[i]) + 1);
+            continue;
         }
-        strncpy(token, s, 99);
-        equals = strchr(token, '=');
-        if (equals == NULL)
+        CmdLineOption *option = registry->FindOption(token);
+        if (option == NULL)
         {
-            val_str = (char *)"";
+            error->code = PARSE_ERROR_NO_MATCH;
+            return false;
         }
-        else
+        if (option->type == CMD_LINE_OPTION_SUBCOMMAND)
         {
-            *equals = 0;
-            equals++;
-            val_str = &s[equals - token];
+            *subcommand = true;
+            return false;
         }
-        bool matched = false;
-        for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+        error->option_index = option->index;
+        entry = (current_slot_[option->index] != 0) ? &current_[current_slot_[option->index] - 1] : AddEntry(option, ref);
+        entry->args.push_back('\1');
+        entry->args.insert(entry->args.end(), argv[i], argv[i] + strlen(argv[i]) + 1);
+        if (!option->is_list)
         {
-            CmdLineOption *option = *(it);
-            if (strcmp(token, option->name) == 0)
+            if (!option->CheckValue(val_str))
             {
-                if (option->is_list)
-                {
-                    for (i = i + 1; i < argc; i++)
-                    {
-                        // for OptionFreeStringList, terminate the list
-                        // if you find something that looks like another command line option
-                        if (option->is_option_free_list)
-                        {
-                            if (MatchesAnOption(argv[i]))
-                            {
-                                i--;
-                                break;
-                            }
-                        }
-                        if (!option->ParseValue(argv[i]))
-                        {
-                            if (MatchesAnOption(argv[i]))
-                            {
-                                i--;
-                                break;
-                            }
-                            if (!option->ParseValue(argv[i]))
-                            {
-                                // if the next option doesn't match an option,
-                                // return an error message.
-                                if (!MatchesAnOption(argv[i]))
-                                {
-                                    std::stringstream error_message;
-                                    printf("error parsing list item '%s'\n", argv[i]);
-                                    if (!option->ParseValueWithError(argv[i], error_message))
-                                    {
-                                        printf("%s", error_message.str().c_str());
-                                    }
-                                    Usage();
-                                }
-                            }
-                            /* start parsing arguments again at 'i',... so back i up one... */
-                            i--;
-                            break;
-                        }
-                    }
-                    option->EndOfList();
-                }
-                else
-                {
-                    if (!option->ParseValue(val_str))
-                    {
-                        printf("error parsing '%s'\n", argv[i]);
-                        Usage();
-                    }
-                }
-                option->OptionSet();
-                option->is_set = true;
-                matched = true;
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->offset = val_str - argv[i];
+                return false;
             }
+            continue;
+        }
+        if ((*val_str == '@') && !option->CheckFile(val_str + 1))
+        {
+            error->code = PARSE_ERROR_BAD_FILE;
+            error->offset = val_str - argv[i];
+            return false;
         }
-        if (!matched)
+        // the same rules as TryParseOptions() for where the list ends
+        for (i = i + 1; i < argc; i++)
         {
-            printf("no match for '%s'\n", token);
-            Usage();
+            if (option->is_option_free_list && registry->MatchesAnOption(argv[i]))
+            {
+                break;
+            }
+            if (!option->CheckValue(argv[i]))
+            {
+                if (!registry->MatchesAnOption(argv[i]))
+                {
+                    error->code = PARSE_ERROR_BAD_LIST_ITEM;
+                    error->arg_index = i;
+                    return false;
+                }
+                break;
+            }
+            entry->args.push_back('\2');
+            entry->args.insert(entry->args.end(), argv[i], argv[i] + strlen(argv[i]) + 1);
         }
+        i--;
     }
+    error->arg_index = -1;
+    error->option_index = -1;
+    return true;
 }
 
 /**
  * @brief
- *   check the environment variable project_name
+ *   start the arguments of an option on the current line, reusing an old entry (and its buffer) if there is one
  *
- * Unfortunately, this cannot be called from the base class constructor,
- * because the virtual function ParseValue() is not initialized until the derived class is constructed.
+ * @param[in] option - option, NULL for a static option
+ * @param[in] ref - static option
+ *
+ * @return line_option_t * - the entry
  */
-void CmdLineOption::SetFromEnvironmentVariable()
+CmdLineDiffParser::line_option_t *CmdLineDiffParser::AddEntry(CmdLineOption *option, const static_option_ref_t &ref)
 {
-    char env_name[100];
-    snprintf(env_name, sizeof(env_name), "PROJECT_NAME_%s", name);
-    char *env_value = getenv(env_name);
-    if (env_value == NULL)
+    if (num_current_ == current_.size())
     {
-        // also look for the uppercase version of the option
-        for (char *s = env_name; *s != 0; s++)
-        {
-            if (islower(*s))
-            {
-                *s = toupper(*s);
-            }
-        }
-        env_value = getenv(env_name);
+        current_.push_back(line_option_t());
     }
-    if (env_value != NULL)
+    line_option_t *entry = &current_[num_current_++];
+    entry->option = option;
+    entry->ref = ref;
+    entry->args.clear();
+    if (option != NULL)
     {
-        printf("setting %s to \"%s\" (from environment variable %s)\n", name, env_value, env_name);
-        if (!ParseValue(env_value))
+        current_slot_[option->index] = (uint32_t)num_current_;
+    }
+    return entry;
+}
+
+/**
+ * @brief
+ *   find the entry of a static option,... there are few of them on a line, so they're just searched.
+ *
+ * @param[in] entries - entries of a line
+ * @param[in] count - number of entries
+ * @param[in] ref - static option
+ *
+ * @return line_option_t * - the entry, or NULL
+ */
+CmdLineDiffParser::line_option_t *CmdLineDiffParser::FindStatic(std::vector<line_option_t> &entries, size_t count,
+                                                               const static_option_ref_t &ref)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if ((entries[i].option == NULL) && (entries[i].ref.table == ref.table) && (entries[i].ref.index == ref.index))
         {
-            printf("error parsing '%s'\n", env_value);
-            CmdLineOptions::GetInstance()->Usage();
+            return &entries[i];
         }
-        OptionSet();
-        is_set = true;
     }
+    return NULL;
 }
 
 /**
  * @brief
- *   add an option to the global list of options
+ *   put an option of the previous line back to its default
  *
- * @param[in] option - option to add
+ * @param[in] entry - the option's entry
  */
-void CmdLineOptions::AddOption(CmdLineOption *option)
+void CmdLineDiffParser::Restore(const line_option_t &entry)
 {
-    _option_list.push_back(option);
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    if (entry.option == NULL)
+    {
+        registry->ResetStaticOption(entry.ref);
+    }
+    else
+    {
+        registry->ResetOption(entry.option);
+    }
 }
 
 /**
  * @brief
- *   parse command line options or generate error message
+ *   parse the arguments of an option into it and mark it as set
  *
- * @param[in] argc - number of arguments
- * @param[in] argv - argument strings
- * @param[in] error_message - error message
+ * @param[in] entry - the option's entry
  *
- * @return true if successful, false otherwise.
+ * @return true if the arguments parsed
  */
-bool CmdLineOptions::ParseOptionsOrError(int argc, const char **argv, std::ostream &error_message)
+bool CmdLineDiffParser::Apply(const line_option_t &entry)
 {
-    for (int i = 0; i < argc; i++)
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    CmdLineOption *option = entry.option;
+    if (option != NULL)
+    {
+        registry->Touch(option);
+    }
+    const char *end = entry.args.data() + entry.args.size();
+    for (const char *arg = entry.args.data(); arg < end; arg += strlen(arg) + 1)
     {
-        const char *s = argv[i];
+        char kind = *arg++;
         char token[100];
-        const char *val_str;
-        char *equals;
-
-        /* make the '-' optional */
-        if (s[0] == '-')
-        {
-            s++;
-        }
-        if (s[0] == '-')
+        const char *val_str = (kind == '\1') ? split_option_token(arg, token, sizeof(token)) : arg;
+        if (option == NULL)
         {
-            s++;
+            if (!registry->SetStaticOption(entry.ref, val_str))
+            {
+                return false;
+            }
         }
-        strncpy(token, s, 99);
-        equals = strchr(token, '=');
-        if (equals == NULL)
+        else if (((kind == '\2') || !option->is_list) && !option->TryParseValue(val_str))
         {
-            val_str = (char *)"";
+            return false;
         }
-        else
+        else if ((kind == '\1') && option->is_list && (*val_str == '@') && !option->MapFile(val_str + 1))
         {
-            *equals = 0;
-            equals++;
-            val_str = &s[equals - token];
+            return false;
         }
-        bool matched = false;
-        for (std::vector<CmdLineOption *>::const_iterator it = _option_list.begin(); it != _option_list.end(); ++it)
+    }
+    if (option != NULL)
+    {
+        if (option->is_list)
         {
-            CmdLineOption *option = *(it);
-            if (strcmp(token, option->name) == 0)
-            {
-                if (option->is_list)
-                {
-                    for (i = i + 1; i < argc; i++)
-                    {
-                        // for OptionFreeStringList, terminate the list
-                        // if you find something that looks like another command line option
-                        if (option->is_option_free_list)
-                        {
-                            if (MatchesAnOption(argv[i]))
-                            {
-                                i--;
-                                break;
-                            }
-                        }
-                        if (!option->ParseValueWithError(argv[i], error_message))
-                        {
-                            // if the next option doesn't match an option,
-                            // return an error message.
-                            if (!MatchesAnOption(argv[i]))
-                            {
-                                error_message << "error parsing \"" << argv[i] << "\""
-                                              << "\n";
-                                return false;
-                            }
-                            /* start parsing arguments again at 'i',... so back i up one... */
-                            i--;
-                            break;
-                        }
-                    }
-                    option->EndOfList();
-                }
-                else
-                {
-                    if (!option->ParseValueWithError(val_str, error_message))
-                    {
-                        error_message << "error parsing \"" << argv[i] << "\""
-                                      << "\n";
-                        return false;
-                    }
-                }
-                option->OptionSet();
-                option->is_set = true;
-                matched = true;
-            }
+            option->EndOfList();
         }
-        if (!matched)
+        registry->SetOption(option);
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   drop the entries of the current line
+ */
+void CmdLineDiffParser::ClearCurrent()
+{
+    for (size_t i = 0; i < num_current_; i++)
+    {
+        if (current_[i].option != NULL)
         {
-            error_message << "no match for option \"" << token << "\""
-                          << "\n";
-            ShowUsage(error_message);
-            return false;
+            current_slot_[current_[i].option->index] = 0;
         }
     }
-    return true;
+    num_current_ = 0;
 }
 
-CmdLineOptions::~CmdLineOptions()
+/**
+ * @brief
+ *   parse a line the ordinary way, Reset() and TryParseOptions(),... the next line is applied in full too.
+ *
+ *   the arguments are copied first, like the ones Parse() keeps, so string options don't point into argv.
+ *   the copy lasts until the next line is parsed in full, or reset.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - argument strings
+ * @param[out] error - what went wrong, if anything
+ */
+void CmdLineDiffParser::ParseInFull(int argc, const char **argv, parse_error_t *error)
 {
-    std::vector<const char *>::const_iterator it;
-    for (it = _tokens_allocated_by_ParseString.begin(); it != _tokens_allocated_by_ParseString.end(); ++it)
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    registry->Reset();
+    Forget();
+    // nothing points into the old copy after the Reset()
+    full_line_.clear();
+    for (int i = 0; i < argc; i++)
+    {
+        full_line_.insert(full_line_.end(), argv[i], argv[i] + strlen(argv[i]) + 1);
+    }
+    full_argv_.resize(argc);
+    size_t offset = 0;
+    for (int i = 0; i < argc; i++)
     {
-        const char *arg = *it;
-        free((void *)arg);
+        full_argv_[i] = &full_line_[offset];
+        offset += strlen(full_argv_[i]) + 1;
     }
-    _tokens_allocated_by_ParseString.clear();
+    registry->TryParseOptions(argc, full_argv_.data(), error);
+    changed = argc;
+}
+
+/**
+ * @brief
+ *   constructor
+ */
+CmdLineOptions::CmdLineOptions()
+    : _upstream_resource(NULL), _arena(NULL), _arena_upstream(NULL), _string_pool(NULL), _static_tables(NULL),
+      _synced_count(0), _selected(NULL), _epoch(1), _compiled_constraints(0), _batch(1)
+{
+    AddSectionTables();
+}
+
+CmdLineOptions::~CmdLineOptions()
+{
+    delete _arena;
+    delete _arena_upstream;
 }
\ No newline at end of file
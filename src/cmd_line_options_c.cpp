@@ -0,0 +1,223 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ * Source file of the C interface.
+ */
+
+#include "cmd_line_options_c.h"
+#include "cmd_line_options.h"
+
+static_assert(sizeof(bool) == 1, "cmdopt_option_t::set reads a bool as a byte");
+static_assert(((int)CMDOPT_TYPE_BOOL == CMD_LINE_OPTION_BOOL) && ((int)CMDOPT_TYPE_UINT64 == CMD_LINE_OPTION_UINT64) &&
+                  ((int)CMDOPT_TYPE_STRING_LIST == CMD_LINE_OPTION_STRING_LIST) &&
+                  ((int)CMDOPT_TYPE_CPU_SET == CMD_LINE_OPTION_CPU_SET),
+              "cmdopt_type_t doesn't match cmd_line_option_type_t");
+
+/// handles, by option index,... made the first time an option is looked up, and never freed
+static std::vector<cmdopt_option_t *> handles;
+
+/**
+ * @brief
+ *   find an option and get a handle for it
+ *
+ * @param[in] name - option name (list options have a ':' at the end of their name)
+ * @param[in] type - type the option must have, CMDOPT_TYPE_ANY to take any type
+ *
+ * @return cmdopt_handle_t - handle, NULL if there's no such option, or it has another type
+ */
+extern "C" cmdopt_handle_t cmdopt_find(const char *name, cmdopt_type_t type)
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    CmdLineOption *option = registry->FindOption(name);
+    if ((option == NULL) || ((type != CMDOPT_TYPE_ANY) && ((int)option->type != (int)type)))
+    {
+        return NULL;
+    }
+    if (handles.size() <= option->index)
+    {
+        handles.resize(registry->OptionCount(), NULL);
+    }
+    if (handles[option->index] != NULL)
+    {
+        return handles[option->index];
+    }
+    cmdopt_option_t *handle = new cmdopt_option_t;
+    handle->value = NULL;
+    handle->range_end = NULL;
+    handle->set = (const uint8_t *)&option->is_set;
+    handle->name = option->name;
+    handle->type = option->type;
+    handle->index = option->index;
+    handle->option = option;
+    switch (option->type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        handle->value = &((BoolOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_ENUM:
+        handle->value = &((EnumOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_INT:
+        handle->value = &((IntOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_UINT:
+        handle->value = &((UintOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_INT64:
+        handle->value = &((Int64Option *)option)->value;
+        break;
+    case CMD_LINE_OPTION_UINT64:
+        handle->value = &((Uint64Option *)option)->value;
+        break;
+    case CMD_LINE_OPTION_DOUBLE:
+        handle->value = &((DoubleOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_STRING:
+        handle->value = &((StringOption *)option)->value;
+        break;
+    case CMD_LINE_OPTION_INT_RANGE:
+        handle->value = &((IntRangeOption *)option)->start_value;
+        handle->range_end = &((IntRangeOption *)option)->end_value;
+        break;
+    default:
+        break;
+    }
+    handles[option->index] = handle;
+    return handle;
+}
+
+/**
+ * @brief
+ *   address of an option's value,... for code that can't use the inline getters, e.g. through an FFI.
+ *
+ * @param[in] handle - option
+ *
+ * @return const void * - the value, NULL for lists and user defined options
+ */
+extern "C" const void *cmdopt_value(cmdopt_handle_t handle)
+{
+    return handle->value;
+}
+
+/**
+ * @brief
+ *   get the values of a list option, without copying them (unless an int or string list has a file)
+ *
+ * @param[in] handle - option
+ * @param[in] type - type the list option must have
+ * @param[in] list - the option's list
+ * @param[out] values - first value, NULL if the option has another type
+ *
+ * @return size_t - number of values
+ */
+template <typename T>
+static size_t get_list(cmdopt_handle_t handle, cmd_line_option_type_t type, const std::vector<T> *list,
+                       const T **values)
+{
+    if ((handle->type != (int32_t)type) || (list == NULL))
+    {
+        *values = NULL;
+        return 0;
+    }
+    *values = list->data();
+    return list->size();
+}
+
+/**
+ * @brief
+ *   values of an IntListOption
+ *
+ * @param[in] handle - option
+ * @param[out] values - first value, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of values, 0 if the option isn't an IntListOption
+ */
+extern "C" size_t cmdopt_get_i32_list(cmdopt_handle_t handle, const int32_t **values)
+{
+    IntListOption *option = (IntListOption *)handle->option;
+    return get_list(handle, CMD_LINE_OPTION_INT_LIST,
+                    (handle->type == CMD_LINE_OPTION_INT_LIST) ? &option->Values() : NULL, values);
+}
+
+/**
+ * @brief
+ *   CPUs of a CpuSetOption
+ *
+ * @param[in] handle - option
+ * @param[out] values - first CPU, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of CPUs, 0 if the option isn't a CpuSetOption
+ */
+extern "C" size_t cmdopt_get_u32_list(cmdopt_handle_t handle, const uint32_t **values)
+{
+    CpuSetOption *option = (CpuSetOption *)handle->option;
+    return get_list(handle, CMD_LINE_OPTION_CPU_SET, (handle->type == CMD_LINE_OPTION_CPU_SET) ? &option->Cpus() : NULL,
+                    values);
+}
+
+/**
+ * @brief
+ *   values of an Int64ListOption
+ *
+ * @param[in] handle - option
+ * @param[out] values - first value, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of values, 0 if the option isn't an Int64ListOption
+ */
+extern "C" size_t cmdopt_get_i64_list(cmdopt_handle_t handle, const int64_t **values)
+{
+    Int64ListOption *option = (Int64ListOption *)handle->option;
+    return get_list(handle, CMD_LINE_OPTION_INT64_LIST,
+                    (handle->type == CMD_LINE_OPTION_INT64_LIST) ? &option->value_list_ : NULL, values);
+}
+
+/**
+ * @brief
+ *   values of a Uint64ListOption
+ *
+ * @param[in] handle - option
+ * @param[out] values - first value, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of values, 0 if the option isn't a Uint64ListOption
+ */
+extern "C" size_t cmdopt_get_u64_list(cmdopt_handle_t handle, const uint64_t **values)
+{
+    Uint64ListOption *option = (Uint64ListOption *)handle->option;
+    return get_list(handle, CMD_LINE_OPTION_UINT64_LIST,
+                    (handle->type == CMD_LINE_OPTION_UINT64_LIST) ? &option->value_list_ : NULL, values);
+}
+
+/**
+ * @brief
+ *   values of a DoubleListOption
+ *
+ * @param[in] handle - option
+ * @param[out] values - first value, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of values, 0 if the option isn't a DoubleListOption
+ */
+extern "C" size_t cmdopt_get_double_list(cmdopt_handle_t handle, const double **values)
+{
+    DoubleListOption *option = (DoubleListOption *)handle->option;
+    return get_list(handle, CMD_LINE_OPTION_DOUBLE_LIST,
+                    (handle->type == CMD_LINE_OPTION_DOUBLE_LIST) ? &option->value_list_ : NULL, values);
+}
+
+/**
+ * @brief
+ *   strings of a StringListOption (or OptionFreeStringListOption)
+ *
+ * @param[in] handle - option
+ * @param[out] values - first string, valid until the options are parsed or reset again
+ *
+ * @return size_t - number of strings, 0 if the option isn't a string list
+ */
+extern "C" size_t cmdopt_get_string_list(cmdopt_handle_t handle, const char *const **values)
+{
+    StringListOption *option = (StringListOption *)handle->option;
+    return get_list<const char *>(handle, CMD_LINE_OPTION_STRING_LIST,
+                                  (handle->type == CMD_LINE_OPTION_STRING_LIST) ? &option->Strings() : NULL,
+                                  values);
+}
@@ -0,0 +1,660 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ * Source file of the command line option control plane.
+ */
+
+#include "cmd_line_options_control.h"
+#include <errno.h>
+#include <poll.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief
+ *   constructor
+ */
+CmdLineOptionsControl::CmdLineOptionsControl() : listen_fd_(-1), sequence_(0)
+{
+    wake_pipe_[0] = -1;
+    wake_pipe_[1] = -1;
+    socket_path_[0] = 0;
+}
+
+/**
+ * @brief
+ *   destructor, stops the listener,... the string values 'set' stored go with it.
+ */
+CmdLineOptionsControl::~CmdLineOptionsControl()
+{
+    Stop();
+}
+
+/**
+ * @brief
+ *   start listening for commands on a UNIX domain socket
+ *
+ * @param[in] socket_path - path of the socket, an existing file at that path is removed.
+ *
+ * @return true if the listener was started.
+ */
+bool CmdLineOptionsControl::Start(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    if (thread_.joinable())
+    {
+        printf("control socket already started on '%s'\n", socket_path_);
+        return false;
+    }
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        printf("control socket path '%s' is too long\n", socket_path);
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0)
+    {
+        perror("socket");
+        return false;
+    }
+    unlink(socket_path);
+    if ((bind(listen_fd_, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(listen_fd_, 4) != 0) ||
+        (pipe(wake_pipe_) != 0))
+    {
+        perror(socket_path);
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    strcpy(socket_path_, socket_path);
+    // so the listener's lookups don't change the registry
+    CmdLineOptions::GetInstance()->Prepare();
+    thread_ = std::thread(&CmdLineOptionsControl::Listen, this);
+    return true;
+}
+
+/**
+ * @brief
+ *   stop the listener thread and remove the socket.
+ *
+ *   values set by the control plane stay valid until this object is destroyed.
+ */
+void CmdLineOptionsControl::Stop()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+    if (write(wake_pipe_[1], "x", 1) != 1)
+    {
+        perror("write");
+    }
+    thread_.join();
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+    close(listen_fd_);
+    wake_pipe_[0] = -1;
+    wake_pipe_[1] = -1;
+    listen_fd_ = -1;
+    unlink(socket_path_);
+    socket_path_[0] = 0;
+}
+
+/**
+ * @brief
+ *   listener thread, handles one connection at a time until Stop() is called.
+ */
+void CmdLineOptionsControl::Listen()
+{
+    for (;;)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = listen_fd_;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake_pipe_[0];
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("control socket poll");
+            return;
+        }
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept4(listen_fd_, NULL, NULL, SOCK_CLOEXEC);
+            if (fd >= 0)
+            {
+                Serve(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ *   read commands from a connection (one per line) and write the replies, until the client closes it.
+ *
+ * @param[in] fd - connected socket
+ */
+void CmdLineOptionsControl::Serve(int fd)
+{
+    std::string line;
+    char buffer[1024];
+    bool done = false;
+    while (!done)
+    {
+        struct pollfd fds[2];
+        fds[0].fd = fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake_pipe_[0];
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("control connection poll");
+            return;
+        }
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+            // treat an unterminated last line as a command
+            done = true;
+            if (line.empty())
+            {
+                break;
+            }
+            line += '\n';
+        }
+        else
+        {
+            line.append(buffer, n);
+        }
+        size_t newline;
+        while ((newline = line.find('\n')) != std::string::npos)
+        {
+            std::string command = line.substr(0, newline);
+            line.erase(0, newline + 1);
+            std::stringstream reply;
+            Command(command.c_str(), reply);
+            std::string s = reply.str();
+            if (write(fd, s.c_str(), s.size()) != (ssize_t)s.size())
+            {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ *   handle one command (see the class description)
+ *
+ *   this is what the listener thread calls for each line,
+ *   but it can also be called directly, e.g. from a debugger or a script interpreter.
+ *
+ * @param[in] command - command line, e.g. "set some_int=5 some_bool"
+ * @param[out] reply - reply, ends with "ok" or "error: ..."
+ *
+ * @return true if the command was successful
+ */
+bool CmdLineOptionsControl::Command(const char *command, std::ostream &reply)
+{
+    char *line = strdup(command);
+    char *args = line + strspn(line, " \t");
+    char *verb = args;
+    args += strcspn(args, " \t\r\n");
+    if (*args != 0)
+    {
+        *args++ = 0;
+    }
+    bool ok;
+    if (strcmp(verb, "set") == 0)
+    {
+        ok = Set(args, reply);
+    }
+    else if (strcmp(verb, "get") == 0)
+    {
+        ok = Get(args, reply);
+    }
+    else if (strcmp(verb, "dump") == 0)
+    {
+        ok = Dump(args, reply);
+    }
+    else
+    {
+        reply << "error: unknown command \"" << verb << "\", commands are set, get and dump"
+              << "\n";
+        ok = false;
+    }
+    if (ok)
+    {
+        reply << "ok"
+              << "\n";
+    }
+    free(line);
+    return ok;
+}
+
+/**
+ * @brief
+ *   new value of an option, parsed but not yet stored
+ */
+typedef struct
+{
+    CmdLineOption *option; ///< option to change
+    union
+    {
+        bool b;           ///< BoolOption
+        uint32_t u32;     ///< EnumOption, UintOption
+        int32_t i32;      ///< IntOption
+        int64_t i64;      ///< Int64Option
+        uint64_t u64;     ///< Uint64Option
+        double d;         ///< DoubleOption
+        const char *s;    ///< StringOption
+        int32_t range[3]; ///< IntRangeOption, start, end and size
+    } value;
+} control_update_t;
+
+/**
+ * @brief
+ *   parse a value on a copy of an option, so the option itself isn't touched
+ *
+ * @param[in] option - option
+ * @param[in] field - the option's value
+ * @param[in] s - value string
+ * @param[out] value - parsed value
+ *
+ * @return true if the value is valid
+ */
+template <typename O, typename T>
+static bool parse_copy(CmdLineOption *option, T O::*field, const char *s, T *value)
+{
+    O copy(*(O *)option);
+    if (!copy.ParseValue(s))
+    {
+        return false;
+    }
+    *value = copy.*field;
+    return true;
+}
+
+/**
+ * @brief
+ *   parse a new value for an option
+ *
+ * @param[in] s - value string
+ * @param[in] strings - pool for string values
+ * @param[out] update - new value, update->option says which option
+ *
+ * @return true if the value is valid
+ */
+static bool parse_update(const char *s, StringPool *strings, control_update_t *update)
+{
+    CmdLineOption *option = update->option;
+    switch (option->type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        return parse_copy(option, &BoolOption::value, s, &update->value.b);
+    case CMD_LINE_OPTION_ENUM:
+        return parse_copy(option, &EnumOption::value, s, &update->value.u32);
+    case CMD_LINE_OPTION_INT:
+        return parse_copy(option, &IntOption::value, s, &update->value.i32);
+    case CMD_LINE_OPTION_UINT:
+        return parse_copy(option, &UintOption::value, s, &update->value.u32);
+    case CMD_LINE_OPTION_INT64:
+        return parse_copy(option, &Int64Option::value, s, &update->value.i64);
+    case CMD_LINE_OPTION_UINT64:
+        return parse_copy(option, &Uint64Option::value, s, &update->value.u64);
+    case CMD_LINE_OPTION_DOUBLE:
+        return parse_copy(option, &DoubleOption::value, s, &update->value.d);
+    case CMD_LINE_OPTION_INT_RANGE: {
+        IntRangeOption copy(*(IntRangeOption *)option);
+        if (!copy.ParseValue(s))
+        {
+            return false;
+        }
+        update->value.range[0] = copy.start_value;
+        update->value.range[1] = copy.end_value;
+        update->value.range[2] = copy.size;
+        return true;
+    }
+    case CMD_LINE_OPTION_STRING:
+        if (!parse_copy(option, &StringOption::value, s, &update->value.s))
+        {
+            return false;
+        }
+        if (update->value.s == s)
+        {
+            // s is gone after the command, the registry's pool (if there is one) has already made a copy
+            update->value.s = strings->Intern(s);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief
+ *   store a value so a reader using CmdLineOptionsControl::Load() never sees half of it
+ *
+ * @param[out] field - the option's value
+ * @param[in] value - new value
+ */
+template <typename T>
+static void store(T *field, T value)
+{
+    __atomic_store(field, &value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *   set options,... every value is parsed before any option is changed, so a command changes all of them or none.
+ *
+ * @param[in] args - space separated name=value pairs, modified in place.
+ * @param[out] reply - error message
+ *
+ * @return true if all the options were set
+ */
+bool CmdLineOptionsControl::Set(char *args, std::ostream &reply)
+{
+    std::vector<control_update_t> updates;
+    bool ok = true;
+    char *save_ptr;
+    for (char *s = strtok_r(args, " \t\r\n", &save_ptr); ok && (s != NULL); s = strtok_r(NULL, " \t\r\n", &save_ptr))
+    {
+        char token[100];
+        const char *val_str = split_option_token(s, token, sizeof(token));
+        control_update_t update;
+        update.option = CmdLineOptions::GetInstance()->FindOption(token);
+        ok = false;
+        if (update.option == NULL)
+        {
+            reply << "error: no match for option \"" << token << "\""
+                  << "\n";
+        }
+        else if (update.option->is_list)
+        {
+            reply << "error: list option '" << update.option->name << "' can't be changed while running"
+                  << "\n";
+        }
+        else if (update.option->type == CMD_LINE_OPTION_OTHER || update.option->type == CMD_LINE_OPTION_GROUP ||
+                 update.option->type == CMD_LINE_OPTION_ADDR_MASK ||
+                 update.option->type == CMD_LINE_OPTION_SUBCOMMAND || update.option->type == CMD_LINE_OPTION_CPU_SET)
+        {
+            reply << "error: option '" << update.option->name << "' can't be changed while running"
+                  << "\n";
+        }
+        else if (!parse_update(val_str, &strings_, &update))
+        {
+            reply << "error: error parsing \"" << s << "\" for option '" << update.option->name << "'"
+                  << "\n";
+        }
+        else
+        {
+            updates.push_back(update);
+            ok = true;
+        }
+    }
+    if (!ok)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    sequence_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::vector<control_update_t>::const_iterator it = updates.begin(); it != updates.end(); ++it)
+    {
+        CmdLineOption *option = it->option;
+        switch (option->type)
+        {
+        case CMD_LINE_OPTION_BOOL:
+            store(&((BoolOption *)option)->value, it->value.b);
+            break;
+        case CMD_LINE_OPTION_ENUM:
+            store(&((EnumOption *)option)->value, it->value.u32);
+            break;
+        case CMD_LINE_OPTION_INT:
+            store(&((IntOption *)option)->value, it->value.i32);
+            break;
+        case CMD_LINE_OPTION_UINT:
+            store(&((UintOption *)option)->value, it->value.u32);
+            break;
+        case CMD_LINE_OPTION_INT64:
+            store(&((Int64Option *)option)->value, it->value.i64);
+            break;
+        case CMD_LINE_OPTION_UINT64:
+            store(&((Uint64Option *)option)->value, it->value.u64);
+            break;
+        case CMD_LINE_OPTION_DOUBLE:
+            store(&((DoubleOption *)option)->value, it->value.d);
+            break;
+        case CMD_LINE_OPTION_INT_RANGE:
+            store(&((IntRangeOption *)option)->start_value, it->value.range[0]);
+            store(&((IntRangeOption *)option)->end_value, it->value.range[1]);
+            store(&((IntRangeOption *)option)->size, it->value.range[2]);
+            break;
+        case CMD_LINE_OPTION_STRING:
+            store(&((StringOption *)option)->value, it->value.s);
+            break;
+        default:
+            break;
+        }
+        // the registry is told by Apply(), on the thread that owns it
+        applied_.push_back(option);
+    }
+    sequence_.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief
+ *   mark the options 'set' changed since the last call as set in the registry, and tell their observers
+ *
+ *   call this from the thread that parses the options (or otherwise owns the registry),... the listener thread
+ *   only stores the values, since the registry's bookkeeping isn't thread safe.  the observers get one
+ *   notification for everything since the last call, and their OptionsChanged() runs on this thread.
+ *
+ * @return size_t - number of options marked (an option set twice is marked twice)
+ */
+size_t CmdLineOptionsControl::Apply()
+{
+    std::vector<CmdLineOption *> applied;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        applied.swap(applied_);
+    }
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    for (std::vector<CmdLineOption *>::const_iterator it = applied.begin(); it != applied.end(); ++it)
+    {
+        registry->SetOption(*it);
+    }
+    registry->NotifyObservers();
+    return applied.size();
+}
+
+/**
+ * @brief
+ *   show the values of some options
+ *
+ * @param[in] args - space separated option names, modified in place.
+ * @param[out] reply - option values, one per line
+ *
+ * @return true if all the options were found
+ */
+bool CmdLineOptionsControl::Get(char *args, std::ostream &reply)
+{
+    char *save_ptr;
+    for (char *s = strtok_r(args, " \t\r\n", &save_ptr); s != NULL; s = strtok_r(NULL, " \t\r\n", &save_ptr))
+    {
+        CmdLineOption *option = CmdLineOptions::GetInstance()->FindOption(s);
+        if (option == NULL)
+        {
+            reply << "error: no match for option \"" << s << "\""
+                  << "\n";
+            return false;
+        }
+        reply << option->name << (option->is_list ? " " : "=");
+        option->ShowValue(reply);
+        reply << "\n";
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   show the values of all options, or of the options in a namespace
+ *
+ * @param[in] args - namespace, e.g. "dma.*", or nothing for all options, modified in place.
+ * @param[out] reply - option values, one per line
+ *
+ * @return true if there are options to show
+ */
+bool CmdLineOptionsControl::Dump(char *args, std::ostream &reply)
+{
+    char *save_ptr;
+    const char *pattern = strtok_r(args, " \t\r\n", &save_ptr);
+    std::vector<CmdLineOption *> options;
+    if (pattern == NULL)
+    {
+        CmdLineOptions *registry = CmdLineOptions::GetInstance();
+        for (size_t i = 0; i < registry->OptionCount(); i++)
+        {
+            CmdLineOption *option = registry->GetOption(i);
+            // skip OptionGroup's
+            if (*option->name != 0)
+            {
+                options.push_back(option);
+            }
+        }
+    }
+    else if (CmdLineOptions::GetInstance()->NamespaceOptions(pattern, options) == 0)
+    {
+        reply << "error: no options in namespace \"" << pattern << "\""
+              << "\n";
+        return false;
+    }
+    for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+    {
+        reply << (*it)->name << ((*it)->is_list ? " " : "=");
+        (*it)->ShowValue(reply);
+        reply << "\n";
+    }
+    return true;
+}
+
+/**
+ * @brief
+ *   start reading a consistent set of option values
+ *
+ * @return sequence number to pass to ReadRetry()
+ */
+uint32_t CmdLineOptionsControl::ReadBegin()
+{
+    uint32_t sequence;
+    // an odd sequence number means a 'set' is in progress
+    while ((sequence = sequence_.load(std::memory_order_acquire)) & 1)
+    {
+    }
+    return sequence;
+}
+
+/**
+ * @brief
+ *   check if the values read since ReadBegin() may have been changed
+ *
+ * @param[in] sequence - value returned by ReadBegin()
+ *
+ * @return true if the values must be read again.
+ */
+bool CmdLineOptionsControl::ReadRetry(uint32_t sequence)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequence_.load(std::memory_order_relaxed) != sequence;
+}
+
+/**
+ * @brief
+ *   send a command to a process that is listening with CmdLineOptionsControl::Start()
+ *
+ * @param[in] socket_path - path of the socket
+ * @param[in] command - command, e.g. "get some_int"
+ * @param[out] reply - reply from the process
+ *
+ * @return true if the command was successful
+ */
+bool CmdLineOptionsControl::Send(const char *socket_path, const char *command, std::ostream &reply)
+{
+    struct sockaddr_un addr;
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        reply << "error: control socket path '" << socket_path << "' is too long"
+              << "\n";
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        reply << "error: socket() failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        reply << "error: can't connect to '" << socket_path << "': " << strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    std::string line = command;
+    line += '\n';
+    if (write(fd, line.c_str(), line.size()) != (ssize_t)line.size())
+    {
+        reply << "error: write failed: " << strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+    std::string response;
+    char buffer[1024];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        response.append(buffer, n);
+    }
+    close(fd);
+    reply << response;
+    // the last line of the reply is "ok" if the command was successful
+    size_t last_line = response.rfind('\n', response.size() >= 2 ? response.size() - 2 : 0);
+    last_line = (last_line == std::string::npos) ? 0 : last_line + 1;
+    return response.compare(last_line, std::string::npos, "ok\n") == 0;
+}
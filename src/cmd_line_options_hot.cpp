@@ -0,0 +1,278 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ * Source file of the read-mostly copies of hot option values.
+ */
+
+#include "cmd_line_options_hot.h"
+#include <dirent.h>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#endif
+#include <new>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// values per cache line
+static const uint32_t HOT_VALUES_PER_LINE = 64 / sizeof(uint64_t);
+
+/**
+ * @brief
+ *   read the list of CPUs of a NUMA node, e.g. "0-3,8-11"
+ *
+ * @param[in] node - node number
+ * @param[out] cpus - CPUs of the node
+ *
+ * @return true if the list could be read.
+ */
+static bool read_node_cpus(uint32_t node, std::vector<uint32_t> &cpus)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    char line[4096];
+    bool ok = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    for (char *s = line; ok && (*s >= '0') && (*s <= '9');)
+    {
+        uint32_t first = strtoul(s, &s, 10);
+        uint32_t last = (*s == '-') ? strtoul(s + 1, &s, 10) : first;
+        for (uint32_t cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+        s += (*s == ',');
+    }
+    return ok;
+}
+
+/**
+ * @brief
+ *   constructor
+ *
+ * @param[in] _options - options to keep copies of, a value is read by its position in this list
+ * @param[in] _policy - how many copies to keep
+ */
+HotOptions::HotOptions(std::initializer_list<CmdLineOption *> _options, hot_replica_t _policy)
+    : OptionObserver(_options), policy_(_policy), mapped_bytes_(0), num_replicas_(0), hot_()
+{
+}
+
+HotOptions::~HotOptions()
+{
+    if (hot_.values != NULL)
+    {
+        munmap(hot_.values, mapped_bytes_);
+    }
+}
+
+/**
+ * @brief
+ *   CPU the calling thread is running on
+ *
+ * @return int32_t - CPU number
+ */
+int32_t HotOptions::CurrentCpu()
+{
+    int cpu = sched_getcpu();
+    return (cpu < 0) ? 0 : cpu;
+}
+
+/**
+ * @brief
+ *   the value of an option as 64 bits
+ *
+ * @param[in] option - option
+ *
+ * @return uint64_t - value, 0 if the option type can't be hot
+ */
+uint64_t HotOptions::ValueBits(const CmdLineOption *option)
+{
+    uint64_t bits = 0;
+    switch (option->type)
+    {
+    case CMD_LINE_OPTION_BOOL:
+        return ((const BoolOption *)option)->value;
+    case CMD_LINE_OPTION_INT:
+        return (uint64_t)(int64_t)((const IntOption *)option)->value;
+    case CMD_LINE_OPTION_UINT:
+        return ((const UintOption *)option)->value;
+    case CMD_LINE_OPTION_INT64:
+        return (uint64_t)((const Int64Option *)option)->value;
+    case CMD_LINE_OPTION_UINT64:
+        return ((const Uint64Option *)option)->value;
+    case CMD_LINE_OPTION_DOUBLE:
+        memcpy(&bits, &((const DoubleOption *)option)->value, sizeof(bits));
+        return bits;
+    case CMD_LINE_OPTION_ENUM:
+        return ((const EnumOption *)option)->value;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief
+ *   work out how many copies to keep and which CPU reads which, then map the memory for them
+ *
+ *   with a copy per node, each copy gets its own pages, and they're bound to the node before they're touched.
+ *   the CPU table goes on the lines after the last copy, so nothing the readers look at is near anything written.
+ */
+void HotOptions::Allocate()
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    num_cpus = (num_cpus < 1) ? 1 : (num_cpus > UINT16_MAX) ? UINT16_MAX : num_cpus;
+    std::vector<uint16_t> cpu_replica(num_cpus, 0);
+    std::vector<uint32_t> nodes;
+    num_replicas_ = 1;
+    if (policy_ == HOT_REPLICA_PER_CPU)
+    {
+        num_replicas_ = num_cpus;
+        for (long cpu = 0; cpu < num_cpus; cpu++)
+        {
+            cpu_replica[cpu] = cpu;
+        }
+    }
+    else if (policy_ == HOT_REPLICA_PER_NODE)
+    {
+        DIR *dir = opendir("/sys/devices/system/node");
+        for (struct dirent *entry = (dir != NULL) ? readdir(dir) : NULL; entry != NULL; entry = readdir(dir))
+        {
+            unsigned node;
+            std::vector<uint32_t> cpus;
+            if ((sscanf(entry->d_name, "node%u", &node) != 1) || !read_node_cpus(node, cpus) || cpus.empty())
+            {
+                continue;
+            }
+            for (std::vector<uint32_t>::const_iterator it = cpus.begin(); it != cpus.end(); ++it)
+            {
+                if (*it < cpu_replica.size())
+                {
+                    cpu_replica[*it] = nodes.size();
+                }
+            }
+            nodes.push_back(node);
+        }
+        if (dir != NULL)
+        {
+            closedir(dir);
+        }
+        num_replicas_ = nodes.empty() ? 1 : nodes.size();
+    }
+
+    uint32_t round = HOT_VALUES_PER_LINE;
+    if (nodes.size() > 1)
+    {
+        round = sysconf(_SC_PAGESIZE) / sizeof(uint64_t);
+    }
+    uint32_t stride = (options_.size() + round - 1) / round * round;
+    stride = (stride == 0) ? round : stride;
+    size_t values_bytes = (size_t)stride * num_replicas_ * sizeof(uint64_t);
+    mapped_bytes_ = values_bytes + (num_cpus * sizeof(uint16_t) + 63) / 64 * 64;
+    void *memory = mmap(NULL, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        abort();
+    }
+#ifdef __linux__
+    for (uint32_t r = 0; (nodes.size() > 1) && (r < num_replicas_); r++)
+    {
+        // a preference, not a rule,... if the node is short of memory the copy goes somewhere else
+        std::vector<unsigned long> mask(nodes[r] / (8 * sizeof(unsigned long)) + 1, 0);
+        mask[nodes[r] / (8 * sizeof(unsigned long))] |= 1ul << (nodes[r] % (8 * sizeof(unsigned long)));
+        syscall(SYS_mbind, (char *)memory + (size_t)r * stride * sizeof(uint64_t), stride * sizeof(uint64_t),
+                MPOL_PREFERRED, mask.data(), mask.size() * 8 * sizeof(unsigned long), 0);
+    }
+#endif
+    std::atomic<uint64_t> *values = (std::atomic<uint64_t> *)memory;
+    for (size_t i = 0; i < (size_t)stride * num_replicas_; i++)
+    {
+        new (&values[i]) std::atomic<uint64_t>(0);
+    }
+    uint16_t *table = (uint16_t *)((char *)memory + values_bytes);
+    memcpy(table, cpu_replica.data(), num_cpus * sizeof(uint16_t));
+    hot_.values = values;
+    hot_.cpu_replica = table;
+    hot_.num_cpus = num_cpus;
+    hot_.stride = stride;
+}
+
+/**
+ * @brief
+ *   copy every value into every copy,... call this after parsing, before the readers start.
+ */
+void HotOptions::Load()
+{
+    if (num_replicas_ == 0)
+    {
+        Allocate();
+    }
+    for (uint32_t slot = 0; slot < options_.size(); slot++)
+    {
+        switch (options_[slot]->type)
+        {
+        case CMD_LINE_OPTION_BOOL:
+        case CMD_LINE_OPTION_INT:
+        case CMD_LINE_OPTION_UINT:
+        case CMD_LINE_OPTION_INT64:
+        case CMD_LINE_OPTION_UINT64:
+        case CMD_LINE_OPTION_DOUBLE:
+        case CMD_LINE_OPTION_ENUM:
+            break;
+        default:
+            printf("option '%s' can't be hot\n", options_[slot]->name);
+            break;
+        }
+        Store(slot);
+    }
+}
+
+/**
+ * @brief
+ *   write the value of an option into every copy
+ *
+ * @param[in] slot - position of the option in the list
+ */
+void HotOptions::Store(uint32_t slot)
+{
+    uint64_t bits = ValueBits(options_[slot]);
+    for (uint32_t r = 0; r < num_replicas_; r++)
+    {
+        hot_.values[(size_t)r * hot_.stride + slot].store(bits, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief
+ *   some of the options were set,... update their copies
+ *
+ * @param[in] changed - options that were set
+ */
+void HotOptions::OptionsChanged(const std::vector<CmdLineOption *> &changed)
+{
+    if (num_replicas_ == 0)
+    {
+        return;
+    }
+    for (std::vector<CmdLineOption *>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    {
+        for (uint32_t slot = 0; slot < options_.size(); slot++)
+        {
+            if (options_[slot] == *it)
+            {
+                Store(slot);
+            }
+        }
+    }
+}
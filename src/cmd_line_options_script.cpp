@@ -0,0 +1,739 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ * Source file of the parallel option script runner.
+ */
+
+#include "cmd_line_options_script.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief
+ *   where one line's arguments are in its chunk, and what's wrong with it
+ */
+typedef struct
+{
+    uint64_t number;     ///< line number in the chunk, the first line is 0
+    uint32_t first_arg;  ///< index of the first argument in script_chunk_t::argv
+    uint32_t argc;       ///< number of arguments
+    uint32_t first_step; ///< index of the line's first option in script_chunk_t::steps
+    uint32_t num_steps;  ///< number of options on the line
+    parse_error_t error; ///< what the worker found wrong with the line
+} script_line_t;
+
+/**
+ * @brief
+ *   a chunk of whole lines, split into arguments and checked by a worker thread
+ */
+typedef struct
+{
+    const char *start;                ///< first byte of the chunk in the file
+    const char *end;                  ///< end of the chunk, just after a '\n' or the end of the file
+    uint64_t num_lines;               ///< number of lines in the chunk, including empty ones
+    std::vector<char> text;           ///< copy of the chunk, each argument ends with a 0
+    std::vector<const char *> argv;   ///< arguments of every line
+    std::vector<script_line_t> lines; ///< lines that aren't empty
+    std::vector<script_step_t> steps; ///< options of the good lines, found by the worker
+    bool ready;                       ///< the worker is done with the chunk
+} script_chunk_t;
+
+/**
+ * @brief
+ *   constructor
+ */
+CmdLineOptionsScript::CmdLineOptionsScript()
+    : chunk_size(1 << 20), chunks_per_thread(2), incremental(false), fd_(-1), data_(NULL), size_(0), chunks_(NULL),
+      num_slots_(0), next_start_(NULL), next_chunk_(0), consumed_(0), stop_(false)
+{
+}
+
+/**
+ * @brief
+ *   destructor, unmaps the file
+ */
+CmdLineOptionsScript::~CmdLineOptionsScript()
+{
+    Close();
+}
+
+/**
+ * @brief
+ *   map a script file
+ *
+ * @param[in] path - path of the script
+ *
+ * @return true if the file was mapped
+ */
+bool CmdLineOptionsScript::Open(const char *path)
+{
+    Close();
+    fd_ = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0)
+    {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0)
+    {
+        perror(path);
+        Close();
+        return false;
+    }
+    size_ = st.st_size;
+    if (size_ == 0)
+    {
+        return true;
+    }
+    void *data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED)
+    {
+        perror(path);
+        size_ = 0;
+        Close();
+        return false;
+    }
+    data_ = (const char *)data;
+    // the file is read front to back, once
+    madvise(data, size_, MADV_SEQUENTIAL);
+    return true;
+}
+
+/**
+ * @brief
+ *   unmap the script file
+ */
+void CmdLineOptionsScript::Close()
+{
+    if (data_ != NULL)
+    {
+        munmap((void *)data_, size_);
+        data_ = NULL;
+    }
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
+
+/**
+ * @brief
+ *   parse every line into the options, in order, and call the callback for each one.
+ *
+ *   the options are reset before each line.  a line with an error isn't parsed into the options,
+ *   the callback gets the error (CmdLineOptions::RenderError() makes a message out of it).
+ *
+ * @param[in] callback - function to call for each line (on the calling thread)
+ * @param[in] arg - passed to the callback
+ * @param[in] num_threads - number of worker threads, 0 for one per CPU
+ *
+ * @return true if the whole script ran, false if the callback stopped it.
+ */
+bool CmdLineOptionsScript::Run(script_callback_t callback, void *arg, uint32_t num_threads)
+{
+    return Process(callback, arg, num_threads, false);
+}
+
+/**
+ * @brief
+ *   what Check() passes to check_line()
+ */
+typedef struct
+{
+    std::ostream *errors; ///< where the errors go
+    uint64_t bad_lines;   ///< number of bad lines so far
+} script_check_t;
+
+/**
+ * @brief
+ *   called by Check() for every line
+ *
+ * @param[in] line - line
+ * @param[in] arg - script_check_t
+ *
+ * @return bool - always true, keep going
+ */
+static bool check_line(const ScriptLine &line, void *arg)
+{
+    if (line.error.code == PARSE_ERROR_NONE)
+    {
+        return true;
+    }
+    script_check_t *check = (script_check_t *)arg;
+    check->bad_lines++;
+    // one line per error, like the control plane,... RenderError() would parse the bad value into the option
+    const char *arg_str = line.argv[line.error.arg_index];
+    char token[100];
+    split_option_token(arg_str, token, sizeof(token));
+    *check->errors << "line " << line.number << ": ";
+    if (line.error.code == PARSE_ERROR_NO_MATCH)
+    {
+        *check->errors << "no match for option \"" << token << "\""
+                       << "\n";
+        return true;
+    }
+    // static options aren't in the registry, and a bad value is in the option's own argument
+    const char *name = (line.error.option_index >= 0)
+                           ? CmdLineOptions::GetInstance()->GetOption(line.error.option_index)->name
+                           : token;
+    *check->errors << "error parsing \"" << arg_str << "\" for option '" << name << "'"
+                   << "\n";
+    return true;
+}
+
+/**
+ * @brief
+ *   check every line without changing any option
+ *
+ * @param[out] errors - what's wrong with each bad line
+ * @param[in] num_threads - number of worker threads, 0 for one per CPU
+ *
+ * @return uint64_t - number of bad lines
+ */
+uint64_t CmdLineOptionsScript::Check(std::ostream &errors, uint32_t num_threads)
+{
+    script_check_t check = {&errors, 0};
+    Process(check_line, &check, num_threads, true);
+    return check.bad_lines;
+}
+
+/**
+ * @brief
+ *   run the workers, and hand the lines to the callback in order
+ *
+ * @param[in] callback - function to call for each line
+ * @param[in] arg - passed to the callback
+ * @param[in] num_threads - number of worker threads, 0 for one per CPU
+ * @param[in] check_only - don't parse the lines into the options
+ *
+ * @return true if the whole script was processed, false if the callback stopped it.
+ */
+bool CmdLineOptionsScript::Process(script_callback_t callback, void *arg, uint32_t num_threads, bool check_only)
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    // the workers get their own copy of the names
+    registry->Prepare();
+    Freeze();
+    if (num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    if (num_threads == 0)
+    {
+        num_threads = 1;
+    }
+    std::vector<script_chunk_t> chunks(num_threads * std::max<uint32_t>(chunks_per_thread, 1));
+    chunks_ = chunks.data();
+    num_slots_ = chunks.size();
+    next_start_ = data_;
+    next_chunk_ = 0;
+    consumed_ = 0;
+    stop_ = false;
+    // the first line is applied in full, after a Reset(), like every line without incremental
+    diff_.Forget();
+    if (!check_only && !incremental)
+    {
+        // whatever the program set directly before the run goes too, the lines only reset what they touched
+        registry->Reset();
+    }
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        threads.push_back(std::thread(&CmdLineOptionsScript::Worker, this));
+    }
+    uint64_t line_base = 0;
+    bool stopped = false;
+    while (!stopped)
+    {
+        script_chunk_t &chunk = chunks[consumed_ % num_slots_];
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // the chunk is either being parsed, or there are no more chunks
+            while (!chunk.ready && (consumed_ < next_chunk_ || next_start_ != data_ + size_))
+            {
+                chunk_done_.wait(lock);
+            }
+            if (!chunk.ready)
+            {
+                break;
+            }
+        }
+        for (std::vector<script_line_t>::const_iterator it = chunk.lines.begin(); it != chunk.lines.end(); ++it)
+        {
+            ScriptLine line;
+            line.number = line_base + it->number + 1;
+            line.argc = it->argc;
+            line.argv = &chunk.argv[it->first_arg];
+            line.error = it->error;
+            if (!check_only && incremental)
+            {
+                if (line.error.code == PARSE_ERROR_NONE)
+                {
+                    diff_.Parse(line.argc, line.argv, &line.error);
+                }
+            }
+            else if (!check_only)
+            {
+                // only what the line before (or the callback, with Touch()) changed needs putting back
+                registry->ResetTouched();
+                if (line.error.code == PARSE_ERROR_NONE)
+                {
+                    if (!ApplyLine(&chunk.steps[it->first_step], it->num_steps, line.argv, &line.error) &&
+                        (line.error.code != PARSE_ERROR_CONSTRAINT))
+                    {
+                        // a value the worker couldn't check,... the parser finds out what's wrong
+                        registry->ResetTouched();
+                        registry->TryParseOptions(line.argc, line.argv, &line.error);
+                    }
+                    registry->NotifyObservers();
+                }
+                else if ((line.error.code != PARSE_ERROR_NO_MATCH) && (line.error.option_index >= 0))
+                {
+                    // like the parser, so the next reset undoes whatever RenderError() leaves in the option
+                    registry->Touch(registry->GetOption(line.error.option_index));
+                }
+            }
+            if (!callback(line, arg))
+            {
+                stopped = true;
+                break;
+            }
+        }
+        line_base += chunk.num_lines;
+        // the pages of the file that are done with aren't needed again
+        size_t page = sysconf(_SC_PAGESIZE);
+        uintptr_t first_page = ((uintptr_t)chunk.start + page - 1) & ~(page - 1);
+        uintptr_t end_page = (uintptr_t)chunk.end & ~(page - 1);
+        if (end_page > first_page)
+        {
+            madvise((void *)first_page, end_page - first_page, MADV_DONTNEED);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk.ready = false;
+        consumed_++;
+        slot_free_.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        slot_free_.notify_all();
+    }
+    for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        it->join();
+    }
+    chunks_ = NULL;
+    // options still point into the chunks, which are gone
+    if (!check_only)
+    {
+        registry->Reset();
+    }
+    return !stopped;
+}
+
+/**
+ * @brief
+ *   worker thread, takes the next chunk of the file and parses it, until the file is done.
+ */
+void CmdLineOptionsScript::Worker()
+{
+    script_chunk_t *chunks = (script_chunk_t *)chunks_;
+    const char *file_end = data_ + size_;
+    for (;;)
+    {
+        script_chunk_t *chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // don't get too far ahead of the calling thread
+            while (!stop_ && (next_start_ != file_end) && (next_chunk_ >= consumed_ + num_slots_))
+            {
+                slot_free_.wait(lock);
+            }
+            if (stop_ || (next_start_ == file_end))
+            {
+                return;
+            }
+            chunk = &chunks[next_chunk_ % num_slots_];
+            next_chunk_++;
+            chunk->start = next_start_;
+            // end the chunk at the end of a line
+            const char *end = next_start_ + std::min(chunk_size, (size_t)(file_end - next_start_));
+            if (end != file_end)
+            {
+                const char *newline = (const char *)memchr(end - 1, '\n', file_end - end + 1);
+                end = (newline == NULL) ? file_end : newline + 1;
+            }
+            chunk->end = end;
+            next_start_ = end;
+        }
+        ParseChunk(chunk);
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk->ready = true;
+        chunk_done_.notify_all();
+    }
+}
+
+/**
+ * @brief
+ *   copy a chunk, split it into lines and arguments, and check each line
+ *
+ * @param[in,out] chunk_ptr - script_chunk_t
+ */
+void CmdLineOptionsScript::ParseChunk(void *chunk_ptr)
+{
+    script_chunk_t *chunk = (script_chunk_t *)chunk_ptr;
+    size_t size = chunk->end - chunk->start;
+    // the vectors keep their capacity from the last chunk in this slot
+    chunk->text.resize(size + 1);
+    memcpy(chunk->text.data(), chunk->start, size);
+    chunk->text[size] = '\n';
+    chunk->argv.clear();
+    chunk->lines.clear();
+    chunk->steps.clear();
+    chunk->num_lines = 0;
+    char *s = chunk->text.data();
+    char *end = s + size;
+    while (s < end)
+    {
+        script_line_t line;
+        line.number = chunk->num_lines++;
+        line.first_arg = chunk->argv.size();
+        for (;;)
+        {
+            while ((*s == ' ') || (*s == '\t') || (*s == '\r'))
+            {
+                *s++ = 0;
+            }
+            if (*s == '\n')
+            {
+                *s++ = 0;
+                break;
+            }
+            chunk->argv.push_back(s);
+            while ((*s != ' ') && (*s != '\t') && (*s != '\r') && (*s != '\n'))
+            {
+                s++;
+            }
+        }
+        line.argc = chunk->argv.size() - line.first_arg;
+        if (line.argc != 0)
+        {
+            chunk->lines.push_back(line);
+        }
+    }
+    // check the lines once argv stops moving
+    for (std::vector<script_line_t>::iterator it = chunk->lines.begin(); it != chunk->lines.end(); ++it)
+    {
+        it->first_step = chunk->steps.size();
+        if (!CheckLine(it->argc, &chunk->argv[it->first_arg], &it->error, &chunk->steps))
+        {
+            chunk->steps.resize(it->first_step);
+        }
+        it->num_steps = chunk->steps.size() - it->first_step;
+    }
+}
+
+/**
+ * @brief
+ *   copy what the workers need to know about the registered options, before they start
+ */
+void CmdLineOptionsScript::Freeze()
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    options_.clear();
+    std::vector<uint32_t> owner(registry->OptionCount(), 0);
+    std::vector<uint32_t> subcommand(registry->OptionCount(), 0);
+    uint32_t num_subcommands = 0;
+    for (uint32_t i = 0; i < registry->OptionCount(); i++)
+    {
+        CmdLineOption *option = registry->GetOption(i);
+        if (option->type == CMD_LINE_OPTION_SUBCOMMAND)
+        {
+            subcommand[i] = ++num_subcommands;
+            const std::vector<CmdLineOption *> &options = ((Subcommand *)option)->options_;
+            for (std::vector<CmdLineOption *>::const_iterator it = options.begin(); it != options.end(); ++it)
+            {
+                if (((*it)->index < owner.size()) && (registry->GetOption((*it)->index) == *it))
+                {
+                    owner[(*it)->index] = num_subcommands;
+                }
+            }
+        }
+    }
+    size_t table_size = 16;
+    while (table_size < 2 * registry->OptionCount())
+    {
+        table_size *= 2;
+    }
+    table_.assign(table_size, 0);
+    for (uint32_t i = 0; i < registry->OptionCount(); i++)
+    {
+        CmdLineOption *option = registry->GetOption(i);
+        // skip OptionGroup's
+        if (*option->name == 0)
+        {
+            continue;
+        }
+        uint32_t length;
+        script_option_t entry;
+        entry.option = option;
+        entry.name = option->name;
+        entry.hash = (uint32_t)option_name_hash(option->name, &length);
+        entry.owner = owner[i];
+        entry.subcommand = subcommand[i];
+        entry.is_list = option->is_list;
+        entry.is_option_free_list = option->is_option_free_list;
+        options_.push_back(entry);
+        // options with the same name stay in registration order along the probe sequence
+        size_t slot = entry.hash & (table_size - 1);
+        while (table_[slot] != 0)
+        {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        table_[slot] = options_.size();
+    }
+}
+
+/**
+ * @brief
+ *   find an option in the copy Freeze() made, the same way CmdLineOptions::FindOption(name, subcommand) does:
+ *   the first global option with the name, or else the first option of the subcommand with it.
+ *
+ * @param[in] name - option name
+ * @param[in] subcommand - subcommand earlier on the line (numbered from 1), or 0
+ *
+ * @return const script_option_t * - the option, or NULL
+ */
+const script_option_t *CmdLineOptionsScript::Lookup(const char *name, uint32_t subcommand)
+{
+    uint32_t length;
+    uint32_t hash = (uint32_t)option_name_hash(name, &length);
+    size_t mask = table_.size() - 1;
+    const script_option_t *found = NULL;
+    for (size_t slot = hash & mask; table_[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const script_option_t *entry = &options_[table_[slot] - 1];
+        if ((entry->hash != hash) || (strcmp(entry->name, name) != 0))
+        {
+            continue;
+        }
+        if (entry->owner == 0)
+        {
+            return entry;
+        }
+        if ((found == NULL) && (subcommand != 0) && (entry->owner == subcommand))
+        {
+            found = entry;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief
+ *   check if an argument is an option,... like CmdLineOptions::MatchesAnOption(), but doesn't depend on which
+ *   subcommand is selected.
+ *
+ * @param[in] s - argument
+ * @param[in] subcommand - subcommand earlier on the line (numbered from 1), or 0
+ *
+ * @return true if 's' matches a command line option
+ */
+bool CmdLineOptionsScript::MatchesAnOption(const char *s, uint32_t subcommand)
+{
+    char token[100];
+    split_option_token(s, token, sizeof(token));
+    static_option_ref_t ref;
+    return CmdLineOptions::GetInstance()->FindStaticOption(token, &ref) || (Lookup(token, subcommand) != NULL);
+}
+
+/**
+ * @brief
+ *   check the arguments of one line the way CmdLineOptions::TryParseOptions() parses them,
+ *   but without changing any option, so it can run on several threads while the options are in use.
+ *
+ * @param[in] argc - number of arguments
+ * @param[in] argv - arguments
+ * @param[out] error - what's wrong, if anything
+ * @param[out] steps - the options on the line are added to it, for ApplyLine()
+ *
+ * @return true if the line is good
+ */
+bool CmdLineOptionsScript::CheckLine(int argc, const char **argv, parse_error_t *error,
+                                     std::vector<script_step_t> *steps)
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    uint32_t subcommand = 0;
+    error->code = PARSE_ERROR_NONE;
+    error->arg_index = -1;
+    error->option_index = -1;
+    error->offset = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        char token[100];
+        const char *val_str = split_option_token(argv[i], token, sizeof(token));
+        error->arg_index = i;
+        error->option_index = -1;
+        script_step_t step;
+        step.option = NULL;
+        step.value = val_str;
+        step.arg = i;
+        step.num_items = 0;
+        if (registry->FindStaticOption(token, &step.ref))
+        {
+            if (!step.ref.table->Check(step.ref.index, val_str))
+            {
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->offset = val_str - argv[i];
+                return false;
+            }
+            steps->push_back(step);
+            continue;
+        }
+        const script_option_t *entry = Lookup(token, subcommand);
+        if (entry == NULL)
+        {
+            error->code = PARSE_ERROR_NO_MATCH;
+            return false;
+        }
+        CmdLineOption *option = entry->option;
+        error->option_index = option->index;
+        step.option = option;
+        if (entry->subcommand != 0)
+        {
+            // Subcommand::CheckValue() looks at the selected subcommand, this line's is here
+            if ((*val_str != 0) || ((subcommand != 0) && (subcommand != entry->subcommand)))
+            {
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->offset = val_str - argv[i];
+                return false;
+            }
+            subcommand = entry->subcommand;
+            steps->push_back(step);
+            continue;
+        }
+        if (entry->is_list)
+        {
+            if ((*val_str == '@') && !option->CheckFile(val_str + 1))
+            {
+                error->code = PARSE_ERROR_BAD_FILE;
+                error->offset = val_str - argv[i];
+                return false;
+            }
+            for (i = i + 1; i < argc; i++)
+            {
+                if (entry->is_option_free_list && MatchesAnOption(argv[i], subcommand))
+                {
+                    break;
+                }
+                if (!option->CheckValue(argv[i]))
+                {
+                    if (!MatchesAnOption(argv[i], subcommand))
+                    {
+                        error->code = PARSE_ERROR_BAD_LIST_ITEM;
+                        error->arg_index = i;
+                        return false;
+                    }
+                    break;
+                }
+            }
+            i--;
+            step.num_items = i - step.arg;
+        }
+        else if (!option->CheckValue(val_str))
+        {
+            error->code = PARSE_ERROR_BAD_VALUE;
+            error->offset = val_str - argv[i];
+            return false;
+        }
+        steps->push_back(step);
+    }
+    error->arg_index = -1;
+    error->option_index = -1;
+    return true;
+}
+
+/**
+ * @brief
+ *   parse a good line into the options a worker found for it,... what CmdLineOptions::TryParseOptions() does,
+ *   without splitting the arguments and looking the options up again.  the observers aren't told.
+ *
+ *   a value can still be bad if the option's CheckValue() accepts anything,... the parse stops there,
+ *   and the caller should reset and parse the line in full to find out what's wrong.
+ *
+ * @param[in] steps - the options on the line, from CheckLine()
+ * @param[in] num_steps - number of options
+ * @param[in] argv - arguments of the line
+ * @param[out] error - what's wrong, if anything
+ *
+ * @return true if the line was parsed into the options and no constraint is broken
+ */
+bool CmdLineOptionsScript::ApplyLine(const script_step_t *steps, uint32_t num_steps, const char **argv,
+                                     parse_error_t *error)
+{
+    CmdLineOptions *registry = CmdLineOptions::GetInstance();
+    error->offset = 0;
+    for (const script_step_t *step = steps; step != steps + num_steps; step++)
+    {
+        error->arg_index = step->arg;
+        error->option_index = -1;
+        if (step->option == NULL)
+        {
+            if (!registry->SetStaticOption(step->ref, step->value))
+            {
+                error->code = PARSE_ERROR_BAD_VALUE;
+                error->offset = step->value - argv[step->arg];
+                return false;
+            }
+            continue;
+        }
+        CmdLineOption *option = step->option;
+        error->option_index = option->index;
+        registry->Touch(option);
+        if (option->is_list)
+        {
+            if ((*step->value == '@') && !option->MapFile(step->value + 1))
+            {
+                error->code = PARSE_ERROR_BAD_FILE;
+                error->offset = step->value - argv[step->arg];
+                return false;
+            }
+            for (uint32_t i = step->arg + 1; i <= step->arg + step->num_items; i++)
+            {
+                if (!option->TryParseValue(argv[i]))
+                {
+                    error->code = PARSE_ERROR_BAD_LIST_ITEM;
+                    error->arg_index = i;
+                    return false;
+                }
+            }
+            option->EndOfList();
+        }
+        else if (!option->TryParseValue(step->value))
+        {
+            error->code = PARSE_ERROR_BAD_VALUE;
+            error->offset = step->value - argv[step->arg];
+            return false;
+        }
+        registry->SetOption(option);
+    }
+    error->arg_index = -1;
+    error->option_index = registry->FirstBrokenConstraint();
+    if (error->option_index >= 0)
+    {
+        error->code = PARSE_ERROR_CONSTRAINT;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,332 @@
+//  COPYRIGHT (C) 2022 Microchip with MIT license
+
+/**
+ * @file
+ * @brief
+ * Source file of the parameter sweep executor.
+ */
+
+#include "cmd_line_options_sweep.h"
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+/**
+ * @brief
+ *   block of combinations owned by one worker thread, [next, end)
+ */
+typedef struct
+{
+    std::mutex mutex; ///< protects next and end, the owner takes from the front and thieves from the back
+    uint64_t next;    ///< next combination to run
+    uint64_t end;     ///< end of the block
+} sweep_queue_t;
+
+/**
+ * @brief
+ *   value of an option for this combination
+ *
+ * @param[in] option - an option that was added with AddAxis()
+ *
+ * @return int64_t - value of the option, 0 if the option isn't an axis of the sweep.
+ */
+int64_t SweepContext::Value(const CmdLineOption *option) const
+{
+    for (size_t i = 0; i < sweep->AxisCount(); i++)
+    {
+        if (sweep->GetAxis(i) == option)
+        {
+            return values[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief
+ *   constructor, no axes
+ */
+CmdLineOptionsSweep::CmdLineOptionsSweep() : callback_(NULL), arg_(NULL), results_(NULL), queues_(NULL), num_threads_(0)
+{
+}
+
+/**
+ * @brief
+ *   add an option to sweep over (see the class description for the option types)
+ *
+ * @param[in] option - option
+ *
+ * @return true if the option type can be swept.
+ */
+bool CmdLineOptionsSweep::AddAxis(CmdLineOption *option)
+{
+    switch (option->type)
+    {
+    case CMD_LINE_OPTION_INT_LIST:
+    case CMD_LINE_OPTION_INT64_LIST:
+    case CMD_LINE_OPTION_UINT64_LIST:
+    case CMD_LINE_OPTION_INT_RANGE:
+    case CMD_LINE_OPTION_ENUM:
+    case CMD_LINE_OPTION_BOOL:
+        break;
+    default:
+        printf("can't sweep over option '%s'\n", option->name);
+        return false;
+    }
+    sweep_axis_t axis;
+    axis.option = option;
+    axis.start = 0;
+    axis.count = 0;
+    axes_.push_back(axis);
+    return true;
+}
+
+/**
+ * @brief
+ *   get the values of every axis from the options,... the options may have been parsed after AddAxis().
+ */
+void CmdLineOptionsSweep::LoadAxes()
+{
+    for (std::vector<sweep_axis_t>::iterator it = axes_.begin(); it != axes_.end(); ++it)
+    {
+        it->values.clear();
+        it->start = 0;
+        switch (it->option->type)
+        {
+        case CMD_LINE_OPTION_INT_LIST: {
+            IntListOption *option = (IntListOption *)it->option;
+            it->values.assign(option->begin(), option->end());
+            break;
+        }
+        case CMD_LINE_OPTION_INT64_LIST: {
+            Int64ListOption *option = (Int64ListOption *)it->option;
+            it->values.assign(option->value_list_.begin(), option->value_list_.end());
+            break;
+        }
+        case CMD_LINE_OPTION_UINT64_LIST: {
+            Uint64ListOption *option = (Uint64ListOption *)it->option;
+            it->values.assign(option->value_list_.begin(), option->value_list_.end());
+            break;
+        }
+        case CMD_LINE_OPTION_INT_RANGE: {
+            IntRangeOption *option = (IntRangeOption *)it->option;
+            if (option->is_set && (option->end_value >= option->start_value))
+            {
+                it->start = option->start_value;
+                it->count = (uint64_t)((int64_t)option->end_value - option->start_value + 1);
+                continue;
+            }
+            break;
+        }
+        case CMD_LINE_OPTION_ENUM: {
+            EnumOption *option = (EnumOption *)it->option;
+            if (option->is_set)
+            {
+                it->values.push_back(option->value);
+                break;
+            }
+            for (std::vector<value_str_t>::const_iterator e = option->enum_list_.begin();
+                 e != option->enum_list_.end(); ++e)
+            {
+                it->values.push_back(e->value);
+            }
+            break;
+        }
+        case CMD_LINE_OPTION_BOOL: {
+            BoolOption *option = (BoolOption *)it->option;
+            if (option->is_set)
+            {
+                it->values.push_back(option->value);
+                break;
+            }
+            it->values.push_back(false);
+            it->values.push_back(true);
+            break;
+        }
+        default:
+            break;
+        }
+        if (it->values.empty())
+        {
+            // nothing to sweep over,... one combination with 0, rather than none at all
+            it->values.push_back(0);
+        }
+        it->count = it->values.size();
+    }
+}
+
+/**
+ * @brief
+ *   number of combinations
+ *
+ * @return uint64_t - product of the number of values of every axis, UINT64_MAX if that overflows.
+ */
+uint64_t CmdLineOptionsSweep::Count()
+{
+    LoadAxes();
+    uint64_t count = axes_.empty() ? 0 : 1;
+    for (std::vector<sweep_axis_t>::const_iterator it = axes_.begin(); it != axes_.end(); ++it)
+    {
+        if (__builtin_mul_overflow(count, it->count, &count))
+        {
+            return UINT64_MAX;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief
+ *   values of one combination (Count() or Run() must have been called since the options changed)
+ *
+ * @param[in] index - combination number
+ * @param[out] values - one value per axis
+ */
+void CmdLineOptionsSweep::Combination(uint64_t index, int64_t *values)
+{
+    // the last axis is the innermost loop
+    for (size_t i = axes_.size(); i-- > 0;)
+    {
+        const sweep_axis_t &axis = axes_[i];
+        if (axis.count == 0)
+        {
+            // the axes haven't been loaded yet
+            values[i] = 0;
+            continue;
+        }
+        uint64_t n = index % axis.count;
+        index /= axis.count;
+        values[i] = axis.values.empty() ? axis.start + (int64_t)n : axis.values[n];
+    }
+}
+
+/**
+ * @brief
+ *   get the next combination for a worker thread, stealing from another thread if this thread's block is done.
+ *
+ * @param[in] thread - worker thread
+ * @param[out] index - combination to run
+ *
+ * @return true if there was a combination left to run.
+ */
+bool CmdLineOptionsSweep::NextCombination(uint32_t thread, uint64_t *index)
+{
+    sweep_queue_t *queues = (sweep_queue_t *)queues_;
+    sweep_queue_t &own = queues[thread];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.next < own.end)
+        {
+            *index = own.next++;
+            return true;
+        }
+    }
+    for (uint32_t i = 1; i < num_threads_; i++)
+    {
+        sweep_queue_t &victim = queues[(thread + i) % num_threads_];
+        uint64_t start;
+        uint64_t end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            uint64_t remaining = victim.end - victim.next;
+            if (remaining == 0)
+            {
+                continue;
+            }
+            // take the back half, the victim keeps going from the front
+            end = victim.end;
+            start = end - (remaining + 1) / 2;
+            victim.end = start;
+        }
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.next = start + 1;
+        own.end = end;
+        *index = start;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *   worker thread, runs combinations until there are none left.
+ *
+ * @param[in] thread - worker thread number
+ */
+void CmdLineOptionsSweep::Worker(uint32_t thread)
+{
+    std::vector<int64_t> values(axes_.size());
+    SweepContext context;
+    context.thread = thread;
+    context.values = values.data();
+    context.sweep = this;
+    while (NextCombination(thread, &context.index))
+    {
+        Combination(context.index, values.data());
+        results_[context.index] = callback_(context, arg_);
+    }
+}
+
+/**
+ * @brief
+ *   run the callback for every combination
+ *
+ * @param[in] callback - function to call for each combination (from several threads at once)
+ * @param[in] arg - passed to the callback
+ * @param[out] results - callback return values, results[i] is the result of combination i
+ * @param[in] num_threads - number of threads, 0 for one per CPU
+ *
+ * @return true if the sweep ran, false if there are too many combinations.
+ */
+bool CmdLineOptionsSweep::Run(sweep_callback_t callback, void *arg, std::vector<int64_t> &results,
+                              uint32_t num_threads)
+{
+    uint64_t count = Count();
+    if ((count == UINT64_MAX) || (count > results.max_size()))
+    {
+        printf("too many combinations to sweep\n");
+        return false;
+    }
+    results.assign(count, 0);
+    if (count == 0)
+    {
+        return true;
+    }
+    if (num_threads == 0)
+    {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    if ((num_threads == 0) || (num_threads > count))
+    {
+        num_threads = (num_threads == 0) ? 1 : count;
+    }
+
+    std::vector<sweep_queue_t> queues(num_threads);
+    uint64_t block = count / num_threads;
+    uint64_t extra = count % num_threads;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        queues[i].next = i * block + std::min<uint64_t>(i, extra);
+        queues[i].end = queues[i].next + block + (i < extra);
+    }
+    callback_ = callback;
+    arg_ = arg;
+    results_ = results.data();
+    queues_ = queues.data();
+    num_threads_ = num_threads;
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < num_threads; i++)
+    {
+        threads.push_back(std::thread(&CmdLineOptionsSweep::Worker, this, i));
+    }
+    // the calling thread is worker 0
+    Worker(0);
+    for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        it->join();
+    }
+    queues_ = NULL;
+    return true;
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "addrmask - addr:mask" {
+  run build/example some_addrmask=0xd00380:0xff
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_addrmask.is_set
+option_some_addrmask: 0xd00380:0xff
+option_some_addrmask batch: 0xd00380 count 1
+END
+}
+
+@test "addrmask - start..end:mask" {
+  run build/example some_addrmask=0x100..0x10c:0xff
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmask.is_set
+option_some_addrmask: 0x100:0xff 0x104:0xff 0x108:0xff 0x10c:0xff
+option_some_addrmask batch: 0x100 count 4
+END
+}
+
+@test "addrmask - start+count/stride (default mask)" {
+  run build/example some_addrmask=0x100+3/0x20
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmask.is_set
+option_some_addrmask: 0x100:0xffffffff 0x120:0xffffffff 0x140:0xffffffff
+option_some_addrmask batch: 0x100 count 1
+option_some_addrmask batch: 0x120 count 1
+option_some_addrmask batch: 0x140 count 1
+END
+}
+
+@test "addrmask - bad mask" {
+  run build/example some_addrmask=0x100:0xfg
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing 'some_addrmask=0x100:0xfg'"
+}
+
+@test "addrmask - stride of 0" {
+  run build/example some_addrmask=0x100+2/0
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing 'some_addrmask=0x100+2/0'"
+}
+
+@test "addrmasklist - overlapping entries are merged and batched" {
+  run build/example some_addrmasklist: 0x100+4:0xf 0x108:0xf0 0x200 0x180+2/0x10 some_bool
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_addrmasklist.is_set
+option_some_addrmasklist: 0x100:0xf 0x104:0xf 0x108:0xff 0x10c:0xf 0x180:0xffffffff 0x190:0xffffffff 0x200:0xffffffff
+option_some_addrmasklist batch: 0x100 count 4
+option_some_addrmasklist batch: 0x180 count 1
+option_some_addrmasklist batch: 0x190 count 1
+option_some_addrmasklist batch: 0x200 count 1
+END
+}
+
+@test "addrmask - from environment variable" {
+  export PROJECT_NAME_some_addrmask=0x40+2:0x3
+  run build/example
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+setting some_addrmask to "0x40+2:0x3" (from environment variable PROJECT_NAME_some_addrmask)
+option_some_addrmask.is_set
+option_some_addrmask: 0x40:0x3 0x44:0x3
+option_some_addrmask batch: 0x40 count 2
+END
+}
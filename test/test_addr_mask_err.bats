@@ -0,0 +1,63 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "err - addrmask - start..end:mask" {
+  run build/example_with_error_message some_addrmask=0x100..0x10c:0xff
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmask.is_set
+option_some_addrmask: 0x100:0xff 0x104:0xff 0x108:0xff 0x10c:0xff
+option_some_addrmask batch: 0x100 count 4
+END
+}
+
+@test "err - addrmask - bad mask" {
+  run build/example_with_error_message some_addrmask=0x100..0x10c:0xfg
+  [ $status -eq 255 ]
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+error parsing '0x100..0x10c:0xfg'
+ for AddrMask option 'some_addrmask'
+ option description: testing some_addrmask
+address formats are:
+   addr                  e.g. 0xd00380
+   addr:mask             e.g. 0xd00380:0xff
+   start..end:mask       e.g. 0xd00380..0xd00388:0xff
+   start+count/step:mask e.g. 0xd00380+2/0x20:0xff (that's 0xd00380 0xd003a0)
+error parsing "some_addrmask=0x100..0x10c:0xfg"
+END
+}
+
+@test "err - addrmasklist - " {
+  run build/example_with_error_message some_addrmasklist: 0x10 0x4 0x8
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmasklist.is_set
+option_some_addrmasklist: 0x4:0xffffffff 0x8:0xffffffff 0x10:0xffffffff
+option_some_addrmasklist batch: 0x4 count 2
+option_some_addrmasklist batch: 0x10 count 1
+END
+}
+
+@test "err - addrmask - address past 32 bits" {
+  run build/example_with_error_message some_addrmask=0x100000000..0x100000008
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing '0x100000000..0x100000008'
+ for AddrMask option 'some_addrmask'"
+}
+
+@test "err - addrmask - empty count" {
+  run build/example_with_error_message some_addrmask=4+0
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing '4+0'
+ for AddrMask option 'some_addrmask'"
+}
+
+@test "err - addrmask - backwards range" {
+  run build/example_with_error_message some_addrmask=8..4
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing '8..4'
+ for AddrMask option 'some_addrmask'"
+}
@@ -0,0 +1,31 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "str addrmask - start..end:mask" {
+  run build/example_as_string some_addrmask=0x100..0x10c:0xff
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmask.is_set
+option_some_addrmask: 0x100:0xff 0x104:0xff 0x108:0xff 0x10c:0xff
+option_some_addrmask batch: 0x100 count 4
+END
+}
+
+@test "str addrmasklist - unsorted list" {
+  run build/example_as_string "some_addrmasklist: 0x10 0x4 0x8:0x1 0x8:0x2"
+  [ $status -eq 0 ]
+  assert_output --stdin <<END
+option_some_addrmasklist.is_set
+option_some_addrmasklist: 0x4:0xffffffff 0x8:0x3 0x10:0xffffffff
+option_some_addrmasklist batch: 0x4 count 2
+option_some_addrmasklist batch: 0x10 count 1
+END
+}
+
+@test "str addrmask - bad mask" {
+  run build/example_as_string some_addrmask=0x100:0xfg
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing 'some_addrmask=0x100:0xfg'"
+}
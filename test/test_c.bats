@@ -0,0 +1,42 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "c - read options through handles" {
+  run build/example_c some_uint=7 some_bool some_int64=-5 some_double=2.5 some_string=hi some_intrange=3..9 some_int64list: 1,2 5..7 some_stringlist: a b
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+same handle: yes
+wrong type: NULL
+no such option: NULL
+some_bool = 1 (set 1)
+some_uint = 7 (set 1)
+some_int64 = -5
+some_double = 2.5
+some_string = hi
+some_intrange = 3..9
+some_int64list: 1 2 5 6 7
+some_stringlist: a b
+END
+}
+
+@test "c - defaults" {
+  run build/example_c
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+same handle: yes
+wrong type: NULL
+no such option: NULL
+some_bool = 0 (set 0)
+some_uint = 0 (set 0)
+some_int64 = 0
+some_double = 0
+some_string = default
+some_intrange = 0..0
+some_int64list:
+some_stringlist:
+END
+}
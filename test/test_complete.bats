@@ -0,0 +1,76 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "complete - option names" {
+  run build/example __complete some_in
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+some_int=
+some_int64=
+some_int64list:
+some_intList:
+some_intrange=
+END
+}
+
+@test "complete - keeps the dashes" {
+  run build/example __complete --some_e
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+--some_enum=
+END
+}
+
+@test "complete - enumerations" {
+  run build/example __complete some_enum=T
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+some_enum=two
+some_enum=three
+END
+}
+
+@test "complete - bool keywords" {
+  run build/example __complete some_bool=o
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+some_bool=on
+some_bool=off
+END
+}
+
+@test "complete - no match" {
+  run build/example __complete asdf
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+END
+}
+
+@test "complete - bash script" {
+  run build/example __completion_script bash
+  [ $status -eq 0 ]
+  assert_output --partial "complete -F _example_complete example"
+}
+
+@test "complete - zsh script" {
+  run build/example __completion_script zsh
+  [ $status -eq 0 ]
+  assert_output --partial "compdef _example_complete example"
+}
+
+@test "complete - nothing printed before parsing is in the list" {
+  export PROJECT_NAME_verbose=1
+  run build/example_subcommand __complete ve
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+verbose
+END
+}
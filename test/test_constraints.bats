@@ -0,0 +1,66 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "constraints - ok" {
+  run build/example_constraints smoke_test channels=1..4 num_channels=8
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+options are ok
+END
+}
+
+@test "constraints - one of" {
+  run build/example_constraints
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+exactly one of 'smoke_test', 'endurance_test' is needed
+END
+}
+
+@test "constraints - requires" {
+  run build/example_constraints smoke_test channels=1..4
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+option 'channels' requires 'num_channels'
+END
+}
+
+@test "constraints - conflicts" {
+  run build/example_constraints smoke_test verbose quiet
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+options 'verbose', 'quiet' can't be used together
+END
+}
+
+@test "constraints - at most" {
+  run build/example_constraints endurance_test audit verbose
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+at most 2 of 'endurance_test', 'audit', 'verbose' can be used ('endurance_test', 'audit', 'verbose' are set)
+END
+}
+
+@test "constraints - all errors are reported" {
+  run build/example_constraints channels=0+2 verbose quiet audit endurance_test smoke_test
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+exactly one of 'smoke_test', 'endurance_test' is needed ('smoke_test', 'endurance_test' are set)
+option 'channels' requires 'num_channels'
+options 'verbose', 'quiet' can't be used together
+at most 2 of 'endurance_test', 'audit', 'verbose' can be used ('endurance_test', 'audit', 'verbose' are set)
+END
+}
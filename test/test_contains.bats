@@ -0,0 +1,37 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "contains - compact list and range" {
+  run build/example_contains lanes: 0..7 64 channels=10+5 check: -1 3 12 15 16 64 65
+  [ $status -eq 0 ]
+
+  assert_output --partial "-1: lanes no, channels no
+3: lanes yes, channels no
+12: lanes no, channels yes
+15: lanes no, channels yes
+16: lanes no, channels no
+64: lanes yes, channels no
+65: lanes no, channels no"
+}
+
+@test "contains - spread out list" {
+  run build/example_contains lanes: -2000000000 5 100000..100003 2000000000 check: -2000000000 4 5 100002 100004 2000000000
+  [ $status -eq 0 ]
+
+  assert_output --partial "-2000000000: lanes yes, channels no
+4: lanes no, channels no
+5: lanes yes, channels no
+100002: lanes yes, channels no
+100004: lanes no, channels no
+2000000000: lanes yes, channels no"
+}
+
+@test "contains - a range that isn't set contains nothing" {
+  run build/example_contains check: 0 1
+  [ $status -eq 0 ]
+
+  assert_output --partial "0: lanes no, channels no
+1: lanes no, channels no"
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "control - set and get" {
+  run build/example_control <<END
+set some_int=5 some_enum=two
+get some_int some_enum
+END
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+ok
+some_int changed, on the main thread
+some_int=5
+some_enum=two
+ok
+option_some_enum.is_set
+option_some_enum.value = 2 ("two")
+option_some_int.is_set
+option_some_int.value = 5
+END
+}
+
+@test "control - set is all or nothing" {
+  run build/example_control <<END
+set some_int=7 some_uint=zz
+get some_int
+END
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+error: error parsing "some_uint=zz" for option 'some_uint'
+some_int=0
+ok
+END
+}
+
+@test "control - list options can't be changed" {
+  run build/example_control <<END
+set some_intList: 1
+END
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+error: list option 'some_intList:' can't be changed while running
+END
+}
+
+@test "control - unknown option" {
+  run build/example_control <<END
+get asdf
+END
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+error: no match for option "asdf"
+END
+}
+
+@test "control - dump of an empty namespace" {
+  run build/example_control <<END
+dump dma.*
+END
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+error: no options in namespace "dma.*"
+END
+}
+
+@test "control - strings and ranges" {
+  run build/example_control <<END
+set some_string=abc
+set some_string=def some_intrange=3..9
+get some_string some_intrange
+END
+  [ $status -eq 0 ]
+
+  assert_output --partial "ok
+ok
+some_string=def
+some_intrange=3..9
+ok"
+}
+
+@test "control - options that can't be stored atomically can't be changed" {
+  run build/example_control <<END
+set some_int=3 some_addrmask=0x10
+get some_int
+END
+  [ $status -eq 255 ]
+
+  assert_output --partial "error: option 'some_addrmask' can't be changed while running
+some_int=0
+ok"
+}
+
+@test "control - strings read earlier stay valid" {
+  run build/example_control <<END
+set some_string=abc
+set some_string=def
+set some_string=ghi
+set some_string=abc
+END
+  [ $status -eq 0 ]
+
+  assert_output --partial "some_string was: default abc def ghi abc
+option_some_string.is_set
+option_some_string.value = \"abc\""
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "cpuset - threads round robin over the set" {
+  run build/example_cpuset cpus=0 threads=3
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+cpus: 0
+thread 0 -> cpu 0
+thread 1 -> cpu 0
+thread 2 -> cpu 0
+END
+}
+
+@test "cpuset - every range format, repeats dropped" {
+  run build/example_cpuset cpus=0,0-0,0..0,0+1,0+1/4 threads=1
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+cpus: 0
+thread 0 -> cpu 0
+END
+}
+
+@test "cpuset - pin threads" {
+  run build/example_cpuset cpus=0 threads=2 pin
+  [ $status -eq 0 ]
+
+  assert_output --partial "thread 1 pinned to cpu 0"
+}
+
+@test "cpuset - cpu that isn't online" {
+  run build/example_cpuset cpus=0,100000
+  [ $status -eq 255 ]
+
+  assert_output --partial "error parsing 'cpus=0,100000'"
+}
+
+@test "cpuset - backwards range" {
+  run build/example_cpuset cpus=3-1
+  [ $status -eq 255 ]
+
+  assert_output --partial "error parsing 'cpus=3-1'"
+}
+
+@test "cpuset - range far past the last cpu" {
+  run build/example_cpuset cpus=0-4000000000
+  [ $status -eq 255 ]
+
+  assert_output --partial "error parsing 'cpus=0-4000000000'"
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "file list - text files, after the values on the command line" {
+  values="${BATS_TMPDIR:-/tmp}/example_file_list.$$.txt"
+  names="${BATS_TMPDIR:-/tmp}/example_file_list.$$.names"
+  seq 1 100000 > "$values"
+  printf 'alpha\n\nbeta\r\ngamma' > "$names"
+  run build/example_file_list find=99999 values: 5 6 values:=@"$values" 9 names:=@"$names" extra
+  rm -f "$values" "$names"
+  [ $status -eq 0 ]
+
+  assert_output --partial "first values: 5 6 9
+100003 values, sum 5000050020
+first names: extra alpha beta
+4 names
+contains 99999: yes
+100003 values, 4 names, last name gamma"
+}
+
+@test "file list - hex and negative lines, shown with the command line values" {
+  values="${BATS_TMPDIR:-/tmp}/example_file_list.$$.txt"
+  printf '1\n0x10\r\n\n-3\n' > "$values"
+  run build/example_file_list find=16 values: 2 values:=@"$values"
+  rm -f "$values"
+  [ $status -eq 0 ]
+
+  assert_output --partial "values: 2 1 16 -3
+first values: 2 1 16
+4 values, sum 16"
+  assert_output --partial "contains 16: yes"
+}
+
+@test "file list - a line that isn't a number" {
+  values="${BATS_TMPDIR:-/tmp}/example_file_list.$$.txt"
+  printf '1\n2..5\n3\n' > "$values"
+  run build/example_file_list values:=@"$values"
+  rm -f "$values"
+  [ $status -eq 255 ]
+
+  assert_output --partial "can't use the file in 'values:=@"
+}
+
+@test "file list - raw file" {
+  values="${BATS_TMPDIR:-/tmp}/example_file_list.$$.bin"
+  printf '\x01\x00\x00\x00\x02\x00\x00\x00\xff\xff\xff\xff\x07' > "$values"
+  run build/example_file_list values:=@raw:"$values"
+  rm -f "$values"
+  [ $status -eq 0 ]
+
+  assert_output --partial "first values: 1 2 -1
+3 values, sum 2"
+}
+
+@test "file list - missing file" {
+  run build/example_file_list values:=@/nonexistent/values.txt
+  [ $status -eq 255 ]
+
+  assert_output --partial "can't use the file in 'values:=@/nonexistent/values.txt'"
+}
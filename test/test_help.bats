@@ -38,7 +38,12 @@ example
   some_intList:         - testing some_intList
   some_stringlist:      - testing some_stringlist
   optionfreestringlist: - testing optionfreestringlist (valid option terminates list)
+  some_int64list:       - testing some_int64list
+  some_uint64list:      - testing some_uint64list
+  some_doublelist:      - testing some_doublelist
   some_double           - testing some_double
   some_string           - testing some_string
+  some_addrmask         - testing some_addrmask
+  some_addrmasklist:    - testing some_addrmasklist
 END
 }
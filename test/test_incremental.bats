@@ -0,0 +1,68 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "incremental - options are resolved as they are fed" {
+  run build/example_incremental some_bool some_int=5
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parsed some_bool
+parsed some_int
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_int.is_set
+option_some_int.value = 5
+END
+}
+
+@test "incremental - list is resolved when the next option arrives" {
+  run build/example_incremental some_intList: 1 2 3 some_bool
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parsed some_intList:
+parsed some_bool
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_intList.is_set
+option_some_intList: 1 2 3
+END
+}
+
+@test "incremental - list at the end is resolved by Finish()" {
+  run build/example_incremental some_int=5 optionfreestringlist: one two
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parsed some_int
+parsed optionfreestringlist:
+option_some_int.is_set
+option_some_int.value = 5
+option_optionfreestringlist.is_set
+option_optionfreestringlist: one two
+END
+}
+
+@test "incremental - bad list item" {
+  run build/example_incremental some_intList: 0..9f
+  [ $status -eq 255 ]
+  assert_output --stdin <<END
+CmdLineOptionParser returned false
+error parsing '0..9f'
+ for IntList option 'some_intList:'
+ option description: testing some_intList
+list formats are:
+   start..end       e.g. some_intList: 0..10
+   start+count      e.g. some_intList: 5+2 (that's 5 6)
+   start+count/skip e.g. some_intList: 11+3/100 (that's 11 111 211) 
+error parsing "0..9f"
+END
+}
+
+@test "incremental - no match" {
+  run build/example_incremental asdf
+  [ $status -eq 255 ]
+  assert_output --partial "no match for option \"asdf\""
+}
@@ -0,0 +1,18 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "intern - equal values are the same pointer, and outlive their line" {
+  run build/example_intern threads=4
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+3 tests, 2 different pointers
+7 files, 3 different pointers
+first and last test the same: yes, value read
+4 threads got the same pointers: yes
+pool: 55 strings
+after Release(): 0 strings, test = none
+END
+}
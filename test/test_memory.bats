@@ -0,0 +1,33 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "memory - options report what their values hold" {
+  run build/example_memory values: 1..1000 names: a b c
+  [ $status -eq 0 ]
+
+  assert_output --partial "parse_memory=0"
+  assert_output --partial "option name=values: bytes=4104 unused=96
+option name=names: bytes=32 unused=8
+option name=mode bytes=96 unused=24"
+}
+
+@test "memory - a list that shrank is marked" {
+  run build/example_memory again="values: 1" values: 1..1000
+  [ $status -eq 0 ]
+
+  assert_output --partial "after again:"
+  assert_output --partial "option name=values: bytes=4104 unused=4092 mostly_unused"
+}
+
+@test "memory - the registry counts its constraint tables" {
+  run build/example_memory constraints=100
+  [ $status -eq 0 ]
+
+  assert_output --partial "after constraints:"
+  before=$(echo "$output" | sed -n 's/^memory registry=\([0-9]*\) .*/\1/p' | head -1)
+  after=$(echo "$output" | sed -n 's/^memory registry=\([0-9]*\) .*/\1/p' | tail -1)
+  # a pointer, a first term, a trigger, a size and a term word for each constraint, at least
+  [ "$after" -ge $((before + 100 * 8 + 100 * 16)) ]
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "namespace - options in namespaces" {
+  run build/example_namespace dma.queue_depth=32 dma.trace hw.pcie.gen=4 log.level=3
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+dma.queue_depth = 32
+dma.trace = true
+hw.pcie.lanes = 4
+hw.pcie.gen = 4
+log.level = 3
+END
+}
+
+@test "namespace - the short name isn't an option" {
+  run build/example_namespace queue_depth=3
+  [ $status -eq 255 ]
+
+  assert_output --partial "no match for 'queue_depth'"
+}
+
+@test "namespace - help for a namespace" {
+  run build/example_namespace help=dma.*
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+  dma.queue_depth descriptors per queue
+  dma.trace       trace every descriptor
+END
+}
+
+@test "namespace - help for a namespace with only one namespace in it" {
+  run build/example_namespace help=hw.*
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+  hw.pcie.gen   pcie generation
+  hw.pcie.lanes number of lanes
+END
+}
+
+@test "namespace - help for an empty namespace" {
+  run build/example_namespace help=hw.pci.*
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+no options in namespace 'hw.pci.*'
+END
+}
+
+@test "namespace - reset a namespace" {
+  run build/example_namespace dma.queue_depth=2 dma.trace log.level=5 reset_dma
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+dma.queue_depth = 2
+dma.trace = true
+hw.pcie.lanes = 4
+hw.pcie.gen = 3
+log.level = 5
+after reset:
+dma.queue_depth = 16
+dma.trace = false
+hw.pcie.lanes = 4
+hw.pcie.gen = 3
+log.level = 5
+END
+}
+
+@test "namespace - environment variable" {
+  export PROJECT_NAME_DMA_QUEUE_DEPTH=7
+  run build/example_namespace
+  [ $status -eq 0 ]
+
+  assert_output --partial "setting dma.queue_depth to \"7\" (from environment variable PROJECT_NAME_DMA_QUEUE_DEPTH)"
+  assert_output --partial "dma.queue_depth = 7"
+}
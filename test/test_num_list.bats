@@ -0,0 +1,54 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "int64list - comma separated values and ranges" {
+  run build/example some_int64list: 1,2,-3 -5..-3 9223372036854775807 some_bool
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_int64list.is_set
+option_some_int64list: 1 2 -3 -5 -4 -3 9223372036854775807
+END
+}
+
+@test "int64list - overflow" {
+  run build/example some_int64list: 9223372036854775808
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing list item '9223372036854775808'"
+}
+
+@test "uint64list - start+count/skip and 64 bit values" {
+  run build/example some_uint64list: 0x1000+3/0x10 18446744073709551615
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_uint64list.is_set
+option_some_uint64list: 0x1000 0x1010 0x1020 0xffffffffffffffff
+END
+}
+
+@test "uint64list - negative value" {
+  run build/example some_uint64list: 1,-1
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing list item '1,-1'"
+}
+
+@test "doublelist - " {
+  run build/example some_doublelist: 0.25,0.5,0.25 -1e-3 2.5E+3 inf
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_doublelist.is_set
+option_some_doublelist: 0.25 0.5 0.25 -0.001 2500 inf
+END
+}
+
+@test "doublelist - bad value in a run" {
+  run build/example some_doublelist: 1,x
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing list item '1,x'"
+}
@@ -0,0 +1,45 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "err int64list - " {
+  run build/example_with_error_message some_int64list: 1,2 10+2/5
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_int64list.is_set
+option_some_int64list: 1 2 10 15
+END
+}
+
+@test "err uint64list - incomplete range" {
+  run build/example_with_error_message some_uint64list: 1..
+  [ $status -eq 255 ]
+  assert_output --stdin <<END
+ParseOptionsOrError returned false
+error parsing '1..'
+ for Uint64List option 'some_uint64list:'
+ option description: testing some_uint64list
+list formats are:
+   a,b,c            e.g. some_uint64list: 1,2,3
+   start..end       e.g. some_uint64list: 0..10
+   start+count      e.g. some_uint64list: 5+2 (that's 5 6)
+   start+count/skip e.g. some_uint64list: 11+3/100 (that's 11 111 211)
+error parsing "1.."
+END
+}
+
+@test "err uint64list - range of every value" {
+  run build/example_with_error_message some_uint64list: 0..0xffffffffffffffff
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing '0..0xffffffffffffffff'
+ for Uint64List option 'some_uint64list:'"
+}
+
+@test "err int64list - range too big to expand" {
+  run build/example_with_error_message some_int64list: 0..4000000000
+  [ $status -eq 255 ]
+  assert_output --partial "error parsing '0..4000000000'
+ for Int64List option 'some_int64list:'"
+}
@@ -0,0 +1,16 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "str doublelist - " {
+  run build/example_as_string "some_doublelist: 0.25,0.5 1e-3 some_uint64list: 7,0x10"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_uint64list.is_set
+option_some_uint64list: 0x7 0x10
+option_some_doublelist.is_set
+option_some_doublelist: 0.25 0.5 0.001
+END
+}
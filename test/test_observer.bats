@@ -0,0 +1,82 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "observer - one notification per parse" {
+  run build/example_observer "rate=10 verbose" "label=x burst=3 rate=11" "verbose"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parse "rate=10 verbose"
+rate observer: rate
+worker woke: generation 1, rate 10, burst 8
+parse "label=x burst=3 rate=11"
+label observer: label
+rate observer: burst rate
+parse "verbose"
+no label change in 10 ms
+END
+}
+
+@test "observer - an option set twice is listed once" {
+  run build/example_observer "burst=1 burst=2 rate=5"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parse "burst=1 burst=2 rate=5"
+rate observer: burst rate
+worker woke: generation 1, rate 5, burst 2
+no label change in 10 ms
+END
+}
+
+@test "observer - the worker sleeps until its options change" {
+  run build/example_observer "label=y"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parse "label=y"
+label observer: label
+no label change in 10 ms
+rate never changed
+rate observer: rate
+worker woke: generation 1, rate 0, burst 8
+END
+}
+
+@test "observer - Reset() tells the observers of the options it puts back" {
+  run build/example_observer "rate=10" "label=x" reset "verbose"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parse "rate=10"
+rate observer: rate
+worker woke: generation 1, rate 10, burst 8
+parse "label=x"
+label observer: label
+reset
+rate observer: rate burst
+label observer: label
+rate 100, label none
+parse "verbose"
+no label change in 10 ms
+END
+}
+
+@test "observer - Reset() puts back options written directly" {
+  run build/example_observer "rate=10" direct reset
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+parse "rate=10"
+rate observer: rate
+worker woke: generation 1, rate 10, burst 8
+direct
+reset
+rate observer: rate burst
+label observer: label
+rate 100, label none
+no label change in 10 ms
+END
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "reset - options set by one line are reset before the next line" {
+  run build/example_as_string some_int=5 some_intList: 1 2 ";" some_bool ";" some_intList: 3
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_int.is_set
+option_some_int.value = 5
+option_some_intList.is_set
+option_some_intList: 1 2
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_intList.is_set
+option_some_intList: 3
+END
+}
+
+@test "reset - option set from an environment variable goes back to its default" {
+  export PROJECT_NAME_some_int=7
+  run build/example_as_string some_bool ";" some_uint=1
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+setting some_int to "7" (from environment variable PROJECT_NAME_some_int)
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_int.is_set
+option_some_int.value = 7
+option_some_uint.is_set
+option_some_uint.value = 1 (0x1)
+END
+}
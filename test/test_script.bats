@@ -0,0 +1,111 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "script - lines are parsed in order, starting from the defaults" {
+  script="${BATS_TMPDIR:-/tmp}/example_script.$$"
+  cat > "$script" <<END
+count=2 label=first channels: 1 2 3
+
+label=second
+count=x
+channels: 1..3 label=fourth
+nothing=1
+channels: 7 zz
+count=5 channels: 4+2 label=eighth
+END
+  run build/example_script script="$script" threads=3
+  rm -f "$script"
+  [ $status -eq 0 ]
+
+  assert_output --partial "line 1: count = 2, label = first, channels: 1 2 3"
+  assert_output --partial "line 3: count = 1, label = second, channels:"
+  assert_output --partial "line 5: count = 1, label = fourth, channels: 1 2 3"
+  assert_output --partial "line 8: count = 5, label = eighth, channels: 4 5"
+}
+
+@test "script - bad lines are reported, and don't change the next line" {
+  script="${BATS_TMPDIR:-/tmp}/example_script.$$"
+  cat > "$script" <<END
+count=2 label=first channels: 1 2 3
+
+label=second
+count=x
+channels: 1..3 label=fourth
+nothing=1
+channels: 7 zz
+count=5 channels: 4+2 label=eighth
+END
+  run build/example_script script="$script" threads=2
+  rm -f "$script"
+  [ $status -eq 0 ]
+
+  assert_output --partial "line 4:
+error parsing 'x'"
+  assert_output --partial "line 6:
+no match for option \"nothing\""
+  assert_output --partial "line 7:
+error parsing 'zz'"
+}
+
+@test "script - check" {
+  script="${BATS_TMPDIR:-/tmp}/example_script.$$"
+  cat > "$script" <<END
+count=2 label=first channels: 1 2 3
+
+label=second
+count=x
+channels: 1..3 label=fourth
+nothing=1
+channels: 7 zz
+count=5 channels: 4+2 label=eighth
+END
+  run build/example_script script="$script" check threads=4
+  rm -f "$script"
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+line 4: error parsing "count=x" for option 'count'
+line 6: no match for option "nothing"
+line 7: error parsing "zz" for option 'channels:'
+3 bad lines
+END
+}
+
+@test "script - missing file" {
+  run build/example_script script=/nonexistent/script
+  [ $status -eq 255 ]
+
+  assert_output --partial "/nonexistent/script: No such file or directory"
+}
+
+@test "script - diff only sets the options that changed" {
+  script="${BATS_TMPDIR:-/tmp}/example_script.$$"
+  cat > "$script" <<END
+count=2 label=first channels: 1 2 3
+count=2 label=second channels: 1 2 3
+label=second
+count=x
+count=3 label=second channels: 1 2 3 4
+label=sixth channels: 1 2 3 4
+END
+  run build/example_script script="$script" diff threads=2
+  rm -f "$script"
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+count set to 2
+line 1: count = 2, label = first, channels: 1 2 3
+line 2: count = 2, label = second, channels: 1 2 3
+line 3: count = 1, label = second, channels:
+line 4:
+error parsing 'x'
+ for int option 'count'
+ option description: number of times to run
+error parsing "count=x"
+count set to 3
+line 5: count = 3, label = second, channels: 1 2 3 4
+line 6: count = 1, label = sixth, channels: 1 2 3 4
+END
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "static - defaults" {
+  run build/example_static
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+static_bool = false
+static_int = -1
+static_uint = 0x10
+static_int64 = 0
+static_uint64 = 0x123456789
+static_double = 0.5
+static_string = none
+END
+}
+
+@test "static - every type, mixed with options that registered themselves" {
+  run build/example_static static_bool static_int=5 static_uint=0x20 static_int64=-5 static_uint64=0xff static_double=1/4 static_string=hello some_int=3
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+static_bool = true (set)
+static_int = 5
+static_uint = 0x20
+static_int64 = -5
+static_uint64 = 0xff
+static_double = 0.25
+static_string = hello
+option_some_int.is_set
+option_some_int.value = 3
+END
+}
+
+@test "static - a static option ends an option free list" {
+  run build/example_static optionfreestringlist: a b static_int=2
+  [ $status -eq 0 ]
+
+  assert_output --partial "static_int = 2"
+  assert_output --partial "option_optionfreestringlist: a b"
+}
+
+@test "static - environment variable" {
+  export PROJECT_NAME_STATIC_INT=9
+  run build/example_static
+  [ $status -eq 0 ]
+
+  assert_output --partial 'setting static_int to "9" (from environment variable PROJECT_NAME_STATIC_INT)'
+  assert_output --partial "static_int = 9"
+}
+
+@test "static - bad value" {
+  run build/example_static static_int=5x
+  [ $status -eq 255 ]
+
+  assert_output --partial "error parsing 'static_int=5x'"
+  assert_output --partial "  static_int            - testing static_int"
+}
@@ -0,0 +1,154 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "subcommand - none" {
+  run build/example_subcommand verbose
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+subcommand: none
+verbose = true
+END
+}
+
+@test "subcommand - run with its options" {
+  run build/example_subcommand run channels: 1 2 test_time=5
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+subcommand: run
+verbose = false
+channels: 1 2
+test_time = 5
+END
+}
+
+@test "subcommand - dump with its options, global option after the subcommand" {
+  run build/example_subcommand dump regs: 0xd00380..0xd0038c dump_all verbose
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+subcommand: dump
+verbose = true
+regs: 0xd00380 0xd00384 0xd00388 0xd0038c
+dump_all = true
+END
+}
+
+@test "subcommand - option of another subcommand" {
+  run build/example_subcommand run dump_all
+  [ $status -eq 255 ]
+
+  assert_output --partial "no match for 'dump_all'"
+}
+
+@test "subcommand - option without its subcommand" {
+  run build/example_subcommand test_time=5
+  [ $status -eq 255 ]
+
+  assert_output --partial "no match for 'test_time'"
+}
+
+@test "subcommand - two subcommands" {
+  run build/example_subcommand run dump
+  [ $status -eq 255 ]
+
+  assert_output --partial "subcommand 'dump' can't be used with 'run'"
+}
+
+@test "subcommand - doesn't take a value" {
+  run build/example_subcommand run=1
+  [ $status -eq 255 ]
+
+  assert_output --partial "subcommand 'run' doesn't take a value"
+}
+
+@test "subcommand - environment variable only for the selected subcommand" {
+  export PROJECT_NAME_DUMP_ALL=1
+  run build/example_subcommand run
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+subcommand: run
+verbose = false
+channels:
+test_time = 10
+END
+
+  run build/example_subcommand dump
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+setting dump_all to "1" (from environment variable PROJECT_NAME_DUMP_ALL)
+subcommand: dump
+verbose = false
+regs:
+dump_all = true
+END
+}
+
+@test "subcommand - global options read the environment before parsing" {
+  export PROJECT_NAME_VERBOSE=1
+  export PROJECT_NAME_TEST_TIME=5
+  export PROJECT_NAME_DUMP_ALL=1
+  run build/example_subcommand run
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+verbose before parsing
+setting verbose to "1" (from environment variable PROJECT_NAME_VERBOSE)
+setting test_time to "5" (from environment variable PROJECT_NAME_TEST_TIME)
+subcommand: run
+verbose = true
+channels:
+test_time = 5
+END
+}
+
+@test "subcommand - usage" {
+  run build/example_subcommand help
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+no match for 'help'
+
+example_subcommand
+  - demonstrates git style subcommands,... each one has its own options
+
+  verbose   - lots of output (all subcommands)
+  run       - run the test
+  dump      - dump registers
+
+run options:
+  channels: - channels to test
+  test_time - seconds to run each test
+
+dump options:
+  dump reads registers, e.g. dump regs: 0xd00380..0xd0038c
+  regs:     - registers to dump
+  dump_all  - dump every register
+END
+}
+
+@test "subcommand - usage of the selected subcommand" {
+  run build/example_subcommand dump help
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+no match for 'help'
+
+example_subcommand
+  - demonstrates git style subcommands,... each one has its own options
+
+  verbose   - lots of output (all subcommands)
+  run       - run the test
+  dump      - dump registers
+
+dump options:
+  dump reads registers, e.g. dump regs: 0xd00380..0xd0038c
+  regs:     - registers to dump
+  dump_all  - dump every register
+END
+}
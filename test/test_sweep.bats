@@ -0,0 +1,65 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "sweep - list x range x every enum" {
+  run build/example_sweep channels: 1 2 frame_sizes=64..65 threads=3
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+combination 0: channel 1 frame size 64 mode loopback result 10640
+combination 1: channel 1 frame size 64 mode external result 10641
+combination 2: channel 1 frame size 65 mode loopback result 10650
+combination 3: channel 1 frame size 65 mode external result 10651
+combination 4: channel 2 frame size 64 mode loopback result 20640
+combination 5: channel 2 frame size 64 mode external result 20641
+combination 6: channel 2 frame size 65 mode loopback result 20650
+combination 7: channel 2 frame size 65 mode external result 20651
+8 combinations
+END
+}
+
+@test "sweep - enum that was set only has one value" {
+  run build/example_sweep channels: 3 frame_sizes=1+2 mode=external
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+combination 0: channel 3 frame size 1 mode external result 30011
+combination 1: channel 3 frame size 2 mode external result 30021
+combination 2: channel 3 frame size 3 mode external result 30031
+3 combinations
+END
+}
+
+@test "sweep - results don't depend on the number of threads" {
+  run build/example_sweep channels: 0..9 frame_sizes=0..20 threads=1
+  [ $status -eq 0 ]
+  single="$output"
+  run build/example_sweep channels: 0..9 frame_sizes=0..20 threads=7
+  [ $status -eq 0 ]
+  [ "$output" = "$single" ]
+  assert_output --partial "420 combinations"
+}
+
+@test "sweep - an empty list is one value, 0" {
+  run build/example_sweep frame_sizes=0..1 mode=external
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+combination 0: channel 0 frame size 0 mode external result 1
+combination 1: channel 0 frame size 1 mode external result 11
+2 combinations
+END
+}
+
+@test "sweep - a range that isn't set is one value, 0" {
+  run build/example_sweep channels: 4
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+combination 0: channel 4 frame size 0 mode loopback result 40000
+combination 1: channel 4 frame size 0 mode external result 40001
+2 combinations
+END
+}
@@ -0,0 +1,47 @@
+#!/usr/bin/env bats
+
+load "libs/bats-support/load"
+load "libs/bats-assert/load"
+
+@test "try_parse - valid options are parsed" {
+  run build/example_try_parse some_int=3 some_bool
+  [ $status -eq 0 ]
+
+  assert_output --stdin <<END
+option_some_bool.is_set
+option_some_bool.value = true
+option_some_int.is_set
+option_some_int.value = 3
+END
+}
+
+@test "try_parse - no match" {
+  run build/example_try_parse some_in=5
+  [ $status -eq 255 ]
+
+  assert_output --partial "error: no match, argument 0, option '', offset 0"
+  assert_output --partial 'no match for option "some_in"'
+  assert_output --partial "some_intList:         testing some_intList"
+}
+
+@test "try_parse - bad value, offset of the value in the argument" {
+  run build/example_try_parse some_bool some_int=5f
+  [ $status -eq 255 ]
+
+  assert_output --stdin <<END
+TryParseOptions returned false
+error: bad value, argument 1, option 'some_int', offset 9
+error parsing '5f'
+ for int option 'some_int'
+ option description: testing some_int
+error parsing "some_int=5f"
+END
+}
+
+@test "try_parse - bad list item" {
+  run build/example_try_parse some_intList: 1 2 x
+  [ $status -eq 255 ]
+
+  assert_output --partial "error: bad list item, argument 3, option 'some_intList:', offset 0"
+  assert_output --partial 'error parsing "x"'
+}